@@ -22,7 +22,10 @@ namespace stellar
             requireDest     BOOL,                               \
             requireAuth     BOOL                                \
         ); ");
+    }
 
+    void AccountEntry::appendSQLIndexes(vector<const char*> &init)
+    {
         init.push_back("CREATE INDEX IF NOT EXISTS inflationDest ON Accounts ( InflationDest );");
 
         init.push_back("CREATE INDEX IF NOT EXISTS Balance on Accounts ( balance );");
@@ -48,6 +51,31 @@ namespace stellar
 
     }
 
+    const BulkTable &AccountEntry::getBulkTable()
+    {
+        static const BulkTable table = { "Accounts",
+            "accountID,balance,sequence,ownerCount,transferRate,"
+            "inflationDest,publicKey,requireDest,requireAuth",
+            "(?,?,?,?,?,?,?,?,?)", 9,
+            "accountID=?", 1 };
+        return table;
+    }
+
+    void AccountEntry::makeBulkRow(BulkRow &row)
+    {
+        row.table = &getBulkTable();
+        row.values = {
+            RippleAddress::createHumanAccountID(mAccountID),
+            std::to_string(mBalance),
+            std::to_string(mSequence),
+            std::to_string(mOwnerCount),
+            std::to_string(mTransferRate),
+            RippleAddress::createHumanAccountID(mInflationDest),
+            mPubKey.base58Key(),
+            mRequireDest ? "1" : "0",
+            mRequireAuth ? "1" : "0" };
+    }
+
     void AccountEntry::calculateIndex()
     {
         Serializer  s(22);
@@ -60,24 +88,14 @@ namespace stellar
 
     void  AccountEntry::insertIntoDB()
     {
-        string sql = str(boost::format("INSERT OR REPLACE INTO Accounts ("
-            "accountID,balance,sequence,ownerCount,transferRate,"
-            "inflationDest,publicKey,requireDest,requireAuth) values ('%s',%d,%d,%d,%d,'%s','%s',%d,%d);")
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mBalance
-            % mSequence
-            % mOwnerCount
-            % mTransferRate
-            % mInflationDest.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mPubKey.base58Key()
-            % mRequireDest
-            % mRequireAuth);
+        BulkRow row;
+        makeBulkRow(row);
 
         Database* db = getApp().getWorkingLedgerDB()->getDB();
 
-        if (!db->executeSQL(sql, false))
+        if (!insertRow(db, row))
         {
-            WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << sql;
+            WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << getInsertSQL(*row.table);
         }
     }
     void AccountEntry::updateInDB()
@@ -89,11 +107,11 @@ namespace stellar
             % mSequence
             % mOwnerCount
             % mTransferRate
-            % mInflationDest.base58Encode(RippleAddress::VER_ACCOUNT_ID)
+            % RippleAddress::createHumanAccountID(mInflationDest)
             % mPubKey.base58Key()
             % mRequireDest
             % mRequireAuth
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID));
+            % RippleAddress::createHumanAccountID(mAccountID));
 
         Database* db = getApp().getWorkingLedgerDB()->getDB();
 
@@ -105,7 +123,7 @@ namespace stellar
     void AccountEntry::deleteFromDB()
     {
         string sql = str(boost::format("DELETE from Accounts where accountID='%s';")
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID));
+            % RippleAddress::createHumanAccountID(mAccountID));
 
         Database* db = getApp().getWorkingLedgerDB()->getDB();
 
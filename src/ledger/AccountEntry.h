@@ -31,8 +31,12 @@ namespace stellar
         bool loadFromDB(uint256& index);
         bool loadFromDB(); // load by accountID
 
+        void makeBulkRow(BulkRow &row);
+
+        static const BulkTable &getBulkTable();
         static void dropAll(LedgerDatabase &db);
         static void appendSQLInit(vector<const char*> &init);
+        static void appendSQLIndexes(vector<const char*> &init);
     };
 }
 
@@ -0,0 +1,568 @@
+#include <chrono>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include "BulkImport.h"
+#include "beast/beast/unit_test/suite.h"
+#include "ripple_app/data/SqliteDatabase.h"
+#include "ripple_app/main/Application.h"
+#include "ripple_app/main/LoadManager.h"
+#include "ripple_basics/log/Log.h"
+#include "ripple/common/seconds_clock.h"
+
+namespace stellar
+{
+    static const size_t kBatchRows = 1000;      // rows a worker hands over at once
+    static const size_t kMaxBatches = 64;       // batches queued for the database
+    static const uint64 kCommitRows = 100000;
+    static const int kMaxVariables = 999;       // SQLite's limit per statement
+    static const size_t kProgressItems = 25000;
+
+    // unwinds a worker when the import is abandoned
+    struct ImportStopped {};
+
+    BulkImport::BulkImport(LedgerDatabase &db) : mDB(db), mRunning(0), mStop(false)
+    {
+    }
+
+    uint64 BulkImport::run(ripple::Ledger::pointer ledger, LedgerDatabase::ScopedTransaction &tx)
+    {
+        // the ledger asks for the nodes it turns out to be missing
+        return run([ledger](int branch, std::function<void(SLE::ref)> const &visit) {
+            ledger->visitStateItems(branch, visit);
+        }, tx);
+    }
+
+    uint64 BulkImport::run(SHAMap::ref stateMap, LedgerDatabase::ScopedTransaction &tx)
+    {
+        return run([stateMap](int branch, std::function<void(SLE::ref)> const &visit) {
+            stateMap->visitLeaves(branch, [&visit](SHAMapItem::ref item) {
+                visit(boost::make_shared<SLE>(item->peekSerializer(), item->getTag()));
+            });
+        }, tx);
+    }
+
+    uint64 BulkImport::run(BranchWalk const &walk, LedgerDatabase::ScopedTransaction &tx)
+    {
+        typedef std::chrono::steady_clock clock_type;
+
+        clock_type::time_point const start = clock_type::now();
+        uint64 total = 0, sinceCommit = 0;
+
+        mNextBranch = 0;
+        mStop = false;
+        mError = std::exception_ptr();
+
+        int const threads = std::min(16, std::max(1, int(std::thread::hardware_concurrency())));
+        vector<std::thread> workers;
+
+        mRunning = threads;
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back(&BulkImport::work, this, std::cref(walk));
+
+        auto seconds = [&start]() {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(
+                clock_type::now() - start).count();
+        };
+
+        try
+        {
+            for (;;)
+            {
+                Batch batch;
+                {
+                    std::unique_lock<std::mutex> lock(mLock);
+                    mReady.wait(lock, [this] { return mStop || !mBatches.empty() || mRunning == 0; });
+
+                    if (mStop)
+                        break;          // a worker failed; its error is thrown below
+
+                    if (mBatches.empty())
+                        break;
+
+                    batch = std::move(mBatches.front());
+                    mBatches.pop_front();
+                    mSpace.notify_one();
+                }
+
+                for (BulkRow &row : batch)
+                    add(row);
+
+                total += batch.size();
+                sinceCommit += batch.size();
+
+                if (sinceCommit >= kCommitRows)
+                {
+                    flush();
+                    tx.endTransaction(true);
+                    tx.beginTransaction(mDB);
+                    sinceCommit = 0;
+
+                    WriteLog(ripple::lsINFO, ripple::Ledger) << "Imported " <<
+                        total << " items @" << int(total / std::max(seconds(), 1.0));
+
+                    // reset the timer with every batch
+                    getApp().getLoadManager().resetDeadlockDetector();
+                }
+            }
+
+            if (!mError)
+                flush();
+        }
+        catch (...)
+        {
+            stop();
+            for (std::thread &worker : workers)
+                worker.join();
+            throw;
+        }
+
+        for (std::thread &worker : workers)
+            worker.join();
+
+        if (mError)
+            std::rethrow_exception(mError);
+
+        double const elapsed = seconds();
+        WriteLog(ripple::lsINFO, ripple::Ledger) << "Imported " << total << " items in " <<
+            elapsed << "s @" << int(total / std::max(elapsed, 0.001)) << " rows/s using " <<
+            threads << " threads";
+
+        return total;
+    }
+
+    uint64 BulkImport::apply(const SHAMap::Delta &delta)
+    {
+        typedef std::chrono::steady_clock clock_type;
+
+        clock_type::time_point const start = clock_type::now();
+        uint64 rows = 0;
+        size_t done = 0;
+
+        for (SHAMap::Delta::value_type const &it : delta)
+        {
+            SHAMapItem::pointer const &newItem = it.second.first;
+            SHAMapItem::pointer const &oldItem = it.second.second;
+
+            // a deleted entry is found from its last version
+            SHAMapItem::pointer const &item = newItem ? newItem : oldItem;
+            assert(item);
+
+            SLE::pointer sle = boost::make_shared<SLE>(item->peekSerializer(), item->getTag());
+            LedgerEntry::pointer entry = LedgerEntry::makeEntry(sle);
+
+            if (entry)
+            {
+                BulkRow row;
+                entry->makeBulkRow(row);
+
+                // the whole row is written, so changes and additions are the same
+                if (newItem)
+                    add(row);
+                else
+                    remove(row);
+                ++rows;
+            }
+
+            if (++done % kProgressItems == 0)
+            {
+                WriteLog(ripple::lsINFO, ripple::Ledger) << "Caught up " << done << " of " <<
+                    delta.size() << " entries";
+            }
+        }
+
+        flush();
+
+        double const elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+            clock_type::now() - start).count();
+        WriteLog(ripple::lsINFO, ripple::Ledger) << "Applied " << delta.size() << " changes (" <<
+            rows << " rows) in " << elapsed << "s";
+
+        return rows;
+    }
+
+    void BulkImport::work(BranchWalk const &walk)
+    {
+        try
+        {
+            Batch batch;
+            batch.reserve(kBatchRows);
+
+            for (int branch = mNextBranch++; branch < 16; branch = mNextBranch++)
+            {
+                walk(branch, [this, &batch](SLE::ref sle) {
+                    LedgerEntry::pointer entry = LedgerEntry::makeEntry(sle);
+                    if (!entry)
+                        return;
+
+                    batch.emplace_back();
+                    entry->makeBulkRow(batch.back());
+
+                    if (batch.size() >= kBatchRows)
+                    {
+                        if (!push(batch))
+                            throw ImportStopped();
+                        batch.reserve(kBatchRows);
+                    }
+                });
+            }
+
+            if (!batch.empty())
+                push(batch);
+        }
+        catch (ImportStopped &)
+        {
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (!mError)
+                mError = std::current_exception();
+            mStop = true;
+            mSpace.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mLock);
+        --mRunning;
+        mReady.notify_all();
+    }
+
+    bool BulkImport::push(Batch &batch)
+    {
+        std::unique_lock<std::mutex> lock(mLock);
+        mSpace.wait(lock, [this] { return mStop || mBatches.size() < kMaxBatches; });
+
+        if (mStop)
+            return false;
+
+        mBatches.push_back(std::move(batch));
+        batch.clear();
+        mReady.notify_one();
+        return true;
+    }
+
+    void BulkImport::stop()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStop = true;
+        mSpace.notify_all();
+    }
+
+    void BulkImport::add(BulkRow &row)
+    {
+        const BulkTable &table = *row.table;
+        Pending &pending = mPending[&table];
+
+        if (pending.insertOne.empty())
+        {
+            pending.rowsPerStatement = std::max(1, kMaxVariables / table.columnCount);
+            pending.insertOne = LedgerEntry::getInsertSQL(table);
+            pending.insertMany = LedgerEntry::getInsertSQL(table, pending.rowsPerStatement);
+            pending.rows.reserve(pending.rowsPerStatement);
+        }
+
+        pending.rows.push_back(std::move(row));
+
+        if (pending.rows.size() >= pending.rowsPerStatement)
+        {
+            execute(pending.insertMany, pending.rows.data(), pending.rows.size(),
+                table.columnCount);
+            pending.rows.clear();
+        }
+    }
+
+    void BulkImport::remove(const BulkRow &row)
+    {
+        const BulkTable &table = *row.table;
+        string const sql = str(boost::format("DELETE FROM %s WHERE %s;") % table.name % table.key);
+
+        execute(sql, &row, 1, table.keyCount);
+    }
+
+    void BulkImport::flush()
+    {
+        // what is left is less than a statement's worth, a row at a time
+        for (auto &it : mPending)
+        {
+            Pending &pending = it.second;
+            for (BulkRow const &row : pending.rows)
+                execute(pending.insertOne, &row, 1, it.first->columnCount);
+            pending.rows.clear();
+        }
+    }
+
+    void BulkImport::execute(const string &sql, const BulkRow *rows, size_t count, int values)
+    {
+        // values are bound as text, as insertIntoDB binds them
+        ripple::SqliteStatement &stmt = mDB.getDBCon()->getDB()->getSqliteDB()->getStatement(sql);
+
+        int position = 1;
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int v = 0; v < values; ++v)
+                stmt.bindStatic(position++, rows[i].values[v]);
+        }
+
+        int ret = stmt.step();
+        stmt.reset();
+
+        if (!stmt.isDone(ret))
+        {
+            WriteLog(ripple::lsWARNING, ripple::Ledger) << "SQL failed: " << sql;
+            throw std::runtime_error("could not write rows");
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    // Catching up through a delta must leave the mirror as importing the new
+    // state from scratch would. The import walks a state map held in memory,
+    // as run() walks a ledger's.
+    class BulkImport_test : public beast::unit_test::suite
+    {
+    public:
+        typedef std::map<uint256, SLE::pointer> State;
+
+        static uint160 account(int i)
+        {
+            return uint160(std::uint64_t(1000 + i));
+        }
+
+        // spread over the branches of the root, as real indexes are
+        static uint256 key(int type, int i)
+        {
+            Serializer s(8);
+            s.add32(type);
+            s.add32(i);
+            return s.getSHA512Half();
+        }
+
+        static void addAccount(State &state, int i, std::uint64_t balance, std::uint32_t sequence)
+        {
+            SLE::pointer sle = boost::make_shared<SLE>(ltACCOUNT_ROOT, key(ltACCOUNT_ROOT, i));
+            sle->setFieldAccount(sfAccount, account(i));
+            sle->setFieldAmount(sfBalance, STAmount(balance));
+            sle->setFieldU32(sfSequence, sequence);
+            sle->setFieldU32(sfOwnerCount, 1);
+            state[sle->getIndex()] = sle;
+        }
+
+        static void addOffer(State &state, int i, std::uint32_t sequence, int pays, int gets)
+        {
+            uint160 usd;
+            STAmount::currencyFromString(usd, "USD");
+
+            SLE::pointer sle = boost::make_shared<SLE>(ltOFFER, key(ltOFFER, i * 1000 + sequence));
+            sle->setFieldAccount(sfAccount, account(i));
+            sle->setFieldU32(sfSequence, sequence);
+            sle->setFieldAmount(sfTakerPays, STAmount(usd, account(0), pays, -2));
+            sle->setFieldAmount(sfTakerGets, STAmount(std::uint64_t(gets)));
+            state[sle->getIndex()] = sle;
+        }
+
+        static void addLine(State &state, int low, int high, int balance)
+        {
+            uint160 usd;
+            STAmount::currencyFromString(usd, "USD");
+
+            SLE::pointer sle = boost::make_shared<SLE>(ltRIPPLE_STATE, key(ltRIPPLE_STATE, low * 1000 + high));
+            sle->setFieldAmount(sfLowLimit, STAmount(usd, account(low), 100));
+            sle->setFieldAmount(sfHighLimit, STAmount(usd, account(high), 50));
+            sle->setFieldAmount(sfBalance, STAmount(usd, ACCOUNT_ONE, balance, -1));
+            state[sle->getIndex()] = sle;
+        }
+
+        static SHAMapItem::pointer makeItem(const SLE::pointer &sle)
+        {
+            return boost::make_shared<SHAMapItem>(sle->getIndex(), sle->getSerializer());
+        }
+
+        // the delta SHAMap::compare returns between two states
+        static SHAMap::Delta makeDelta(const State &from, const State &to)
+        {
+            SHAMap::Delta delta;
+
+            for (State::value_type const &it : to)
+            {
+                State::const_iterator old = from.find(it.first);
+                if (old == from.end())
+                    delta[it.first] = SHAMap::DeltaItem(makeItem(it.second), SHAMapItem::pointer());
+                else if (old->second->getSerializer() != it.second->getSerializer())
+                    delta[it.first] = SHAMap::DeltaItem(makeItem(it.second), makeItem(old->second));
+            }
+
+            for (State::value_type const &it : from)
+            {
+                if (to.find(it.first) == to.end())
+                    delta[it.first] = SHAMap::DeltaItem(SHAMapItem::pointer(), makeItem(it.second));
+            }
+
+            return delta;
+        }
+
+        static SHAMap::pointer makeMap(const State &state, FullBelowCache &fullBelowCache)
+        {
+            SHAMap::pointer map = boost::make_shared<SHAMap>(smtFREE, std::ref(fullBelowCache));
+
+            for (State::value_type const &it : state)
+                map->addGiveItem(makeItem(it.second), false, false);
+
+            return map;
+        }
+
+        // every row of the mirror, in order
+        static string dump(LedgerDatabase &db)
+        {
+            string res;
+
+            for (const char *table : { "Accounts", "Offers", "TrustLines" })
+            {
+                ripple::SqliteStatement stmt(db.getDBCon()->getDB()->getSqliteDB(),
+                    str(boost::format("SELECT * FROM %s ORDER BY 1, 2;") % table));
+
+                for (int ret = stmt.step(); stmt.isRow(ret); ret = stmt.step())
+                {
+                    res += table;
+                    for (int i = 0; i < sqlite3_column_count(stmt.peekStatement()); ++i)
+                    {
+                        res += " " + std::to_string(sqlite3_column_type(stmt.peekStatement(), i));
+                        res += ":" + stmt.getString(i);
+                    }
+                    res += "\n";
+                }
+            }
+
+            return res;
+        }
+
+        // the one value a query returns
+        static string scalar(LedgerDatabase &db, const char *sql)
+        {
+            ripple::SqliteStatement stmt(db.getDBCon()->getDB()->getSqliteDB(), sql);
+            return stmt.isRow(stmt.step()) ? stmt.getString(0) : string();
+        }
+
+        void testInsert(boost::filesystem::path const &dir)
+        {
+            testcase("insert");
+
+            // enough of each for the bulk statements to hold many rows
+            State state;
+            for (int i = 1; i <= 300; ++i)
+            {
+                addAccount(state, i, 1000000 * i, i);
+                addOffer(state, i, 2, 150 + i, 1000 * i);
+                addLine(state, i, i + 1, -i);
+            }
+
+            ripple::DatabaseCon singleCon((dir / "single.db"), 0, LedgerDatabase::getSQLInit());
+            ripple::DatabaseCon bulkCon((dir / "bulk.db"), 0, LedgerDatabase::getSQLInit());
+            LedgerDatabase single(&singleCon), bulk(&bulkCon);
+
+            {
+                // a row at a time, as insertIntoDB writes them
+                LedgerDatabase::ScopedTransaction tx(single);
+                for (State::value_type const &it : state)
+                {
+                    BulkRow row;
+                    LedgerEntry::makeEntry(it.second)->makeBulkRow(row);
+                    expect(LedgerEntry::insertRow(singleCon.getDB(), row), "Insert failed");
+                }
+                tx.endTransaction(true);
+            }
+
+            {
+                LedgerDatabase::ScopedTransaction tx(bulk);
+                BulkImport(bulk).apply(makeDelta(State(), state));
+                tx.endTransaction(true);
+            }
+
+            string const expected = dump(single);
+            expect(!expected.empty(), "Nothing inserted");
+            expect(dump(bulk) == expected, "Bulk statements store rows differently");
+
+            // numbers are stored as numbers, as the SQL literals stored them
+            expect(scalar(single, "SELECT group_concat(DISTINCT typeof(balance) || typeof(sequence) || "
+                "typeof(requireDest)) FROM Accounts;") == "integerintegerinteger",
+                "Account columns stored with the wrong types");
+        }
+
+        void testCatchUp(boost::filesystem::path const &dir)
+        {
+            testcase("catch up");
+
+            State before, after;
+
+            for (int i = 1; i <= 50; ++i)
+            {
+                addAccount(before, i, 1000000 * i, 1);
+                addOffer(before, i, 2, 150 + i, 1000 * i);
+                if (i > 1)
+                    addLine(before, i - 1, i, i);
+            }
+
+            // as many ledgers later: some of everything changed, added and removed
+            after = before;
+            for (int i = 1; i <= 50; i += 3)
+                addAccount(after, i, 999 * i, 7);
+            for (int i = 51; i <= 60; ++i)
+                addAccount(after, i, 500000, 1);
+            for (int i = 2; i <= 50; i += 4)
+                after.erase(key(ltOFFER, i * 1000 + 2));
+            for (int i = 5; i <= 50; i += 5)
+                addOffer(after, i, 9, 33, 44);
+            for (int i = 2; i <= 50; i += 7)
+                addLine(after, i - 1, i, -i);
+            after.erase(key(ltRIPPLE_STATE, 10 * 1000 + 11));
+            after.erase(key(ltACCOUNT_ROOT, 50));
+
+            SHAMap::Delta const delta = makeDelta(before, after);
+
+            ripple::DatabaseCon caughtUpCon((dir / "caught-up.db"), 0, LedgerDatabase::getSQLInit());
+            ripple::DatabaseCon importedCon((dir / "imported.db"), 0, LedgerDatabase::getSQLInit());
+            LedgerDatabase caughtUp(&caughtUpCon), imported(&importedCon);
+
+            {
+                LedgerDatabase::ScopedTransaction tx(caughtUp);
+                BulkImport(caughtUp).apply(makeDelta(State(), before));
+                tx.endTransaction(true);
+            }
+
+            {
+                LedgerDatabase::ScopedTransaction tx(caughtUp);
+                uint64 rows = BulkImport(caughtUp).apply(delta);
+                expect(rows == delta.size(), "Wrong number of rows touched");
+                tx.endTransaction(true);
+            }
+
+            {
+                FullBelowCache fullBelowCache("test.full_below", get_seconds_clock());
+                SHAMap::pointer const map = makeMap(after, fullBelowCache);
+
+                LedgerDatabase::ScopedTransaction tx(imported);
+                uint64 rows = BulkImport(imported).run(map, tx);
+                expect(rows == after.size(), "Wrong number of rows imported");
+                tx.endTransaction(true);
+            }
+
+            string const expected = dump(imported);
+            expect(!expected.empty(), "Nothing imported");
+            expect(dump(caughtUp) == expected, "Catching up differs from a full import");
+        }
+
+        void run()
+        {
+            boost::filesystem::path const dir = boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path("bulk-import-%%%%-%%%%");
+            boost::filesystem::create_directories(dir);
+
+            testInsert(dir);
+            testCatchUp(dir);
+
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(dir, ec);
+        }
+    };
+
+    BEAST_DEFINE_TESTSUITE(BulkImport,ledger,stellar);
+}
@@ -0,0 +1,93 @@
+#ifndef __BULKIMPORT__
+#define __BULKIMPORT__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "LedgerEntry.h"
+#include "LedgerDatabase.h"
+
+/*
+BulkImport
+Fills the SQL mirror with the state of a ledger.
+
+Worker threads take the 16 branches below the root of the state map in
+turn and decode their entries into rows. The thread running the import
+inserts the rows through prepared statements that each write many rows
+of one table, committing every 100k rows.
+
+The caller drops the tables beforehand and creates their indexes
+afterwards: building an index once is cheaper than updating it on every
+insert.
+
+Catching up goes through the same statements: the delta between the
+state the mirror holds and the new one has a single, final version of
+every entry that changed however many ledgers apart the two are, and
+each entry is decoded and written once.
+*/
+
+namespace stellar
+{
+    class BulkImport
+    {
+    public:
+        BulkImport(LedgerDatabase &db);
+
+        // imports every entry of the ledger; the transaction is committed
+        // and begun again as rows go in. Returns the number of rows.
+        uint64 run(ripple::Ledger::pointer ledger, LedgerDatabase::ScopedTransaction &tx);
+
+        // the same, from a state map that is entirely in memory
+        uint64 run(SHAMap::ref stateMap, LedgerDatabase::ScopedTransaction &tx);
+
+        // writes the entries of a delta (new item, old item) within the
+        // caller's transaction. Returns the number of rows touched.
+        uint64 apply(const SHAMap::Delta &delta);
+
+    private:
+        typedef vector<BulkRow> Batch;
+
+        // visits the entries below one branch of the state map's root
+        typedef std::function<void(int branch, std::function<void(SLE::ref)> const &visit)> BranchWalk;
+
+        // rows of one table waiting for a full statement
+        struct Pending
+        {
+            Batch rows;
+            size_t rowsPerStatement;
+            string insertMany;  // inserts rowsPerStatement rows
+            string insertOne;
+        };
+
+        LedgerDatabase &mDB;
+
+        std::mutex mLock;
+        std::condition_variable mReady;     // a batch is queued or a worker ended
+        std::condition_variable mSpace;     // the queue has room
+        std::deque<Batch> mBatches;
+        int mRunning;
+        bool mStop;
+        std::exception_ptr mError;
+        std::atomic<int> mNextBranch;
+
+        std::map<const BulkTable *, Pending> mPending;
+
+        uint64 run(BranchWalk const &walk, LedgerDatabase::ScopedTransaction &tx);
+        void work(BranchWalk const &walk);
+        bool push(Batch &batch);
+        void stop();
+
+        void add(BulkRow &row);
+        void remove(const BulkRow &row);
+        void flush();
+        // runs sql bound to the first values of each row
+        void execute(const string &sql, const BulkRow *rows, size_t count, int values);
+    };
+}
+
+#endif
@@ -1,8 +1,10 @@
+#include <boost/format.hpp>
 #include "LedgerEntry.h"
 #include "LedgerMaster.h"
 #include "TrustLine.h"
 #include "OfferEntry.h"
 #include "AccountEntry.h"
+#include "ripple_app/data/SqliteDatabase.h"
 
 namespace stellar
 {
@@ -28,6 +30,34 @@ namespace stellar
         return(mIndex);
     }
 
+    string LedgerEntry::getInsertSQL(const BulkTable &table, size_t rows)
+    {
+        string sql = str(boost::format("INSERT OR REPLACE INTO %s (%s) VALUES %s")
+            % table.name % table.columns % table.placeholders);
+
+        for (size_t i = 1; i < rows; ++i)
+        {
+            sql += ",";
+            sql += table.placeholders;
+        }
+
+        return sql + ";";
+    }
+
+    bool LedgerEntry::insertRow(Database *db, const BulkRow &row)
+    {
+        const BulkTable &table = *row.table;
+        SqliteStatement &stmt = db->getSqliteDB()->getStatement(getInsertSQL(table));
+
+        for (int v = 0; v < table.columnCount; ++v)
+            stmt.bindStatic(v + 1, row.values[v]);
+
+        int ret = stmt.step();
+        stmt.reset();
+
+        return stmt.isDone(ret);
+    }
+
     // these will do the appropriate thing in the DB and the Canonical Ledger form
     void LedgerEntry::storeDelete()
     {
@@ -46,7 +76,7 @@ namespace stellar
 
 
     // SANITY use a registration pattern instead as we also need factories
-    void LedgerEntry::dropAll(LedgerDatabase &db)
+    void LedgerEntry::dropAll(LedgerDatabase &db, bool withIndexes)
     {
         // SANITY implement this for the actual ledger entry ~~ the ledger class seems to conflict with this
         AccountEntry::dropAll(db);
@@ -54,12 +84,28 @@ namespace stellar
         OfferEntry::dropAll(db);
 
         vector<const char *> createAll;
-        appendSQLInit(createAll);
+        AccountEntry::appendSQLInit(createAll);
+        OfferEntry::appendSQLInit(createAll);
+        TrustLine::appendSQLInit(createAll);
         for(const char * const &sql: createAll) {
             if (!db.getDBCon()->getDB()->executeSQL(sql)) {
                 throw std::runtime_error("could not re-create table ");
             }
         }
+
+        if (withIndexes)
+            createIndexes(db);
+    }
+
+    void LedgerEntry::createIndexes(LedgerDatabase &db)
+    {
+        vector<const char *> createAll;
+        appendSQLIndexes(createAll);
+        for(const char * const &sql: createAll) {
+            if (!db.getDBCon()->getDB()->executeSQL(sql)) {
+                throw std::runtime_error("could not create index ");
+            }
+        }
     }
 
     void LedgerEntry::appendSQLInit(vector<const char*> &init)
@@ -67,6 +113,13 @@ namespace stellar
         AccountEntry::appendSQLInit(init);
         OfferEntry::appendSQLInit(init);
         TrustLine::appendSQLInit(init);
+        appendSQLIndexes(init);
+    }
+
+    void LedgerEntry::appendSQLIndexes(vector<const char*> &init)
+    {
+        AccountEntry::appendSQLIndexes(init);
+        TrustLine::appendSQLIndexes(init);
     }
 
 
@@ -12,6 +12,25 @@ Parent of AccountEntry, TrustLine, OfferEntry
 */
 namespace stellar
 {
+    // a table as the bulk loader fills it
+    struct BulkTable
+    {
+        const char *name;
+        const char *columns;        // as listed in the insert
+        const char *placeholders;   // one row of them, e.g. "(?,?)"
+        int columnCount;
+        const char *key;            // matches a row on its leading values
+        int keyCount;
+    };
+
+    // an entry decoded into the values of its row, as text; the columns'
+    // affinity stores them as the same values the SQL literals gave
+    struct BulkRow
+    {
+        const BulkTable *table;
+        vector<string> values;
+    };
+
     class LedgerEntry
     {
     protected:
@@ -36,8 +55,20 @@ namespace stellar
         void storeChange();
         void storeAdd();
 
-        static void dropAll(LedgerDatabase &db); // deletes all data from DB
+        // fills in the row insertIntoDB and the bulk loader write for this entry
+        virtual void makeBulkRow(BulkRow &row) = 0;
+
+        // inserts or replaces that many rows of the table
+        static string getInsertSQL(const BulkTable &table, size_t rows = 1);
+
+        // writes one row as insertIntoDB does; false if the insert failed
+        static bool insertRow(Database *db, const BulkRow &row);
+
+        // deletes all data from DB; indexes can be left for createIndexes
+        static void dropAll(LedgerDatabase &db, bool withIndexes = true);
+        static void createIndexes(LedgerDatabase &db);
         static void appendSQLInit(vector<const char*> &init);
+        static void appendSQLIndexes(vector<const char*> &init);
     };
 }
 
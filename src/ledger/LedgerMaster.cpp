@@ -5,6 +5,7 @@
 #include "ripple_basics/ripple_basics.h"
 #include "ripple_app/main/LoadManager.h"
 #include "LedgerEntry.h"
+#include "BulkImport.h"
 
 using namespace ripple; // needed for logging...
 
@@ -169,37 +170,18 @@ namespace stellar
             return importLedgerState(updatedCurrentCLF->getHash());
         }
 
-        // incremental update
+        // incremental update: the delta spans every ledger in between,
+        // so each entry is written once in its final state
 
-        LedgerDatabase::ScopedTransaction tx(mCurrentDB);
+        WriteLog(ripple::lsINFO, ripple::Ledger) << "applying " << delta.size() << " changes from ledger " <<
+            mCurrentCLF->getLegacyLedger()->getLedgerSeq() << " to " <<
+            updatedCurrentCLF->getLegacyLedger()->getLedgerSeq();
 
-        for(SHAMap::Delta::value_type &it: delta)
-        {
-            SHAMapItem::pointer &newItem = it.second.first;
-            SHAMapItem::pointer &oldItem = it.second.second;
+        LedgerDatabase::ScopedTransaction tx(mCurrentDB);
 
-            if (newItem)
-            {
-                SLE::pointer newEntry = boost::make_shared<SLE> (newItem->peekSerializer (), newItem->getTag ());
-                LedgerEntry::pointer entry = LedgerEntry::makeEntry(newEntry);
+        BulkImport import(mCurrentDB);
+        import.apply(delta);
 
-                if (oldItem)
-                {	// SLE updated
-                    if (entry) entry->storeChange();
-                }
-                else
-                {	// SLE added
-                    if (entry) entry->storeAdd();
-                }
-            }
-            else
-            { // SLE must have been deleted
-                assert(oldItem);
-                SLE::pointer oldEntry = boost::make_shared<SLE> (oldItem->peekSerializer (), oldItem->getTag ());
-                LedgerEntry::pointer entry = LedgerEntry::makeEntry(oldEntry);
-                if (entry) entry->storeDelete();
-            }
-        }
         updateDBFromLedger(updatedCurrentCLF);
         tx.endTransaction(true);
 
@@ -222,50 +204,19 @@ namespace stellar
             // invalidates last closed ledger as we're about to destroy the database
             mCurrentDB.setState(LedgerDatabase::kLastClosedLedger, "");
 
-            Database* db = mCurrentDB.getDBCon()->getDB();
-
             try {
-                // delete all
-                LedgerEntry::dropAll(mCurrentDB);
+                // delete all; indexes are built once the rows are in
+                LedgerEntry::dropAll(mCurrentDB, false);
 
                 WriteLog(ripple::lsDEBUG, ripple::Ledger) << "Importing node store";
 
-                int counter = 0, totalImports = 0;
-                time_t start = time(nullptr);
-
                 LedgerDatabase::ScopedTransaction tx(mCurrentDB);
 
                 // import all anew
-                newLedger->getLegacyLedger()->visitStateItems(
-                    [&counter, &totalImports, &tx, this, start](SLE::ref curEntry) {
-                        static const int kProgressCount = 100000;
-
-                        totalImports++;
-
-                        LedgerEntry::pointer entry = LedgerEntry::makeEntry(curEntry);
-                        if (entry) {
-                            entry->storeAdd();
-                        }
-
-                        if (++counter >= kProgressCount)
-                        {
-                            tx.endTransaction(true);
-                            tx.beginTransaction(this->mCurrentDB);
-
-                            int elapsed = time(nullptr) - start;
-                            int rate = totalImports / (elapsed ? elapsed : 1);
-                            WriteLog(ripple::lsINFO, ripple::Ledger) << "Imported " <<
-                                totalImports << " items @" << rate;
-                            counter = 0;
-
-                            // reset the timer with every batch
-                            Application& app(getApp());
-                            LoadManager& mgr(app.getLoadManager());
-                            mgr.resetDeadlockDetector();
-                        }
-                });
-
-                WriteLog(ripple::lsINFO, ripple::Ledger) << "Imported " << totalImports << " items";
+                BulkImport import(mCurrentDB);
+                import.run(newLedger->getLegacyLedger(), tx);
+
+                LedgerEntry::createIndexes(mCurrentDB);
 
                 updateDBFromLedger(newLedger);
 
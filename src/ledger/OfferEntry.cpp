@@ -50,6 +50,34 @@ namespace stellar
         setFromCurrentRow(db);
     }
 
+    const BulkTable &OfferEntry::getBulkTable()
+    {
+        // the amounts were written as bare numeric literals, which SQLite
+        // stores as it prints them; the casts keep storing them that way
+        static const BulkTable table = { "Offers",
+            "accountID,sequence,takerPaysCurrency,takerPaysAmount,takerPaysIssuer,"
+            "takerGetsCurrency,takerGetsAmount,takerGetsIssuer,expiration,passive",
+            "(?,?,?,CAST(? AS NUMERIC),?,?,CAST(? AS NUMERIC),?,?,?)", 10,
+            "accountID=? AND sequence=?", 2 };
+        return table;
+    }
+
+    void OfferEntry::makeBulkRow(BulkRow &row)
+    {
+        row.table = &getBulkTable();
+        row.values = {
+            RippleAddress::createHumanAccountID(mAccountID),
+            std::to_string(mSequence),
+            mTakerPays.getHumanCurrency(),
+            mTakerPays.getText(),
+            RippleAddress::createHumanAccountID(mTakerPays.getIssuer()),
+            mTakerGets.getHumanCurrency(),
+            mTakerGets.getText(),
+            RippleAddress::createHumanAccountID(mTakerGets.getIssuer()),
+            std::to_string(mExpiration),
+            mPassive ? "1" : "0" };
+    }
+
     void OfferEntry::calculateIndex()
     {
         Serializer  s(26);
@@ -63,31 +91,16 @@ namespace stellar
 
     void OfferEntry::insertIntoDB()
     {
-        uint160 paysIssuer = mTakerPays.getIssuer();
-        uint160 getsIssuer = mTakerGets.getIssuer();
-
-        string sql = str(boost::format("INSERT OR REPLACE INTO Offers (accountID,sequence,"
-            "takerPaysCurrency,takerPaysAmount,takerPaysIssuer,takerGetsCurrency,"
-            "takerGetsAmount,takerGetsIssuer,expiration,passive)"
-            "values ('%s',%d,'%s',%d,'%s','%s',%d,'%s',%d,%d);")
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mSequence
-            % mTakerPays.getHumanCurrency()
-            % mTakerPays.getText()
-            % paysIssuer.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mTakerGets.getHumanCurrency()
-            % mTakerGets.getText()
-            % getsIssuer.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mExpiration
-            % mPassive);
+        BulkRow row;
+        makeBulkRow(row);
 
         {
             DeprecatedScopedLock sl(getApp().getWorkingLedgerDB()->getDBLock());
             Database* db = getApp().getWorkingLedgerDB()->getDB();
 
-            if (!db->executeSQL(sql, false))
+            if (!insertRow(db, row))
             {
-                WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << sql;
+                WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << getInsertSQL(*row.table);
             }
         }
     }
@@ -102,13 +115,13 @@ namespace stellar
             "takerGetsIssuer='%s' ,expiration=%d, passive=%d where accountID='%s' AND sequence=%d;")
             % mTakerPays.getHumanCurrency()
             % mTakerPays.getText()
-            % paysIssuer.base58Encode(RippleAddress::VER_ACCOUNT_ID)
+            % RippleAddress::createHumanAccountID(paysIssuer)
             % mTakerGets.getHumanCurrency()
             % mTakerGets.getText()
-            % getsIssuer.base58Encode(RippleAddress::VER_ACCOUNT_ID)
+            % RippleAddress::createHumanAccountID(getsIssuer)
             % mExpiration
             % mPassive
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID)
+            % RippleAddress::createHumanAccountID(mAccountID)
             % mSequence);
 
         {
@@ -145,7 +158,7 @@ namespace stellar
     void OfferEntry::deleteFromDB()
     {
         string sql = str(boost::format("DELETE FROM Offers where accountID='%s' AND sequence=%d;")
-            % mAccountID.base58Encode(RippleAddress::VER_ACCOUNT_ID)
+            % RippleAddress::createHumanAccountID(mAccountID)
             % mSequence);
 
         {
@@ -26,6 +26,9 @@ namespace stellar
         OfferEntry(SLE::pointer sle);
         OfferEntry(Database *db);
 
+        void makeBulkRow(BulkRow &row);
+
+        static const BulkTable &getBulkTable();
 
         static void dropAll(LedgerDatabase &db);
         static void appendSQLInit(vector<const char*> &init);
@@ -30,7 +30,10 @@ namespace stellar {
                                 highAuthSet BOOL,               \
                                 PRIMARY KEY ( trustIndex )      \
                         );");
+    }
 
+    void TrustLine::appendSQLIndexes(vector<const char*> &init)
+    {
         init.push_back("CREATE INDEX IF NOT EXISTS TrustLinesIndex1 ON TrustLines ( lowAccount );");
         init.push_back("CREATE INDEX IF NOT EXISTS TrustLinesIndex2 ON TrustLines ( highAccount );");
     }
@@ -54,6 +57,31 @@ namespace stellar {
         mHighAuthSet = flags & lsfHighAuth;
     }
 
+    const BulkTable &TrustLine::getBulkTable()
+    {
+        static const BulkTable table = { "TrustLines",
+            "trustIndex,lowAccount,highAccount,currency,lowLimit,highLimit,"
+            "balance,lowAuthSet,highAuthSet",
+            "(?,?,?,?,?,?,?,?,?)", 9,
+            "trustIndex=?", 1 };
+        return table;
+    }
+
+    void TrustLine::makeBulkRow(BulkRow &row)
+    {
+        row.table = &getBulkTable();
+        row.values = {
+            to_string(getIndex()),
+            RippleAddress::createHumanAccountID(mLowAccount),
+            RippleAddress::createHumanAccountID(mHighAccount),
+            STAmount::createHumanCurrency(mCurrency),
+            mLowLimit.getText(),
+            mHighLimit.getText(),
+            mBalance.getText(),
+            mLowAuthSet ? "1" : "0",
+            mHighAuthSet ? "1" : "0" };
+    }
+
     void TrustLine::calculateIndex()
     {
         Serializer  s(62);
@@ -112,27 +140,16 @@ namespace stellar {
 
     void TrustLine::insertIntoDB()
     {
-        string sql = str(boost::format("INSERT OR REPLACE INTO TrustLines "
-            "(trustIndex, lowAccount,highAccount,currency,lowLimit,highLimit,"
-            "balance,lowAuthSet,highAuthSet)"
-            "values ('%s','%s','%s','%s','%s','%s','%s',%d,%d);")
-            % to_string(getIndex())
-            % mLowAccount.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % mHighAccount.base58Encode(RippleAddress::VER_ACCOUNT_ID)
-            % STAmount::createHumanCurrency(mCurrency)
-            % mLowLimit.getText()
-            % mHighLimit.getText()
-            % mBalance.getText()
-            % mLowAuthSet
-            % mHighAuthSet);
+        BulkRow row;
+        makeBulkRow(row);
 
         {
             DeprecatedScopedLock sl(getApp().getWorkingLedgerDB()->getDBLock());
             Database* db = getApp().getWorkingLedgerDB()->getDB();
 
-            if (!db->executeSQL(sql, false))
+            if (!insertRow(db, row))
             {
-                WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << sql;
+                WriteLog(lsWARNING, ripple::Ledger) << "SQL failed: " << getInsertSQL(*row.table);
             }
         }
     }
@@ -35,8 +35,12 @@ namespace stellar {
 
         TrustLine(SLE::pointer sle);
 
+        void makeBulkRow(BulkRow &row);
+
+        static const BulkTable &getBulkTable();
         static void dropAll(LedgerDatabase &db);
         static void appendSQLInit(vector<const char*> &init);
+        static void appendSQLIndexes(vector<const char*> &init);
     };
 }
 
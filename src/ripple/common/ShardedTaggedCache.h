@@ -0,0 +1,578 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHARDEDTAGGEDCACHE_H_INCLUDED
+#define RIPPLE_SHARDEDTAGGEDCACHE_H_INCLUDED
+
+#include "TaggedCache.h"
+
+#include <atomic>
+
+namespace ripple {
+
+/** Estimates the bytes used by a cached object.
+
+    The default counts only the object itself. Specialize it for types
+    which own memory elsewhere, next to the cache that holds them.
+*/
+template <class T>
+struct MemoryEstimate
+{
+    std::size_t operator() (T const&) const
+    {
+        return sizeof (T);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** A TaggedCache that many threads can use at once.
+
+    Keys are spread over a fixed number of shards by their hash, and each
+    shard has its own lock, map and share of the target size. Entries are
+    evicted with CLOCK: a hit only sets the entry's reference bit, and when
+    a full shard needs room a hand goes round its slots, clearing set bits
+    and evicting the first entry whose bit is already clear. Nothing is
+    reordered on a hit, so fetch does no more than a lookup.
+
+    sweep removes entries older than the target age a batch of slots at a
+    time, taking each shard's lock for one batch only.
+
+    There is no peekMutex: callers that need several operations to be
+    atomic should use TaggedCache. Objects leave the cache outside the
+    shard lock, so their destructors may use the cache.
+
+    Each entry's size is estimated with Estimate when it is stored, so the
+    cache can report roughly how much memory it holds.
+*/
+template <
+    class Key,
+    class T,
+    class Hash = beast::hardened_hash <Key>,
+    class KeyEqual = std::equal_to <Key>,
+    class Estimate = MemoryEstimate <T>
+>
+class ShardedTaggedCache
+{
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef boost::weak_ptr <mapped_type> weak_mapped_ptr;
+    typedef boost::shared_ptr <mapped_type> mapped_ptr;
+    typedef beast::abstract_clock <std::chrono::seconds> clock_type;
+
+    static std::size_t const shardCount = 16;
+
+    // Slots examined per lock while sweeping
+    static std::size_t const sweepBatch = 256;
+
+public:
+    ShardedTaggedCache (std::string const& name, int size,
+        clock_type::rep expiration_seconds, clock_type& clock, beast::Journal journal,
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New ())
+        : m_journal (journal)
+        , m_clock (clock)
+        , m_stats (name,
+            std::bind (&ShardedTaggedCache::collect_metrics, this),
+                collector)
+        , m_name (name)
+        , m_target_size (size > 0 ? size : 1000)
+        , m_target_age (expiration_seconds)
+    {
+        setShardTargets ();
+    }
+
+public:
+    /** Return the clock associated with the cache. */
+    clock_type& clock ()
+    {
+        return m_clock;
+    }
+
+    int getTargetSize () const
+    {
+        return m_target_size;
+    }
+
+    /** Sets the target size. Each shard keeps an equal share of it.
+        A smaller target evicts entries until every shard is within it.
+    */
+    void setTargetSize (int s)
+    {
+        if (s <= 0)
+            s = 1000;
+        m_target_size = s;
+        setShardTargets ();
+
+        if (m_journal.debug) m_journal.debug <<
+            m_name << " target size set to " << s;
+    }
+
+    clock_type::rep getTargetAge () const
+    {
+        return m_target_age;
+    }
+
+    void setTargetAge (clock_type::rep s)
+    {
+        m_target_age = s;
+        if (m_journal.debug) m_journal.debug <<
+            m_name << " target age set to " << s << "s";
+    }
+
+    int getCacheSize ()
+    {
+        int total = 0;
+        for (auto& shard : m_shards)
+        {
+            lock_guard lock (shard.mutex);
+            total += shard.count;
+        }
+        return total;
+    }
+
+    /** Returns the estimated bytes held by the cached entries. */
+    std::size_t getMemoryUsage ()
+    {
+        std::size_t total = 0;
+        for (auto& shard : m_shards)
+        {
+            lock_guard lock (shard.mutex);
+            total += shard.bytes + shard.slots.capacity () * sizeof (Slot) +
+                shard.index.size () * indexEntryBytes;
+        }
+        return total;
+    }
+
+    /** Entries are only tracked while cached. */
+    int getTrackSize ()
+    {
+        return getCacheSize ();
+    }
+
+    float getHitRate ()
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        counts (hits, misses);
+        return (static_cast<float> (hits) * 100) / (1.0f + hits + misses);
+    }
+
+    void clearStats ()
+    {
+        for (auto& shard : m_shards)
+        {
+            lock_guard lock (shard.mutex);
+            shard.hits = 0;
+            shard.misses = 0;
+        }
+    }
+
+    void clear ()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::vector <Slot> slots;
+            {
+                lock_guard lock (shard.mutex);
+                shard.index.clear ();
+                shard.slots.swap (slots);
+                shard.free.clear ();
+                shard.hand = 0;
+                shard.sweepPosition = 0;
+                shard.count = 0;
+                shard.bytes = 0;
+            }
+        }
+    }
+
+    void sweep ()
+    {
+        clock_type::time_point const when_expire (
+            m_clock.now () - clock_type::duration (m_target_age.load ()));
+
+        std::size_t swept = 0;
+
+        for (auto& shard : m_shards)
+        {
+            for (;;)
+            {
+                // Destroyed outside the lock
+                std::vector <mapped_ptr> stuffToSweep;
+                bool done;
+
+                {
+                    lock_guard lock (shard.mutex);
+
+                    std::size_t const end (std::min (shard.slots.size (),
+                        shard.sweepPosition + sweepBatch));
+
+                    for (; shard.sweepPosition < end; ++shard.sweepPosition)
+                    {
+                        Slot& slot (shard.slots [shard.sweepPosition]);
+
+                        if (slot.ptr && (slot.last_access <= when_expire))
+                            stuffToSweep.push_back (evict (shard, shard.sweepPosition));
+                    }
+
+                    done = (shard.sweepPosition >= shard.slots.size ());
+
+                    if (done)
+                        shard.sweepPosition = 0;
+                }
+
+                swept += stuffToSweep.size ();
+
+                if (done)
+                    break;
+            }
+        }
+
+        if (m_journal.trace && (swept != 0))
+            m_journal.trace << m_name << ": cache = " << getCacheSize () << "-" << swept;
+    }
+
+    bool del (const key_type& key, bool valid)
+    {
+        // Remove from cache. Entries are not tracked once they leave it,
+        // so valid makes no difference. Returns true if removed from cache
+        Shard& shard (shardFor (key));
+        mapped_ptr removed;
+
+        lock_guard lock (shard.mutex);
+        auto cit = shard.index.find (key);
+        if (cit == shard.index.end ())
+            return false;
+
+        removed = evict (shard, cit->second);
+        return true;
+    }
+
+    /** Replace aliased objects with originals.
+
+        Due to concurrency it is possible for two separate objects with
+        the same content and referring to the same unique "thing" to exist.
+        This routine eliminates the duplicate and performs a replacement
+        on the callers shared pointer if needed.
+
+        @param key The key corresponding to the object
+        @param data A shared pointer to the data corresponding to the object.
+        @param replace `true` if `data` is the up to date version of the object.
+
+        @return `true` If the key already existed.
+    */
+    bool canonicalize (const key_type& key, boost::shared_ptr<T>& data, bool replace = false)
+    {
+        Shard& shard (shardFor (key));
+        clock_type::time_point const now (m_clock.now ());
+
+        // Destroyed outside the lock
+        mapped_ptr removed;
+
+        lock_guard lock (shard.mutex);
+        auto cit = shard.index.find (key);
+
+        if (cit != shard.index.end ())
+        {
+            Slot& slot (shard.slots [cit->second]);
+            slot.referenced = true;
+            slot.last_access = now;
+
+            if (replace)
+            {
+                removed = slot.ptr;
+                slot.ptr = data;
+                shard.bytes -= slot.bytes;
+                slot.bytes = m_estimate (*data);
+                shard.bytes += slot.bytes;
+            }
+            else
+            {
+                data = slot.ptr;
+            }
+
+            return true;
+        }
+
+        if (shard.count >= shard.target)
+            removed = evictOne (shard);
+
+        std::size_t pos;
+        if (! shard.free.empty ())
+        {
+            pos = shard.free.back ();
+            shard.free.pop_back ();
+        }
+        else
+        {
+            pos = shard.slots.size ();
+            shard.slots.emplace_back ();
+        }
+
+        Slot& slot (shard.slots [pos]);
+        slot.key = key;
+        slot.ptr = data;
+        slot.last_access = now;
+        slot.referenced = false;
+        slot.bytes = m_estimate (*data);
+
+        shard.index.emplace (key, pos);
+        ++shard.count;
+        shard.bytes += slot.bytes;
+        return false;
+    }
+
+    boost::shared_ptr<T> fetch (const key_type& key)
+    {
+        Shard& shard (shardFor (key));
+        clock_type::time_point const now (m_clock.now ());
+
+        lock_guard lock (shard.mutex);
+        auto cit = shard.index.find (key);
+        if (cit == shard.index.end ())
+        {
+            ++shard.misses;
+            return mapped_ptr ();
+        }
+
+        ++shard.hits;
+        Slot& slot (shard.slots [cit->second]);
+        slot.referenced = true;
+        slot.last_access = now;
+        return slot.ptr;
+    }
+
+    /** Insert the element into the container.
+        If the key already exists, nothing happens.
+        @return `true` If the element was inserted
+    */
+    bool insert (key_type const& key, T const& value)
+    {
+        mapped_ptr p (boost::make_shared <T> (
+            std::cref (value)));
+        return canonicalize (key, p);
+    }
+
+    bool retrieve (const key_type& key, T& data)
+    {
+        // retrieve the value of the stored data
+        mapped_ptr entry = fetch (key);
+
+        if (!entry)
+            return false;
+
+        data = *entry;
+        return true;
+    }
+
+    /** Refresh the expiration time on a key.
+
+        @param key The key to refresh.
+        @return `true` if the key was found and the object is cached.
+    */
+    bool refreshIfPresent (const key_type& key)
+    {
+        return fetch (key) != nullptr;
+    }
+
+private:
+    typedef std::mutex mutex_type;
+    typedef std::lock_guard <mutex_type> lock_guard;
+
+    struct Slot
+    {
+        Slot ()
+            : bytes (0)
+            , referenced (false)
+        {
+        }
+
+        Key key;
+        mapped_ptr ptr;             // Empty when the slot is free
+        clock_type::time_point last_access;
+        std::size_t bytes;          // Estimated size of *ptr
+        bool referenced;
+    };
+
+    typedef ripple::unordered_map <key_type, std::size_t, Hash, KeyEqual> index_type;
+
+    // Approximate cost of a node and bucket in the index
+    static std::size_t const indexEntryBytes =
+        sizeof (typename index_type::value_type) + 3 * sizeof (void*);
+
+    struct Shard
+    {
+        Shard ()
+            : hand (0)
+            , sweepPosition (0)
+            , count (0)
+            , target (1)
+            , bytes (0)
+            , hits (0)
+            , misses (0)
+        {
+        }
+
+        mutex_type mutex;
+        index_type index;
+        std::vector <Slot> slots;
+        std::vector <std::size_t> free;
+        std::size_t hand;
+        std::size_t sweepPosition;
+        int count;
+        int target;
+        std::size_t bytes;
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    Shard& shardFor (key_type const& key)
+    {
+        // The high bits, since the shard's map buckets by the low ones
+        std::size_t const h (m_hash (key));
+        return m_shards [(h >> (8 * sizeof (std::size_t) - 4)) % shardCount];
+    }
+
+    // Shards over their new target are trimmed right away, since
+    // canonicalize only makes room for the entry it inserts
+    void setShardTargets ()
+    {
+        int const target ((m_target_size + shardCount - 1) / shardCount);
+
+        for (auto& shard : m_shards)
+        {
+            // Destroyed outside the lock
+            std::vector <mapped_ptr> stuffToSweep;
+
+            lock_guard lock (shard.mutex);
+            shard.target = std::max (1, target);
+
+            while (shard.count > shard.target)
+                stuffToSweep.push_back (evictOne (shard));
+        }
+    }
+
+    // Called with the shard locked. Returns the evicted object so the
+    // caller can let go of it after unlocking.
+    mapped_ptr evict (Shard& shard, std::size_t pos)
+    {
+        Slot& slot (shard.slots [pos]);
+        mapped_ptr ptr;
+        ptr.swap (slot.ptr);
+        shard.index.erase (slot.key);
+        shard.free.push_back (pos);
+        --shard.count;
+        shard.bytes -= slot.bytes;
+        slot.bytes = 0;
+        return ptr;
+    }
+
+    // Called with the shard locked and at least one entry cached
+    mapped_ptr evictOne (Shard& shard)
+    {
+        // Two turns of the hand clear every bit, so this ends
+        for (std::size_t n = 2 * shard.slots.size (); n != 0; --n)
+        {
+            if (shard.hand >= shard.slots.size ())
+                shard.hand = 0;
+
+            std::size_t const pos (shard.hand++);
+            Slot& slot (shard.slots [pos]);
+
+            if (! slot.ptr)
+                continue;
+
+            if (slot.referenced)
+            {
+                slot.referenced = false;
+                continue;
+            }
+
+            return evict (shard, pos);
+        }
+
+        return mapped_ptr ();
+    }
+
+    void counts (std::uint64_t& hits, std::uint64_t& misses)
+    {
+        for (auto& shard : m_shards)
+        {
+            lock_guard lock (shard.mutex);
+            hits += shard.hits;
+            misses += shard.misses;
+        }
+    }
+
+    void collect_metrics ()
+    {
+        m_stats.size.set (getCacheSize ());
+        m_stats.bytes.set (getMemoryUsage ());
+
+        {
+            beast::insight::Gauge::value_type hit_rate (0);
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            counts (hits, misses);
+            auto const total (hits + misses);
+            if (total != 0)
+                hit_rate = (hits * 100) / total;
+            m_stats.hit_rate.set (hit_rate);
+        }
+    }
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats (std::string const& prefix, Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge (prefix, "size"))
+            , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            , bytes (collector->make_gauge (prefix, "bytes"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+        beast::insight::Gauge bytes;
+    };
+
+    beast::Journal m_journal;
+    clock_type& m_clock;
+    Stats m_stats;
+
+    // Used for logging
+    std::string m_name;
+
+    Hash m_hash;
+    Estimate m_estimate;
+
+    // Desired number of cache entries, over all shards
+    std::atomic <int> m_target_size;
+
+    // Desired maximum cache age, in seconds
+    std::atomic <clock_type::rep> m_target_age;
+
+    Shard m_shards [shardCount];
+};
+
+}
+
+#endif
@@ -0,0 +1,309 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../ShardedTaggedCache.h"
+
+#include "../../beast/beast/unit_test/suite.h"
+#include "../../beast/beast/chrono/manual_clock.h"
+
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+namespace ripple {
+
+class ShardedTaggedCache_test : public beast::unit_test::suite
+{
+public:
+    typedef int Key;
+    typedef std::string Value;
+    typedef ShardedTaggedCache <Key, Value> Cache;
+
+    void testBasics ()
+    {
+        testcase ("basics");
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache c ("test", 1, 1, clock, j);
+
+        // Insert an item, retrieve it, and age it so it gets purged.
+        {
+            expect (c.getCacheSize() == 0);
+            expect (! c.insert (1, "one"));
+            expect (c.getCacheSize() == 1);
+
+            {
+                std::string s;
+                expect (c.retrieve (1, s));
+                expect (s == "one");
+            }
+
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize () == 0);
+        }
+
+        // Insert the same key/value pair and make sure we get the same result
+        {
+            expect (! c.insert (3, "three"));
+
+            {
+                Cache::mapped_ptr const p1 (c.fetch (3));
+                Cache::mapped_ptr p2 (boost::make_shared <Value> ("three"));
+                expect (c.canonicalize (3, p2));
+                expect (p1.get() == p2.get());
+
+                Cache::mapped_ptr p3 (boost::make_shared <Value> ("three"));
+                expect (c.canonicalize (3, p3, true));
+                expect (c.fetch (3).get () == p3.get ());
+            }
+
+            expect (c.del (3, true));
+            expect (! c.fetch (3));
+            expect (c.getCacheSize() == 0);
+        }
+    }
+
+    void testEviction ()
+    {
+        testcase ("eviction");
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        int const target = 16 * 64;
+        Cache c ("test", target, 60, clock, j);
+
+        // A key used between every insertion survives the churn
+        c.insert (-1, "hot");
+
+        for (int i = 0; i < 20 * target; ++i)
+        {
+            c.insert (i, std::to_string (i));
+
+            if (! c.fetch (-1))
+            {
+                fail ("Referenced entry was evicted");
+                break;
+            }
+        }
+
+        expect (c.getCacheSize () <= target, "Cache grew past its target");
+
+        // Entries older than the target age go, the rest stay
+        clock.set (30);
+        c.insert (-2, "new");
+        c.fetch (-1);
+        clock.set (61);
+        c.sweep ();
+        expect (c.getCacheSize () == 2, "Sweep kept expired entries");
+        expect (c.fetch (-1) && c.fetch (-2), "Sweep removed fresh entries");
+        expect (c.getMemoryUsage () >= 2 * sizeof (Value), "Entries not counted");
+
+        c.clear ();
+        expect (c.getCacheSize () == 0);
+        expect (c.getMemoryUsage () == 0, "Cleared entries still counted");
+    }
+
+    void testResize ()
+    {
+        testcase ("resize");
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        int const target = 16 * 64;
+        Cache c ("test", target, 60, clock, j);
+
+        for (int i = 0; i < 4 * target; ++i)
+            c.insert (i, std::to_string (i));
+
+        int const full (c.getCacheSize ());
+        std::size_t const fullBytes (c.getMemoryUsage ());
+        expect (full > target / 2, "Cache did not fill");
+
+        // Growing evicts nothing
+        c.setTargetSize (2 * target);
+        expect (c.getCacheSize () == full, "Growing the target evicted");
+
+        // Shrinking evicts at once, without waiting for inserts
+        c.setTargetSize (target / 8);
+        expect (c.getCacheSize () <= target / 8, "Shrinking the target kept entries");
+        expect (c.getCacheSize () > 0, "Shrinking the target emptied the cache");
+        expect (c.getMemoryUsage () < fullBytes, "Evicted entries still counted");
+
+        // And the cache stays within the smaller target
+        for (int i = 0; i < 4 * target; ++i)
+            c.insert (-i - 1, std::to_string (i));
+
+        expect (c.getCacheSize () <= target / 8, "Cache grew past its new target");
+    }
+
+    void testThreads ()
+    {
+        testcase ("threads");
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache c ("test", 1000, 60, clock, j);
+        std::vector <std::thread> threads;
+        std::atomic <int> failures (0);
+
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.emplace_back ([&, t]
+            {
+                std::mt19937 r (t);
+
+                for (int i = 0; i < 20000; ++i)
+                {
+                    int const key (r () % 4000);
+                    Cache::mapped_ptr p (boost::make_shared <Value> (
+                        std::to_string (key)));
+
+                    c.canonicalize (key, p);
+
+                    if (*p != std::to_string (key))
+                        ++failures;
+
+                    Cache::mapped_ptr const q (c.fetch (r () % 4000));
+                    if (q && q->empty ())
+                        ++failures;
+                }
+            });
+        }
+
+        for (auto& t : threads)
+            t.join ();
+
+        expect (failures == 0, "Wrong values under contention");
+        expect (c.getCacheSize () <= 1000 + 16, "Cache grew past its target");
+    }
+
+    void run ()
+    {
+        testBasics ();
+        testEviction ();
+        testResize ();
+        testThreads ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardedTaggedCache,common,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times fetch and canonicalize from many threads on each cache.
+
+    Every thread does the mix the tree node cache sees during acquisition:
+    mostly fetches, with a canonicalize for each miss. The key space is
+    twice the target size so that eviction keeps running. The thread count
+    is 16, or as many as TAGGEDCACHE_BENCH_THREADS says.
+*/
+class ShardedTaggedCacheTiming_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    template <class Cache>
+    void measure (std::string const& name, int threadCount)
+    {
+        int const target = 65536;
+        int const operations = 500000;
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache cache (name, target, 60, clock, j);
+        std::vector <std::thread> threads;
+
+        auto const start = clock_type::now ();
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back ([&, t]
+            {
+                std::mt19937 r (t);
+
+                for (int i = 0; i < operations; ++i)
+                {
+                    int const key (r () % (2 * target));
+
+                    if (! cache.fetch (key))
+                    {
+                        auto p (boost::make_shared <int> (key));
+                        cache.canonicalize (key, p);
+                    }
+                }
+            });
+        }
+
+        // Sweeps run alongside, as they do on the server
+        std::atomic <bool> stop (false);
+        std::thread sweeper ([&]
+        {
+            while (! stop)
+            {
+                cache.sweep ();
+                std::this_thread::sleep_for (std::chrono::milliseconds (10));
+            }
+        });
+
+        for (auto& t : threads)
+            t.join ();
+
+        stop = true;
+        sweeper.join ();
+
+        auto const elapsed = std::chrono::duration_cast <
+            std::chrono::milliseconds> (clock_type::now () - start);
+
+        log << name << ", " << threadCount << " threads: " <<
+            (threadCount * double (operations) / elapsed.count () / 1000) <<
+            "M operations/s, hit rate " << cache.getHitRate () << "%";
+
+        pass ();
+    }
+
+    void run ()
+    {
+        int threads = 16;
+
+        if (char const* env = std::getenv ("TAGGEDCACHE_BENCH_THREADS"))
+            threads = std::max (1, std::atoi (env));
+
+        for (int n : { 1, threads })
+        {
+            measure <TaggedCache <int, int>> ("TaggedCache", n);
+            measure <ShardedTaggedCache <int, int>> ("ShardedTaggedCache", n);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ShardedTaggedCacheTiming,common,ripple);
+
+}
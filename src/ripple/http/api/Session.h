@@ -82,6 +82,15 @@ public:
     virtual void write (void const* buffer, std::size_t bytes) = 0;
     /** @} */
 
+    /** Wait until less than `bytes` of written data is waiting to be sent.
+        Writes go out one after another, so a caller producing a large
+        reply can use this to hold only a bounded amount of it in memory.
+        Returns `false` if the connection failed, or sent nothing for a
+        minute; further writes are then pointless. Must not be called
+        from the server's io_service threads, which complete the writes.
+    */
+    virtual bool waitForRoom (std::size_t bytes) = 0;
+
     /** Output support using ostream. */
     /** @{ */
     ScopedStream operator<< (std::ostream& manip (std::ostream&))
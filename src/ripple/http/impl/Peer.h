@@ -20,7 +20,10 @@
 #ifndef RIPPLE_HTTP_PEER_H_INCLUDED
 #define RIPPLE_HTTP_PEER_H_INCLUDED
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 
 #include "../../ripple/common/MultiSocket.h"
 
@@ -51,8 +54,10 @@ public:
         dataTimeoutSeconds = 10,
 
         // Max seconds without completing the request
-        requestTimeoutSeconds = 30
+        requestTimeoutSeconds = 30,
 
+        // Max seconds waitForRoom waits without any write completing
+        writeTimeoutSeconds = 60
     };
 
     typedef beast::SharedPtr <Peer> Ptr;
@@ -64,7 +69,6 @@ public:
     std::unique_ptr <MultiSocket> m_socket;
     beast::MemoryBlock m_buffer;
     beast::HTTPRequestParser m_parser;
-    int m_writesPending;
     bool m_closed;
     bool m_callClose;
     beast::SharedPtr <Peer> m_detach_ref;
@@ -72,6 +76,15 @@ public:
     int m_errorCode;
     std::atomic <int> m_detached;
 
+    // Data waiting to be sent. Only the front buffer is being written,
+    // the next write starts when it completes, so writes never overlap.
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCond;
+    std::deque <SharedBuffer> m_writeQueue;
+    std::size_t m_writeQueueBytes;
+    std::uint64_t m_writesCompleted;
+    bool m_writeFailed;
+
     //--------------------------------------------------------------------------
 
     Peer (ServerImpl& impl, Port const& port)
@@ -80,11 +93,13 @@ public:
         , m_data_timer (m_impl.get_io_service())
         , m_request_timer (m_impl.get_io_service())
         , m_buffer (bufferSize)
-        , m_writesPending (0)
         , m_closed (false)
         , m_callClose (false)
         , m_errorCode (0)
         , m_detached (0)
+        , m_writeQueueBytes (0)
+        , m_writesCompleted (0)
+        , m_writeFailed (false)
     {
         tag = nullptr;
 
@@ -156,16 +171,52 @@ public:
         return s;
     }
 
-    // Send a copy of the data.
+    // Queue a copy of the data.
     void write (void const* buffer, std::size_t bytes)
     {
+        if (bytes == 0)
+            return;
+
+        bool start;
+
+        {
+            std::lock_guard <std::mutex> lock (m_writeMutex);
+
+            if (m_writeFailed)
+                return;
+
+            m_writeQueue.push_back (SharedBuffer (
+                static_cast <char const*> (buffer), bytes));
+            m_writeQueueBytes += bytes;
+            start = (m_writeQueue.size () == 1);
+        }
+
         // Make sure this happens on an io_service thread.
-        m_impl.get_io_service().dispatch (m_strand.wrap (
-            boost::bind (&Peer::handle_write, Ptr (this),
-                SharedBuffer (static_cast <char const*> (buffer), bytes),
+        if (start)
+            m_impl.get_io_service().dispatch (m_strand.wrap (
+                boost::bind (&Peer::handle_write, Ptr (this),
                     CompletionCounter (this))));
     }
 
+    bool waitForRoom (std::size_t bytes)
+    {
+        std::unique_lock <std::mutex> lock (m_writeMutex);
+
+        while (! m_writeFailed && m_writeQueueBytes >= bytes)
+        {
+            std::uint64_t const completed (m_writesCompleted);
+
+            if (m_writeCond.wait_for (lock, std::chrono::seconds (
+                    writeTimeoutSeconds)) == std::cv_status::timeout &&
+                m_writesCompleted == completed)
+            {
+                return false;
+            }
+        }
+
+        return ! m_writeFailed;
+    }
+
     // Make the Session asynchronous
     void detach ()
     {
@@ -240,10 +291,10 @@ public:
         }
     }
 
-    // Called from an io_service thread to write the shared buffer.
-    void handle_write (SharedBuffer const& buf, CompletionCounter)
+    // Called from an io_service thread to start writing the queue.
+    void handle_write (CompletionCounter)
     {
-        async_write (buf);
+        async_write ();
     }
 
     // Called when the handshake completes
@@ -307,16 +358,35 @@ public:
         SharedBuffer buf, CompletionCounter)
     {
         if (ec == boost::asio::error::operation_aborted)
+        {
+            write_failed ();
             return;
+        }
 
         if (ec != 0)
         {
+            write_failed ();
             failed (ec);
             return;
         }
 
-        bassert (m_writesPending > 0);
-        if (--m_writesPending == 0 && m_closed)
+        bool more;
+
+        {
+            std::lock_guard <std::mutex> lock (m_writeMutex);
+
+            bassert (! m_writeQueue.empty ());
+            m_writeQueueBytes -= m_writeQueue.front ()->size ();
+            m_writeQueue.pop_front ();
+            ++m_writesCompleted;
+            more = ! m_writeQueue.empty ();
+        }
+
+        m_writeCond.notify_all ();
+
+        if (more)
+            async_write ();
+        else if (m_closed)
             m_socket->shutdown (socket::shutdown_send);
     }
 
@@ -473,17 +543,24 @@ public:
                         CompletionCounter (this))));
     }
 
-    // Send a shared buffer
-    void async_write (SharedBuffer const& buf)
+    // Send the buffer at the front of the write queue
+    void async_write ()
     {
-        bassert (buf.get().size() > 0);
+        SharedBuffer buf;
+
+        {
+            std::lock_guard <std::mutex> lock (m_writeMutex);
 
-        ++m_writesPending;
+            if (m_writeQueue.empty ())
+                return;
+
+            buf = m_writeQueue.front ();
+        }
 
-        // Send the copy. We pass the SharedBuffer in the last parameter
-        // so that a reference is maintained as the handler gets copied.
-        // When the final completion function returns, the reference
-        // count will drop to zero and the buffer will be freed.
+        bassert (buf.get().size() > 0);
+
+        // We pass the SharedBuffer in the last parameter so that a
+        // reference is maintained as the handler gets copied.
         //
         boost::asio::async_write (*m_socket,
             boost::asio::const_buffers_1 (&(*buf)[0], buf->size()),
@@ -493,23 +570,18 @@ public:
                             buf, CompletionCounter (this))));
     }
 
-    // Send a copy of a BufferSequence
-    template <typename BufferSequence>
-    void async_write (BufferSequence const& buffers)
+    // Drops the write queue and wakes any waitForRoom caller
+    void write_failed ()
     {
-        // Iterate over each linear vector in the BufferSequence.
-        for (typename BufferSequence::const_iterator iter (buffers.begin());
-            iter != buffers.end(); ++iter)
         {
-            typename BufferSequence::value_type const& buffer (*iter);
+            std::lock_guard <std::mutex> lock (m_writeMutex);
 
-            // Put a copy of this section of the buffer sequence into
-            // a reference counted, shared container.
-            //
-            async_write (SharedBuffer (
-                boost::asio::buffer_cast <char const*> (buffer),
-                    boost::asio::buffer_size (buffer)));
+            m_writeFailed = true;
+            m_writeQueue.clear ();
+            m_writeQueueBytes = 0;
         }
+
+        m_writeCond.notify_all ();
     }
 };
 
@@ -59,6 +59,46 @@ private:
     bool yamlCompatiblityEnabled_;
 };
 
+/** \brief Outputs a Value in compact <a HREF="http://www.json.org">JSON</a> format
+ *         to a caller supplied sink, in fixed size chunks.
+ *
+ * The output is the same as FastWriter's, less the trailing newline. Since the
+ * document is never held in memory all at once, this is suited to sending very
+ * large values (a full ledger, for example) straight to a socket or a file.
+ * The sink is called each time the chunk buffer fills, and from flush ().
+ * \sa FastWriter
+ */
+class JSON_API StreamWriter
+{
+public:
+    typedef std::function <void (char const* data, std::size_t bytes)> Sink;
+
+    explicit StreamWriter ( Sink const& sink, std::size_t chunkSize = 64 * 1024 );
+
+    /** Flushes any buffered output. */
+    ~StreamWriter ();
+
+    StreamWriter ( StreamWriter const& ) = delete;
+    StreamWriter& operator= ( StreamWriter const& ) = delete;
+
+    /** Serialize a Value. May be called more than once. */
+    void write ( const Value& root );
+
+    /** Write raw bytes, for framing around serialized values. */
+    void write ( char const* data, std::size_t bytes );
+
+    /** Pass any buffered output to the sink. */
+    void flush ();
+
+    /** Returns the number of bytes write () would produce for a Value. */
+    static std::size_t measure ( const Value& root );
+
+private:
+    Sink sink_;
+    std::vector <char> buffer_;
+    std::size_t used_;
+};
+
 /** \brief Writes a Value in <a HREF="http://www.json.org">JSON</a> format in a human friendly way.
  *
  * The rules for line break and indent are as follow:
@@ -20,6 +20,8 @@
 #include "../../../beast/beast/unit_test/suite.h"
 #include "../../../beast/beast/utility/type_name.h"
 
+#include <chrono>
+
 namespace ripple {
 
 class JsonCpp_test : public beast::unit_test::suite
@@ -84,14 +86,290 @@ public:
         pass ();
     }
 
+    std::string
+    streamed (Json::Value const& v, std::size_t chunkSize)
+    {
+        std::string result;
+        {
+            Json::StreamWriter w ([&result](char const* data, std::size_t bytes)
+            {
+                result.append (data, bytes);
+            }, chunkSize);
+            w.write (v);
+        }
+        return result;
+    }
+
+    void
+    test_stream_writer ()
+    {
+        Json::Value v (Json::objectValue);
+        v["null"] = Json::Value ();
+        v["int"] = -42;
+        v["min"] = Json::Value::minInt;
+        v["uint"] = Json::Value::maxUInt;
+        v["real"] = 0.5;
+        v["bool"] = true;
+        v["escape"] = "quote\" back\\ tab\t nl\n bell\x07 utf8 \xc3\xa9";
+        v["empty"] = Json::Value (Json::objectValue);
+        v["array"] = Json::Value (Json::arrayValue);
+        v["array"].append (1);
+        v["array"].append ("two");
+        v["array"].append (Json::Value (Json::arrayValue));
+        v["holes"][2u] = 3;
+
+        Json::FastWriter fw;
+        std::string const fast (fw.write (v));
+
+        expect (fast == "{\"array\":[1,\"two\",[]],\"bool\":true,"
+            "\"empty\":{},\"escape\":\"quote\\\" back\\\\ tab\\t nl\\n "
+            "bell\\u0007 utf8 \xc3\xa9\",\"holes\":[null,null,3],"
+            "\"int\":-42,\"min\":-2147483648,\"null\":null,"
+            "\"real\":0.5,\"uint\":4294967295}\n", fast);
+
+        // Every chunk size, including ones smaller than a single token,
+        // must produce the same document.
+        std::string const expected (fast.substr (0, fast.size () - 1));
+        for (std::size_t chunkSize : { 1, 2, 7, 64, 65536 })
+            expect (streamed (v, chunkSize) == expected);
+
+        expect (Json::StreamWriter::measure (v) == expected.size ());
+
+        Json::Value parsed;
+        Json::Reader r;
+        expect (r.parse (expected, parsed));
+        expect (parsed["escape"] == v["escape"]);
+    }
+
     void run ()
     {
         testBadJson ();
         test_copy ();
         test_move ();
+        test_stream_writer ();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(JsonCpp,json,ripple);
 
+//------------------------------------------------------------------------------
+
+// Compares the writers on a document shaped like the output of
+// `ledger` with `full` set: a large accountState array of account roots,
+// trust lines and offers, followed by transactions with metadata.
+//
+class JsonWriterTiming_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        accountStateEntries = 200000,
+        transactionCount = 5000,
+        iterations = 3
+    };
+
+    std::string
+    hash (int seed, int salt)
+    {
+        static char const hex[] = "0123456789ABCDEF";
+        std::string s (64, '0');
+        std::uint32_t x (seed * 2654435761u + salt);
+        for (auto& c : s)
+        {
+            x = x * 1103515245u + 12345u;
+            c = hex [(x >> 16) & 0xF];
+        }
+        return s;
+    }
+
+    std::string
+    account (int seed)
+    {
+        static char const alphabet[] =
+            "gsphnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCr65jkm8oFqi1tuvAxyz";
+        std::string s ("g");
+        std::uint32_t x (seed * 2246822519u + 7);
+        for (int i = 0; i < 33; ++i)
+        {
+            x = x * 1103515245u + 12345u;
+            s.push_back (alphabet [(x >> 16) % 58]);
+        }
+        return s;
+    }
+
+    Json::Value
+    amount (int seed)
+    {
+        Json::Value v (Json::objectValue);
+        v["currency"] = "USD";
+        v["issuer"] = account (seed);
+        v["value"] = std::to_string (seed % 100000) + "." +
+            std::to_string (seed % 997);
+        return v;
+    }
+
+    Json::Value
+    makeLedger ()
+    {
+        Json::Value ledger (Json::objectValue);
+        ledger["accepted"] = true;
+        ledger["account_hash"] = hash (0, 1);
+        ledger["close_time"] = 449681570;
+        ledger["close_time_human"] = "2014-Apr-02 15:32:50";
+        ledger["ledger_hash"] = hash (0, 2);
+        ledger["ledger_index"] = "5999999";
+        ledger["parent_hash"] = hash (0, 3);
+        ledger["total_coins"] = "99999999999999999";
+        ledger["transaction_hash"] = hash (0, 4);
+
+        Json::Value& state (ledger["accountState"] = Json::arrayValue);
+
+        for (int i = 0; i < accountStateEntries; ++i)
+        {
+            Json::Value& entry (state.append (Json::objectValue));
+
+            switch (i % 3)
+            {
+            case 0:
+                entry["Account"] = account (i);
+                entry["Balance"] = std::to_string (i * 1000003LL);
+                entry["Flags"] = 0;
+                entry["LedgerEntryType"] = "AccountRoot";
+                entry["OwnerCount"] = i % 11;
+                entry["Sequence"] = i % 1000;
+                break;
+
+            case 1:
+                entry["Balance"] = amount (i);
+                entry["Flags"] = 131072;
+                entry["HighLimit"] = amount (i + 1);
+                entry["LedgerEntryType"] = "RippleState";
+                entry["LowLimit"] = amount (i + 2);
+                break;
+
+            default:
+                entry["Account"] = account (i);
+                entry["BookDirectory"] = hash (i, 5);
+                entry["Flags"] = 0;
+                entry["LedgerEntryType"] = "Offer";
+                entry["Sequence"] = i % 1000;
+                entry["TakerGets"] = amount (i);
+                entry["TakerPays"] = std::to_string (i * 7919LL);
+                break;
+            }
+
+            entry["PreviousTxnID"] = hash (i, 6);
+            entry["PreviousTxnLgrSeq"] = 5000000 + (i % 999999);
+            entry["index"] = hash (i, 7);
+        }
+
+        Json::Value& txs (ledger["transactions"] = Json::arrayValue);
+
+        for (int i = 0; i < transactionCount; ++i)
+        {
+            Json::Value& tx (txs.append (Json::objectValue));
+            tx["Account"] = account (i);
+            tx["Amount"] = amount (i);
+            tx["Destination"] = account (i + 1);
+            tx["Fee"] = "10";
+            tx["Flags"] = 2147483648u;
+            tx["Sequence"] = i;
+            tx["SigningPubKey"] = hash (i, 8);
+            tx["TransactionType"] = "Payment";
+            tx["TxnSignature"] = hash (i, 9) + hash (i, 10);
+            tx["hash"] = hash (i, 11);
+
+            Json::Value& meta (tx["metaData"] = Json::objectValue);
+            Json::Value& nodes (meta["AffectedNodes"] = Json::arrayValue);
+            for (int n = 0; n < 4; ++n)
+            {
+                Json::Value& fields (nodes.append (Json::objectValue)
+                    ["ModifiedNode"]);
+                fields["LedgerEntryType"] = "RippleState";
+                fields["LedgerIndex"] = hash (i, 12 + n);
+                fields["FinalFields"]["Balance"] = amount (i + n);
+                fields["PreviousFields"]["Balance"] = amount (i + n + 1);
+            }
+            meta["TransactionIndex"] = i;
+            meta["TransactionResult"] = "tesSUCCESS";
+        }
+
+        Json::Value result (Json::objectValue);
+        result["ledger"] = ledger;
+        return result;
+    }
+
+    template <class Function>
+    double
+    measure (Function f)
+    {
+        double best (0);
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto const start (std::chrono::steady_clock::now ());
+            f ();
+            double const elapsed (std::chrono::duration <double> (
+                std::chrono::steady_clock::now () - start).count ());
+            if (i == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    void
+    report (std::string const& name, double seconds, std::size_t bytes)
+    {
+        std::stringstream ss;
+        ss << std::setw (14) << std::left << name <<
+            std::fixed << std::setprecision (3) << seconds << "s  " <<
+            std::setprecision (1) << (bytes / seconds / (1024 * 1024)) <<
+            " MB/s";
+        log << ss.str ();
+    }
+
+    void run ()
+    {
+        testcase ("full ledger");
+
+        Json::Value const ledger (makeLedger ());
+        std::size_t const bytes (Json::StreamWriter::measure (ledger));
+
+        log << "document is " << bytes << " bytes";
+
+        std::size_t fastSize (0);
+        report ("FastWriter", measure ([&]
+        {
+            Json::FastWriter w;
+            fastSize = w.write (ledger).size ();
+        }), bytes);
+
+        report ("StyledWriter", measure ([&]
+        {
+            Json::StyledWriter w;
+            w.write (ledger);
+        }), bytes);
+
+        std::size_t streamSize (0);
+        report ("StreamWriter", measure ([&]
+        {
+            streamSize = 0;
+            Json::StreamWriter w ([&](char const*, std::size_t n)
+            {
+                streamSize += n;
+            });
+            w.write (ledger);
+        }), bytes);
+
+        report ("measure", measure ([&]
+        {
+            Json::StreamWriter::measure (ledger);
+        }), bytes);
+
+        expect (fastSize == bytes + 1);
+        expect (streamSize == bytes);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JsonWriterTiming,json,ripple);
+
 } // ripple
@@ -20,21 +20,6 @@
 namespace Json
 {
 
-static bool isControlCharacter (char ch)
-{
-    return ch > 0 && ch <= 0x1F;
-}
-
-static bool containsControlCharacter ( const char* str )
-{
-    while ( *str )
-    {
-        if ( isControlCharacter ( * (str++) ) )
-            return true;
-    }
-
-    return false;
-}
 static void uintToString ( unsigned int value,
                            char*& current )
 {
@@ -97,77 +82,280 @@ std::string valueToString ( bool value )
     return value ? "true" : "false";
 }
 
-std::string valueToQuotedString ( const char* value )
+//------------------------------------------------------------------------------
+
+// Compact serialization shared by FastWriter and StreamWriter.
+//
+// The Output type provides put (char) and put (char const*, std::size_t).
+// Runs of characters which need no escaping are copied in one call, and
+// numbers are formatted on the stack, so nothing here allocates.
+//
+namespace detail
 {
-    // Not sure how to handle unicode...
-    if (strpbrk (value, "\"\\\b\f\n\r\t") == nullptr && !containsControlCharacter ( value ))
-        return std::string ("\"") + value + "\"";
 
-    // We have to walk value and escape any special characters.
-    // Appending to std::string is not efficient, but this should be rare.
-    // (Note: forward slashes are *not* rare, but I am not escaping them.)
-    unsigned maxsize = strlen (value) * 2 + 3; // allescaped+quotes+NULL
-    std::string result;
-    result.reserve (maxsize); // to avoid lots of mallocs
-    result += "\"";
+// Non-zero for characters which must be escaped inside a JSON string
+static char const escapeTable[256] =
+{
+    // 0x00 - 0x1F: control characters
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    // 0x20 - 0x7F: only '"' and '\\'
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    // 0x80 - 0xFF: passed through untouched
+};
+
+template <class Output>
+void putQuoted (Output& out, const char* value)
+{
+    out.put ('"');
+
+    const char* run = value;
+    const char* c = value;
 
-    for (const char* c = value; *c != 0; ++c)
+    for (; *c != 0; ++c)
     {
-        switch (*c)
+        unsigned char const ch = static_cast <unsigned char> (*c);
+
+        if (! escapeTable[ch])
+            continue;
+
+        if (c != run)
+            out.put (run, c - run);
+
+        run = c + 1;
+
+        switch (ch)
         {
-        case '\"':
-            result += "\\\"";
-            break;
-
-        case '\\':
-            result += "\\\\";
-            break;
-
-        case '\b':
-            result += "\\b";
-            break;
-
-        case '\f':
-            result += "\\f";
-            break;
-
-        case '\n':
-            result += "\\n";
-            break;
-
-        case '\r':
-            result += "\\r";
-            break;
-
-        case '\t':
-            result += "\\t";
-            break;
-
-            //case '/':
-            // Even though \/ is considered a legal escape in JSON, a bare
-            // slash is also legal, so I see no reason to escape it.
-            // (I hope I am not misunderstanding something.
-            // blep notes: actually escaping \/ may be useful in javascript to avoid </
-            // sequence.
-            // Should add a flag to allow this compatibility mode and prevent this
-            // sequence from occurring.
+        case '\"':  out.put ("\\\"", 2); break;
+        case '\\':  out.put ("\\\\", 2); break;
+        case '\b':  out.put ("\\b", 2); break;
+        case '\f':  out.put ("\\f", 2); break;
+        case '\n':  out.put ("\\n", 2); break;
+        case '\r':  out.put ("\\r", 2); break;
+        case '\t':  out.put ("\\t", 2); break;
+
         default:
-            if ( isControlCharacter ( *c ) )
-            {
-                std::ostringstream oss;
-                oss << "\\u" << std::hex << std::uppercase << std::setfill ('0') << std::setw (4) << static_cast<int> (*c);
-                result += oss.str ();
-            }
+        {
+            static char const hex[] = "0123456789ABCDEF";
+            char buffer[6] = { '\\', 'u', '0', '0',
+                hex [ch >> 4], hex [ch & 0xF] };
+            out.put (buffer, sizeof (buffer));
+        }
+        break;
+        }
+    }
+
+    if (c != run)
+        out.put (run, c - run);
+
+    out.put ('"');
+}
+
+template <class Output>
+void putUInt (Output& out, UInt value)
+{
+    char buffer[16];
+    char* const end = buffer + sizeof (buffer);
+    char* current = end;
+
+    do
+    {
+        *--current = (value % 10) + '0';
+        value /= 10;
+    }
+    while (value != 0);
+
+    out.put (current, end - current);
+}
+
+template <class Output>
+void putInt (Output& out, Int value)
+{
+    if (value < 0)
+    {
+        out.put ('-');
+        // Negate in unsigned arithmetic so minInt does not overflow
+        putUInt (out, UInt (0) - UInt (value));
+    }
+    else
+    {
+        putUInt (out, UInt (value));
+    }
+}
+
+template <class Output>
+void putValue (Output& out, const Value& value, bool yamlCompatible)
+{
+    switch (value.type ())
+    {
+    case nullValue:
+        out.put ("null", 4);
+        break;
+
+    case intValue:
+        putInt (out, value.asInt ());
+        break;
+
+    case uintValue:
+        putUInt (out, value.asUInt ());
+        break;
+
+    case realValue:
+    {
+        std::string const s (valueToString (value.asDouble ()));
+        out.put (s.data (), s.size ());
+    }
+    break;
+
+    case stringValue:
+        putQuoted (out, value.asCString ());
+        break;
+
+    case booleanValue:
+        if (value.asBool ())
+            out.put ("true", 4);
+        else
+            out.put ("false", 5);
+        break;
+
+    case arrayValue:
+    {
+        // Walk the storage directly rather than looking up each index.
+        // Missing indices are written as null, as operator[] would.
+        out.put ('[');
+
+        UInt next = 0;
+
+        for (Value::const_iterator it = value.begin ();
+            it != value.end (); ++it)
+        {
+            for (UInt const index = it.index (); next < index; ++next)
+                out.put (next == 0 ? "null" : ",null", next == 0 ? 4 : 5);
+
+            if (next > 0)
+                out.put (',');
+
+            putValue (out, *it, yamlCompatible);
+            ++next;
+        }
+
+        out.put (']');
+    }
+    break;
+
+    case objectValue:
+    {
+        out.put ('{');
+
+        for (Value::const_iterator it = value.begin ();
+            it != value.end (); ++it)
+        {
+            if (it != value.begin ())
+                out.put (',');
+
+            putQuoted (out, it.memberName ());
+
+            if (yamlCompatible)
+                out.put (": ", 2);
             else
-            {
-                result += *c;
-            }
+                out.put (':');
 
-            break;
+            putValue (out, *it, yamlCompatible);
         }
+
+        out.put ('}');
+    }
+    break;
+    }
+}
+
+// Appends to a std::string
+class StringOutput
+{
+public:
+    explicit StringOutput (std::string& s)
+        : s_ (s)
+    {
+    }
+
+    void put (char c)
+    {
+        s_.push_back (c);
+    }
+
+    void put (char const* data, std::size_t bytes)
+    {
+        s_.append (data, bytes);
+    }
+
+private:
+    std::string& s_;
+};
+
+// Buffers into a StreamWriter
+class StreamOutput
+{
+public:
+    explicit StreamOutput (StreamWriter& writer)
+        : writer_ (writer)
+    {
+    }
+
+    void put (char c)
+    {
+        writer_.write (&c, 1);
+    }
+
+    void put (char const* data, std::size_t bytes)
+    {
+        writer_.write (data, bytes);
     }
 
-    result += "\"";
+private:
+    StreamWriter& writer_;
+};
+
+// Counts the bytes which would be written
+class CountingOutput
+{
+public:
+    CountingOutput ()
+        : bytes_ (0)
+    {
+    }
+
+    void put (char)
+    {
+        ++bytes_;
+    }
+
+    void put (char const*, std::size_t bytes)
+    {
+        bytes_ += bytes;
+    }
+
+    std::size_t bytes () const
+    {
+        return bytes_;
+    }
+
+private:
+    std::size_t bytes_;
+};
+
+} // detail
+
+std::string valueToQuotedString ( const char* value )
+{
+    std::string result;
+    result.reserve (strlen (value) + 2);
+    detail::StringOutput out (result);
+    detail::putQuoted (out, value);
     return result;
 }
 
@@ -207,73 +395,70 @@ FastWriter::write ( const Value& root )
 void
 FastWriter::writeValue ( const Value& value )
 {
-    switch ( value.type () )
-    {
-    case nullValue:
-        document_ += "null";
-        break;
-
-    case intValue:
-        document_ += valueToString ( value.asInt () );
-        break;
+    detail::StringOutput out (document_);
+    detail::putValue (out, value, yamlCompatiblityEnabled_);
+}
 
-    case uintValue:
-        document_ += valueToString ( value.asUInt () );
-        break;
 
-    case realValue:
-        document_ += valueToString ( value.asDouble () );
-        break;
+// Class StreamWriter
+// //////////////////////////////////////////////////////////////////
 
-    case stringValue:
-        document_ += valueToQuotedString ( value.asCString () );
-        break;
+StreamWriter::StreamWriter (Sink const& sink, std::size_t chunkSize)
+    : sink_ (sink)
+    , buffer_ (chunkSize > 0 ? chunkSize : 1)
+    , used_ (0)
+{
+}
 
-    case booleanValue:
-        document_ += valueToString ( value.asBool () );
-        break;
 
-    case arrayValue:
-    {
-        document_ += "[";
-        int size = value.size ();
+StreamWriter::~StreamWriter ()
+{
+    flush ();
+}
 
-        for ( int index = 0; index < size; ++index )
-        {
-            if ( index > 0 )
-                document_ += ",";
 
-            writeValue ( value[index] );
-        }
+void
+StreamWriter::write ( const Value& root )
+{
+    detail::StreamOutput out (*this);
+    detail::putValue (out, root, false);
+}
 
-        document_ += "]";
-    }
-    break;
 
-    case objectValue:
+void
+StreamWriter::write ( char const* data, std::size_t bytes )
+{
+    while (bytes > 0)
     {
-        Value::Members members ( value.getMemberNames () );
-        document_ += "{";
+        if (used_ == buffer_.size ())
+            flush ();
+
+        std::size_t const n (std::min (bytes, buffer_.size () - used_));
+        memcpy (&buffer_[used_], data, n);
+        used_ += n;
+        data += n;
+        bytes -= n;
+    }
+}
 
-        for ( Value::Members::iterator it = members.begin ();
-                it != members.end ();
-                ++it )
-        {
-            const std::string& name = *it;
 
-            if ( it != members.begin () )
-                document_ += ",";
+void
+StreamWriter::flush ()
+{
+    if (used_ > 0)
+    {
+        sink_ (&buffer_[0], used_);
+        used_ = 0;
+    }
+}
 
-            document_ += valueToQuotedString ( name.c_str () );
-            document_ += yamlCompatiblityEnabled_ ? ": "
-                         : ":";
-            writeValue ( value[name] );
-        }
 
-        document_ += "}";
-    }
-    break;
-    }
+std::size_t
+StreamWriter::measure ( const Value& root )
+{
+    detail::CountingOutput out;
+    detail::putValue (out, root, false);
+    return out.bytes ();
 }
 
 
@@ -19,8 +19,10 @@
 
 #include "../../BeastConfig.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <string>
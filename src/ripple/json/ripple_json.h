@@ -26,6 +26,7 @@
 #include "../beast/beast/utility/PropertyStream.h"
 
 #include <deque>
+#include <functional>
 #include <stack>
 #include <vector>
 
@@ -36,7 +36,7 @@ template <class Key>
 class BasicFullBelowCache
 {
 private:
-    typedef KeyCache <Key> CacheType;
+    typedef KeyCache <Key, typename Key::uniform_hasher> CacheType;
 
 public:
     typedef Key key_type;
@@ -108,7 +108,7 @@ public:
     }
 
 private:
-    KeyCache <Key> m_cache;
+    CacheType m_cache;
 };
 
 }
@@ -77,6 +77,16 @@ public:
     static Alphabet const& getBitcoinAlphabet ();
     static Alphabet const& getRippleAlphabet ();
 
+    /** Encodes big endian data.
+        The value is converted 32 bits at a time with 64-bit arithmetic,
+        in buffers on the stack for the sizes keys and account IDs use.
+    */
+    static std::string encodeBigEndian (
+        unsigned char const* begin, unsigned char const* end,
+            Alphabet const& alphabet);
+
+    // Encodes little endian data with a trailing zero pad byte, the
+    // layout the BIGNUM based encoder took
     static std::string raw_encode (
         unsigned char const* begin, unsigned char const* end,
             Alphabet const& alphabet, bool withCheck);
@@ -87,32 +97,26 @@ public:
     static std::string encode (InputIt first, InputIt last,
         Alphabet const& alphabet, bool withCheck)
     {
-        typedef typename std::iterator_traits<InputIt>::value_type value_type;
-        std::vector <typename std::remove_const <value_type>::type> v;
         std::size_t const size (std::distance (first, last));
-        if (withCheck)
-        {
-            v.reserve (size + 1 + 4);
-            v.insert (v.begin(), first, last);
-            unsigned char hash [4];
-            fourbyte_hash256 (hash, &v.front(), v.size());
-            v.resize (0);
-            // Place the hash reversed in the front
-            std::copy (std::reverse_iterator <unsigned char const*> (hash+4),
-                       std::reverse_iterator <unsigned char const*> (hash),
-                       std::back_inserter (v));
-        }
-        else
+        std::size_t const total (size + (withCheck ? 4 : 0));
+
+        // Tokens are a few dozen bytes, so this rarely allocates
+        unsigned char small [64];
+        std::vector <unsigned char> large;
+        unsigned char* data (small);
+
+        if (total > sizeof (small))
         {
-            v.reserve (size + 1);
+            large.resize (total);
+            data = &large.front ();
         }
-        // Append input little endian
-        std::copy (std::reverse_iterator <InputIt> (last),
-                   std::reverse_iterator <InputIt> (first),
-                   std::back_inserter (v));
-        // Pad zero to make the BIGNUM positive
-        v.push_back (0);
-        return raw_encode (&v.front(), &v.back()+1, alphabet, withCheck);
+
+        std::copy (first, last, data);
+
+        if (withCheck)
+            fourbyte_hash256 (data + size, data, size);
+
+        return encodeBigEndian (data, data + total, alphabet);
     }
 
     template <class Container>
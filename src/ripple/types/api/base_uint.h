@@ -36,6 +36,8 @@
 #include "../../beast/beast/container/hardened_hash.h"
 
 #include <functional>
+#include <mutex>
+#include <random>
 using namespace std;
 
 namespace ripple {
@@ -106,6 +108,53 @@ public:
     */
     typedef beast::hardened_hash <base_uint> hasher;
 
+    /** Value hashing function for values that are already uniformly
+        distributed, such as the SHA-512 half used for ledger, node and
+        transaction IDs.
+        Each 64-bit word of the value is XORed with its own random seed word
+        and the words are multiplied in pairs, so every bit of the key takes
+        part. Which keys collide depends on the seed and cannot be worked
+        out ahead of time by a peer.
+    */
+    class uniform_hasher
+    {
+    public:
+        typedef base_uint argument_type;
+        typedef std::size_t result_type;
+
+        uniform_hasher ()
+        {
+            static std::mutex mutex;
+            static std::mt19937_64 gen (makeGenerator ());
+
+            std::lock_guard <std::mutex> lock (mutex);
+
+            for (std::uint64_t& s : m_seed)
+                s = gen ();
+        }
+
+        std::size_t operator() (base_uint const& key) const noexcept
+        {
+            std::uint64_t w [4] = { 0, 0, 0, 0 };
+            memcpy (w, key.pn, std::min (sizeof (w), sizeof (key.pn)));
+
+            std::uint64_t const h =
+                ((w[0] ^ m_seed[0]) * (w[1] ^ m_seed[1])) ^
+                ((w[2] ^ m_seed[2]) * (w[3] ^ m_seed[3]));
+            return static_cast <std::size_t> (h ^ (h >> 32));
+        }
+
+    private:
+        static std::mt19937_64 makeGenerator ()
+        {
+            std::random_device rng;
+            std::seed_seq seq { rng (), rng (), rng (), rng () };
+            return std::mt19937_64 (seq);
+        }
+
+        std::uint64_t m_seed [4];
+    };
+
     /** Container equality testing function. */
     class key_equal
     {
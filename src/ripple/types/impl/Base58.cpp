@@ -22,6 +22,11 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file license.txt or http://www.opensource.org/licenses/mit-license.php.
 
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <chrono>
+#include <random>
+
 namespace ripple {
 
 void Base58::fourbyte_hash256 (void* out, void const* in, std::size_t bytes)
@@ -48,93 +53,226 @@ Base58::Alphabet const& Base58::getRippleAlphabet ()
     return alphabet;
 }
 
-std::string Base58::raw_encode (
+// The largest power of 58 that fits in 32 bits, and its exponent
+static std::uint32_t const base58Chunk = 656356768; // 58^5
+static int const base58ChunkDigits = 5;
+
+std::string Base58::encodeBigEndian (
     unsigned char const* begin, unsigned char const* end,
-        Alphabet const& alphabet, bool withCheck)
+        Alphabet const& alphabet)
 {
-    CAutoBN_CTX pctx;
-    CBigNum bn58 = 58;
-    CBigNum bn0 = 0;
+    std::size_t zeros = 0;
+    while ((begin != end) && (*begin == 0))
+    {
+        ++begin;
+        ++zeros;
+    }
 
-    // Convert little endian data to bignum
-    CBigNum bn (begin, end);
     std::size_t const size (std::distance (begin, end));
 
-    // Convert bignum to std::string
-    std::string str;
-    // Expected size increase from base58 conversion is approximately 137%
-    // use 138% to be safe
-    str.reserve (size * 138 / 100 + 1);
-    CBigNum dv;
-    CBigNum rem;
+    // The value as 32-bit limbs, most significant first
+    std::size_t const limbCount = (size + 3) / 4;
+    std::uint32_t smallLimbs [16];
+    std::vector <std::uint32_t> largeLimbs;
+    std::uint32_t* limbs = smallLimbs;
 
-    while (bn > bn0)
+    // Each byte takes log(256) / log(58), about 1.37 digits, and the
+    // last chunk may add padding digits
+    std::size_t const maxDigits = size * 138 / 100 + base58ChunkDigits;
+    char smallDigits [96];
+    std::vector <char> largeDigits;
+    char* digits = smallDigits;
+
+    if (limbCount > 16)
     {
-        if (!BN_div (&dv, &rem, &bn, &bn58, pctx))
-            throw bignum_error ("EncodeBase58 : BN_div failed");
+        largeLimbs.resize (limbCount);
+        limbs = &largeLimbs.front ();
+    }
 
-        bn = dv;
-        unsigned int c = rem.getuint ();
-        str += alphabet [c];
+    if (maxDigits > sizeof (smallDigits))
+    {
+        largeDigits.resize (maxDigits);
+        digits = &largeDigits.front ();
     }
-    
-    for (const unsigned char* p = end-2; p >= begin && *p == 0; p--)
-        str += alphabet [0];
 
-    // Convert little endian std::string to big endian
-    reverse (str.begin (), str.end ());
+    // The first limb takes whatever is left over from whole limbs
+    {
+        unsigned char const* p = begin;
+        std::size_t const head = size - 4 * (limbCount - 1);
+
+        for (std::size_t i = 0; i < limbCount; ++i)
+        {
+            std::uint32_t limb = 0;
+            for (std::size_t n = (i == 0) ? head : 4; n != 0; --n)
+                limb = (limb << 8) | *p++;
+            limbs[i] = limb;
+        }
+    }
+
+    // Divide by 58^5 until nothing is left, five digits at a time
+    char* const last = digits + maxDigits;
+    char* out = last;
+    std::size_t first = 0;
+
+    while (first < limbCount)
+    {
+        std::uint64_t rem = 0;
+
+        for (std::size_t i = first; i < limbCount; ++i)
+        {
+            std::uint64_t const cur = (rem << 32) | limbs[i];
+            limbs[i] = static_cast <std::uint32_t> (cur / base58Chunk);
+            rem = cur % base58Chunk;
+        }
+
+        while ((first < limbCount) && (limbs[first] == 0))
+            ++first;
+
+        for (int d = 0; d < base58ChunkDigits; ++d)
+        {
+            *--out = alphabet [static_cast <int> (rem % 58)];
+            rem /= 58;
+        }
+    }
+
+    // Drop the padding from the last chunk
+    while ((out != last) && (*out == alphabet [0]))
+        ++out;
+
+    std::string str;
+    str.reserve (zeros + (last - out));
+    str.assign (zeros, alphabet [0]);
+    str.append (out, last);
     return str;
 }
 
+std::string Base58::raw_encode (
+    unsigned char const* begin, unsigned char const* end,
+        Alphabet const& alphabet, bool withCheck)
+{
+    // Drop the pad byte and put the data in big endian order
+    std::size_t const size (std::distance (begin, end));
+
+    unsigned char small [64];
+    std::vector <unsigned char> large;
+    unsigned char* data (small);
+
+    if (size > sizeof (small))
+    {
+        large.resize (size);
+        data = &large.front ();
+    }
+
+    if (size == 0)
+        return std::string ();
+
+    std::reverse_copy (begin, end - 1, data);
+    return encodeBigEndian (data, data + size - 1, alphabet);
+}
+
 //------------------------------------------------------------------------------
 
-bool Base58::raw_decode (char const* first, char const* last, void* dest,
-    std::size_t size, bool checked, Alphabet const& alphabet)
+// Converts digits to the big endian bytes of their value, without leading
+// zeros. Fails on a character outside the alphabet or a value that needs
+// more than `capacity` bytes.
+static bool base58ToBytes (char const* first, char const* last,
+    Base58::Alphabet const& alphabet, unsigned char* out,
+        std::size_t capacity, std::size_t& size)
 {
-    CAutoBN_CTX pctx;
-    CBigNum bn58 = 58;
-    CBigNum bn = 0;
-    CBigNum bnChar;
+    // The value as 32-bit limbs, least significant first
+    std::size_t const maxLimbs = capacity / 4 + 1;
+    std::uint32_t smallLimbs [32];
+    std::vector <std::uint32_t> largeLimbs;
+    std::uint32_t* limbs = smallLimbs;
+    std::size_t limbCount = 0;
+
+    if (maxLimbs > 32)
+    {
+        largeLimbs.resize (maxLimbs);
+        limbs = &largeLimbs.front ();
+    }
 
-    // Convert big endian string to bignum
-    for (char const* p = first; p != last; ++p)
+    // Multiply in up to five digits at a time
+    while (first != last)
     {
-        int i (alphabet.from_char (*p));
-        if (i == -1)
-            return false;
-        bnChar.setuint ((unsigned int) i);
+        std::uint64_t mul = 1;
+        std::uint64_t carry = 0;
+
+        for (int d = 0; (d < base58ChunkDigits) && (first != last); ++d, ++first)
+        {
+            unsigned char const c = static_cast <unsigned char> (*first);
+            int const digit = (c < 128) ? alphabet.from_char (c) : -1;
 
-        int const success (BN_mul (&bn, &bn, &bn58, pctx));
-        assert (success);
+            if (digit == -1)
+                return false;
+
+            mul *= 58;
+            carry = carry * 58 + digit;
+        }
+
+        for (std::size_t i = 0; i < limbCount; ++i)
+        {
+            std::uint64_t const cur = limbs[i] * mul + carry;
+            limbs[i] = static_cast <std::uint32_t> (cur);
+            carry = cur >> 32;
+        }
+
+        if (carry != 0)
+        {
+            if (limbCount == maxLimbs)
+                return false;
 
-        bn += bnChar;
+            limbs[limbCount++] = static_cast <std::uint32_t> (carry);
+        }
     }
 
-    // Get bignum as little endian data
-    Blob vchTmp = bn.getvch ();
+    // Write out the limbs, skipping the leading zero bytes
+    size = 0;
+
+    for (std::size_t i = limbCount; i-- != 0;)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            unsigned char const byte = static_cast <unsigned char> (limbs[i] >> shift);
+
+            if ((size == 0) && (byte == 0))
+                continue;
 
-    // Trim off sign byte if present
-    if (vchTmp.size () >= 2 && vchTmp.end ()[-1] == 0 && vchTmp.end ()[-2] >= 0x80)
-        vchTmp.erase (vchTmp.end () - 1);
+            if (size == capacity)
+                return false;
+
+            out[size++] = byte;
+        }
+    }
 
-    char* const out (static_cast <char*> (dest));
+    return true;
+}
+
+bool Base58::raw_decode (char const* first, char const* last, void* dest,
+    std::size_t size, bool checked, Alphabet const& alphabet)
+{
+    unsigned char* const out (static_cast <unsigned char*> (dest));
 
     // Count leading zeros
-    int nLeadingZeros = 0;
+    std::size_t nLeadingZeros = 0;
     for (char const* p = first; p!=last && *p==alphabet[0]; p++)
         nLeadingZeros++;
 
+    if (nLeadingZeros > size)
+        return false;
+
+    std::size_t valueSize;
+    if (!base58ToBytes (first + nLeadingZeros, last, alphabet,
+            out + nLeadingZeros, size - nLeadingZeros, valueSize))
+        return false;
+
     // Verify that the size is correct
-    if (vchTmp.size() + nLeadingZeros != size)
+    if (valueSize + nLeadingZeros != size)
         return false;
 
     // Fill the leading zeros
     memset (out, 0, nLeadingZeros);
 
-    // Copy little endian data to big endian
-    std::reverse_copy (vchTmp.begin (), vchTmp.end (),
-        out + nLeadingZeros);
-
     if (checked)
     {
         char hash4 [4];
@@ -148,59 +286,46 @@ bool Base58::raw_decode (char const* first, char const* last, void* dest,
 
 bool Base58::decode (const char* psz, Blob& vchRet, Alphabet const& alphabet)
 {
-    CAutoBN_CTX pctx;
     vchRet.clear ();
-    CBigNum bn58 = 58;
-    CBigNum bn = 0;
-    CBigNum bnChar;
 
     while (isspace (*psz))
         psz++;
 
-    // Convert big endian string to bignum
-    for (const char* p = psz; *p; p++)
-    {
-        // VFALCO TODO Make this use the inverse table!
-        //             Or better yet ditch this and call raw_decode
-        //
-        const char* p1 = strchr (alphabet.chars(), *p);
-
-        if (p1 == nullptr)
-        {
-            while (isspace (*p))
-                p++;
-
-            if (*p != '\0')
-                return false;
-
-            break;
-        }
-
-        bnChar.setuint (p1 - alphabet.chars());
+    // The digits end at the first character outside the alphabet, which
+    // may only be followed by whitespace
+    char const* end = psz;
 
-        if (!BN_mul (&bn, &bn, &bn58, pctx))
-            throw bignum_error ("DecodeBase58 : BN_mul failed");
+    while ((static_cast <unsigned char> (*end) < 128) && (*end != '\0') &&
+            (alphabet.from_char (*end) != -1))
+        end++;
 
-        bn += bnChar;
+    for (char const* p = end; *p; ++p)
+    {
+        if (!isspace (*p))
+            return false;
     }
 
-    // Get bignum as little endian data
-    Blob vchTmp = bn.getvch ();
-
-    // Trim off sign byte if present
-    if (vchTmp.size () >= 2 && vchTmp.end ()[-1] == 0 && vchTmp.end ()[-2] >= 0x80)
-        vchTmp.erase (vchTmp.end () - 1);
-
     // Restore leading zeros
-    int nLeadingZeros = 0;
+    std::size_t nLeadingZeros = 0;
 
-    for (const char* p = psz; *p == alphabet.chars()[0]; p++)
+    for (const char* p = psz; p != end && *p == alphabet.chars()[0]; p++)
         nLeadingZeros++;
 
-    vchRet.assign (nLeadingZeros + vchTmp.size (), 0);
+    if (end == psz)
+        return true;
 
-    // Convert little endian data to big endian
-    std::reverse_copy (vchTmp.begin (), vchTmp.end (), vchRet.end () - vchTmp.size ());
+    // A value never takes more bytes than it has digits
+    vchRet.resize (end - psz);
+
+    std::size_t valueSize;
+    if (!base58ToBytes (psz + nLeadingZeros, end, alphabet,
+            &vchRet.front () + nLeadingZeros, vchRet.size () - nLeadingZeros, valueSize))
+    {
+        vchRet.clear ();
+        return false;
+    }
+
+    vchRet.resize (nLeadingZeros + valueSize);
     return true;
 }
 
@@ -237,5 +362,229 @@ bool Base58::decodeWithCheck (const std::string& str, Blob& vchRet, Alphabet con
     return decodeWithCheck (str.c_str (), vchRet, alphabet);
 }
 
+//------------------------------------------------------------------------------
+
+// The BIGNUM encoder these replaced, kept to check against
+static std::string base58Reference (Blob const& data, Base58::Alphabet const& alphabet)
+{
+    CAutoBN_CTX pctx;
+    CBigNum bn58 = 58;
+    CBigNum bn0 = 0;
+
+    // Little endian, with a zero pad byte to make the BIGNUM positive
+    Blob le (data.rbegin (), data.rend ());
+    le.push_back (0);
+    CBigNum bn (le);
+
+    std::string str;
+    CBigNum dv;
+    CBigNum rem;
+
+    while (bn > bn0)
+    {
+        if (!BN_div (&dv, &rem, &bn, &bn58, pctx))
+            throw bignum_error ("EncodeBase58 : BN_div failed");
+
+        bn = dv;
+        str += alphabet [rem.getuint ()];
+    }
+
+    for (auto iter = data.begin (); iter != data.end () && *iter == 0; ++iter)
+        str += alphabet [0];
+
+    std::reverse (str.begin (), str.end ());
+    return str;
 }
 
+class Base58_test : public beast::unit_test::suite
+{
+public:
+    static Blob fromHex (std::string const& hex)
+    {
+        Blob data;
+
+        for (std::size_t i = 0; i + 1 < hex.size (); i += 2)
+            data.push_back (static_cast <unsigned char> (
+                (charUnHex (hex[i]) << 4) | charUnHex (hex[i + 1])));
+
+        return data;
+    }
+
+    void testVector (std::string const& hex, std::string const& expected)
+    {
+        Base58::Alphabet const& alphabet (Base58::getBitcoinAlphabet ());
+        Blob const data (fromHex (hex));
+
+        std::string const encoded (Base58::encode (
+            data.begin (), data.end (), alphabet, false));
+        expect (encoded == expected, "encode " + hex + " gave " + encoded);
+
+        Blob decoded;
+        expect (Base58::decode (expected.c_str (), decoded, alphabet) &&
+            decoded == data, "decode " + expected);
+    }
+
+    void testVectors ()
+    {
+        testcase ("vectors");
+
+        testVector ("", "");
+        testVector ("61", "2g");
+        testVector ("626262", "a3gV");
+        testVector ("636363", "aPEr");
+        testVector ("73696d706c792061206c6f6e6720737472696e67",
+            "2cFupjhnEsSn59qHXstmK2ffpLv2");
+        testVector ("00eb15231dfceb60925886b67d065299925915aeb172c06647",
+            "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L");
+        testVector ("516b6fcd0f", "ABnLTmg");
+        testVector ("bf4f89001e670274dd", "3SEo3LWLoPntC");
+        testVector ("572e4794", "3EFU7m");
+        testVector ("ecac89cad93923c02321", "EJDM8drfXA6uyA");
+        testVector ("10c8511e", "Rt5zm");
+        testVector ("00000000000000000000", "1111111111");
+    }
+
+    void testDecode ()
+    {
+        testcase ("decode");
+
+        Base58::Alphabet const& alphabet (Base58::getBitcoinAlphabet ());
+        Blob const bbb (fromHex ("626262"));
+        Blob decoded;
+
+        expect (Base58::decode ("  a3gV  ", decoded, alphabet) &&
+            decoded == bbb, "Whitespace around digits");
+        expect (!Base58::decode ("a3 gV", decoded, alphabet),
+            "Whitespace between digits");
+        expect (!Base58::decode ("a30V", decoded, alphabet),
+            "Character outside the alphabet");
+        expect (!Base58::decode ("a3\xc3\xa9", decoded, alphabet),
+            "High-ASCII character");
+
+        char const* const digits ("1a3gV");
+        unsigned char out [3];
+
+        expect (Base58::raw_decode (digits + 1, digits + 5, out, 3, false, alphabet) &&
+            Blob (out, out + 3) == bbb, "raw_decode");
+        expect (!Base58::raw_decode (digits + 1, digits + 5, out, 2, false, alphabet),
+            "raw_decode into a short buffer");
+        expect (!Base58::raw_decode (digits, digits + 5, out, 3, false, alphabet),
+            "raw_decode with a leading zero too many");
+
+        std::string const token (Base58::encodeWithCheck (Blob (20, 7)));
+        expect (Base58::decodeWithCheck (token, decoded) &&
+            decoded == Blob (20, 7), "Checked round trip");
+
+        std::string corrupt (token);
+        corrupt[5] = (corrupt[5] == 'r') ? 's' : 'r';
+        expect (!Base58::decodeWithCheck (corrupt, decoded), "Corrupt check");
+    }
+
+    void testRandom ()
+    {
+        testcase ("random");
+
+        std::mt19937 r (58);
+        Base58::Alphabet const& alphabet (Base58::getRippleAlphabet ());
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            // Sizes past the stack buffers, and runs of zeros at the front
+            Blob data (r () % 100);
+            std::size_t const zeros = data.empty () ? 0 : r () % data.size ();
+
+            for (std::size_t j = zeros; j < data.size (); ++j)
+                data[j] = static_cast <unsigned char> (r ());
+
+            std::string const encoded (Base58::encode (
+                data.begin (), data.end (), alphabet, false));
+
+            if (! expect (encoded == base58Reference (data, alphabet),
+                    "Mismatch for " + strHex (data.begin (), data.size ())))
+                return;
+
+            Blob decoded;
+            if (! expect (Base58::decode (encoded.c_str (), decoded, alphabet) &&
+                    decoded == data, "Round trip for " + strHex (data.begin (), data.size ())))
+                return;
+        }
+    }
+
+    void run ()
+    {
+        testVectors ();
+        testDecode ();
+        testRandom ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Base58,types,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times encoding against the BIGNUM encoder.
+
+    The payloads are the sizes of account IDs, seeds and public keys with
+    their type byte, and are encoded with a check as tokens are.
+*/
+class Base58Encode_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    template <class Function>
+    double measure (int iterations, Function f)
+    {
+        auto const start = clock_type::now ();
+
+        for (int i = 0; i < iterations; ++i)
+            f (i);
+
+        return std::chrono::duration_cast <std::chrono::nanoseconds> (
+            clock_type::now () - start).count () / double (iterations);
+    }
+
+    void run ()
+    {
+        int const iterations = 100000;
+        Base58::Alphabet const& alphabet (Base58::getRippleAlphabet ());
+        std::mt19937 r (21);
+
+        for (std::size_t size : { 21, 34, 33 })
+        {
+            std::vector <Blob> payloads (256, Blob (size));
+
+            for (auto& payload : payloads)
+            {
+                for (auto& byte : payload)
+                    byte = static_cast <unsigned char> (r ());
+            }
+
+            std::size_t total = 0;
+
+            double const fast = measure (iterations, [&](int i)
+            {
+                Blob const& p (payloads [i & 255]);
+                total += Base58::encode (p.begin (), p.end (), alphabet, true).size ();
+            });
+
+            double const reference = measure (iterations, [&](int i)
+            {
+                Blob p (payloads [i & 255]);
+                char hash [4];
+                Base58::fourbyte_hash256 (hash, &p.front (), p.size ());
+                p.insert (p.end (), hash, hash + 4);
+                total += base58Reference (p, alphabet).size ();
+            });
+
+            log << size << " bytes: " << fast << "ns per call, BIGNUM " <<
+                reference << "ns (" << (reference / fast) << "x)";
+
+            expect (total != 0);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Base58Encode,types,ripple);
+
+}
@@ -17,6 +17,13 @@
 */
 //==============================================================================
 
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <set>
+
 namespace ripple {
 
 // NIKB TODO having a dependency on HashMaps sucks. Try to remove it and combine
@@ -43,5 +50,132 @@ std::size_t hash_value (uint256 const& u)
     return beast::hardened_hash<uint256>{seed}(u);
 }
 
+//------------------------------------------------------------------------------
+
+class uniform_hasher_test : public beast::unit_test::suite
+{
+public:
+    static uint256 makeKey (std::mt19937_64& r)
+    {
+        std::uint64_t w [4] = { r (), r (), r (), r () };
+
+        uint256 key;
+        memcpy (key.begin (), w, sizeof (w));
+        return key;
+    }
+
+    void run ()
+    {
+        std::mt19937_64 r (256);
+        uint256::uniform_hasher const hasher;
+
+        uint256 const key (makeKey (r));
+        uint256 copy (key);
+        expect (hasher (key) == hasher (copy), "Equal keys hash differently");
+
+        // Every word of the key takes part, so keys that differ only in
+        // their first or their last 128 bits hash differently
+        for (std::size_t offset : { std::size_t (0), std::size_t (16) })
+        {
+            std::set <std::size_t> hashes;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                uint256 changed (key);
+                std::uint64_t w [2] = { r (), r () };
+                memcpy (changed.begin () + offset, w, sizeof (w));
+                hashes.insert (hasher (changed));
+            }
+
+            expect (hashes.size () == 1000, offset == 0 ?
+                "Hash ignores the first 128 bits" :
+                "Hash ignores the last 128 bits");
+        }
+
+        // The seed differs between hashers
+        uint256::uniform_hasher const other;
+        expect (hasher (key) != other (key), "Hashers share a seed");
+
+        // SHA-512 half outputs should spread evenly over the buckets
+        std::size_t const buckets = 1021;
+        std::vector <int> counts (buckets);
+
+        for (int i = 0; i < 100000; ++i)
+            ++counts [hasher (makeKey (r)) % buckets];
+
+        int const most (*std::max_element (counts.begin (), counts.end ()));
+        expect (most < 2 * 100000 / int (buckets), "Uneven spread");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(uniform_hasher,types,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times lookups in a map of uint256 keys with each hash function.
 
-}
\ No newline at end of file
+    Half the lookups find their key and half miss, as in the node and
+    transaction caches. The map holds a million keys, or as many as
+    UNIFORM_HASHER_BENCH_KEYS says.
+*/
+class uniform_hasher_timing_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    template <class Hash>
+    void measure (std::string const& name, std::vector <uint256> const& keys,
+        std::vector <uint256> const& misses)
+    {
+        std::unordered_map <uint256, int, Hash> map;
+        map.reserve (keys.size ());
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+            map.emplace (keys[i], int (i));
+
+        std::size_t found = 0;
+        auto const start = clock_type::now ();
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            found += map.count (keys[i]);
+            found += map.count (misses[i]);
+        }
+
+        auto const elapsed = std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start);
+
+        expect (found == keys.size (), name + " lookups went wrong");
+
+        log << name << ": " << (2.0 * keys.size () * 1e3 / elapsed.count ()) <<
+            "M lookups/s";
+    }
+
+    void run ()
+    {
+        std::size_t size = 1000000;
+
+        if (char const* env = std::getenv ("UNIFORM_HASHER_BENCH_KEYS"))
+            size = std::max (1, std::atoi (env));
+
+        std::mt19937_64 r (256);
+        std::vector <uint256> keys;
+        std::vector <uint256> misses;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            keys.push_back (uniform_hasher_test::makeKey (r));
+            misses.push_back (uniform_hasher_test::makeKey (r));
+        }
+
+        std::shuffle (misses.begin (), misses.end (), r);
+
+        measure <beast::hardened_hash <uint256>> ("hardened_hash", keys, misses);
+        measure <beast::uhash <>> ("uhash", keys, misses);
+        measure <uint256::uniform_hasher> ("uniform_hasher", keys, misses);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(uniform_hasher_timing,types,ripple);
+
+}
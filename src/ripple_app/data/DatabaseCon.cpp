@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include <boost/algorithm/string.hpp>
+
 namespace ripple {
 
 
@@ -33,33 +35,196 @@ void DatabaseCon::connectHelper(const std::string& strName)
                                       ? ""                                // Use temporary files.
                                       : (getConfig ().DATA_DIR / strName);       // Use regular db files.
 
-    mDatabase = new SqliteDatabase (pPath.string ().c_str ());
+    connect (pPath, getConfig ().DATABASE_READERS);
+}
+
+void DatabaseCon::connect (boost::filesystem::path const& path, int readers)
+{
+    mPath = path.string ();
+
+    // Each connection to a temporary database sees its own private file
+    mMaxReaders = mPath.empty () ? 0 : std::max (0, readers);
+    mOpenReaders = 0;
+    mBusyReaders = 0;
+    mMaxBusyReaders = 0;
+    mBorrows = 0;
+    mWaits = 0;
+    mWaitTime = std::chrono::microseconds::zero ();
+
+    mDatabase = new SqliteDatabase (mPath.c_str ());
     mDatabase->connect ();
 }
 
-DatabaseCon::DatabaseCon (const std::string& strName, const char* initStrings[], int initCount)
+void DatabaseCon::init (const std::vector<const char *> &init)
 {
-    connectHelper(strName);
-    for (int i = 0; i < initCount; ++i) {
-        bool res = mDatabase->executeSQL (initStrings[i], false);
+    for(const char * const &statement: init) {
+        bool res = mDatabase->executeSQL (statement, false);
         assert(res);
+
+        // Readers need the same settings, the schema they share
+        if (boost::algorithm::istarts_with (
+                boost::algorithm::trim_left_copy (std::string (statement)), "PRAGMA"))
+            mPragmas.push_back (statement);
+    }
+}
+
+void DatabaseCon::setPragma (std::string const& pragma)
+{
+    {
+        DeprecatedScopedLock sl (mLock);
+        mDatabase->executeSQL (pragma, false);
     }
+
+    std::lock_guard <std::mutex> lock (mReaderMutex);
+    mPragmas.push_back (pragma);
+
+    for (Database* db : mIdleReaders)
+        updateReader (db);
+}
+
+void DatabaseCon::updateReader (Database* db)
+{
+    std::size_t& applied = mReaderPragmas[db];
+
+    for (; applied < mPragmas.size (); ++applied)
+        db->executeSQL (mPragmas[applied], true);
+}
+
+DatabaseCon::DatabaseCon (const std::string& strName, const char* initStrings[], int initCount)
+{
+    connectHelper(strName);
+    init (std::vector<const char *> (initStrings, initStrings + initCount));
 }
 
 DatabaseCon::DatabaseCon (const std::string& strName, const std::vector<const char *> &init)
 {
     connectHelper(strName);
+    this->init (init);
+}
 
-    for(const char * const &statement: init) {
-        bool res = mDatabase->executeSQL (statement, false);
-        assert(res);
-    }
+DatabaseCon::DatabaseCon (boost::filesystem::path const& path, int readers,
+                          const std::vector<const char *> &init)
+{
+    connect (path, readers);
+    this->init (init);
 }
 
 DatabaseCon::~DatabaseCon ()
 {
+    for (Database* db : mIdleReaders)
+    {
+        db->disconnect ();
+        delete db;
+    }
+
+    assert (mBusyReaders == 0);
+
     mDatabase->disconnect ();
     delete mDatabase;
 }
 
+Database* DatabaseCon::acquireReader ()
+{
+    std::unique_lock <std::mutex> lock (mReaderMutex);
+
+    ++mBorrows;
+
+    if (mIdleReaders.empty () && (mOpenReaders >= mMaxReaders))
+    {
+        auto const start = std::chrono::steady_clock::now ();
+
+        ++mWaits;
+        mReaderCond.wait (lock, [this] { return !mIdleReaders.empty (); });
+
+        mWaitTime += std::chrono::duration_cast <std::chrono::microseconds> (
+            std::chrono::steady_clock::now () - start);
+    }
+
+    Database* db = nullptr;
+
+    if (!mIdleReaders.empty ())
+    {
+        db = mIdleReaders.back ();
+        mIdleReaders.pop_back ();
+    }
+    else
+    {
+        // Open outside the lock, but count it now so that the pool
+        // never grows past its limit
+        ++mOpenReaders;
+        lock.unlock ();
+
+        std::unique_ptr <SqliteDatabase> reader (
+            new SqliteDatabase (mPath.c_str ()));
+        reader->connect ();
+
+        // A reader must never write, even through a bug in a caller
+        reader->executeSQL ("PRAGMA query_only=1;", true);
+
+        db = reader.release ();
+        lock.lock ();
+    }
+
+    updateReader (db);
+
+    mMaxBusyReaders = std::max (mMaxBusyReaders, ++mBusyReaders);
+    return db;
+}
+
+void DatabaseCon::releaseReader (Database* db)
+{
+    {
+        std::lock_guard <std::mutex> lock (mReaderMutex);
+        --mBusyReaders;
+        mIdleReaders.push_back (db);
+    }
+
+    mReaderCond.notify_one ();
+}
+
+Json::Value DatabaseCon::getJson ()
+{
+    std::lock_guard <std::mutex> lock (mReaderMutex);
+
+    Json::Value ret (Json::objectValue);
+
+    ret["max"] = mMaxReaders;
+    ret["open"] = mOpenReaders;
+    ret["busy"] = mBusyReaders;
+    ret["max_busy"] = mMaxBusyReaders;
+    ret["borrows"] = static_cast <double> (mBorrows);
+    ret["waits"] = static_cast <double> (mWaits);
+
+    if (mWaits != 0)
+        ret["avg_wait_us"] = static_cast <double> (mWaitTime.count ()) / mWaits;
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+
+DatabaseCon::Reader::Reader (DatabaseCon& con)
+    : mCon (con)
+    , mDatabase (nullptr)
+{
+    if (con.mMaxReaders == 0)
+    {
+        mLock = std::unique_lock <DeprecatedRecursiveMutex> (con.mLock);
+        mDatabase = con.mDatabase;
+    }
+    else
+    {
+        mDatabase = con.acquireReader ();
+    }
+}
+
+DatabaseCon::Reader::~Reader ()
+{
+    // Leave no statement open on a connection someone else will use
+    mDatabase->endIterRows ();
+
+    if (!mLock.owns_lock ())
+        mCon.releaseReader (mDatabase);
+}
+
 } // ripple
@@ -22,6 +22,12 @@
 #include "ripple_app/data/Database.h"
 #include "ripple_basics/types/BasicTypes.h"
 
+#include <boost/filesystem/path.hpp>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 namespace ripple {
 
 // VFALCO NOTE This looks like a pointless class. Figure out
@@ -30,9 +36,41 @@ class DatabaseCon : beast::LeakChecked <DatabaseCon>
 {
     void connectHelper(const std::string& name);
 public:
+    /** A connection borrowed for read-only queries.
+
+        Readers come from a small pool of query-only connections to the
+        same file, so RPC lookups neither wait for nor block the writer.
+        The connection goes back to the pool when the Reader is destroyed.
+        Temporary databases and a pool size of zero fall back to the
+        writer connection under the database lock.
+    */
+    class Reader
+    {
+    public:
+        explicit Reader (DatabaseCon& con);
+        ~Reader ();
+
+        Reader (Reader const&) = delete;
+        Reader& operator= (Reader const&) = delete;
+
+        Database* getDB () const
+        {
+            return mDatabase;
+        }
+
+    private:
+        DatabaseCon& mCon;
+        Database* mDatabase;
+        std::unique_lock <DeprecatedRecursiveMutex> mLock;
+    };
+
     DatabaseCon (const std::string& name, const char* initString[], int countInit);
     DatabaseCon (const std::string& name, const std::vector<const char *> &init);
 
+    // Opens the file at `path` with up to `readers` reader connections
+    DatabaseCon (boost::filesystem::path const& path, int readers,
+                 const std::vector<const char *> &init);
+
     ~DatabaseCon ();
 
     Database* getDB ()
@@ -44,10 +82,42 @@ public:
         return mLock;
     }
 
+    /** Runs a PRAGMA on the writer and on every reader.
+        Readers opened later, or idle now, run it before their next use.
+    */
+    void setPragma (std::string const& pragma);
+
+    /** Returns statistics about the reader pool. */
+    Json::Value getJson ();
+
     // VFALCO TODO change "protected" to "private" throughout the code
 private:
+    void connect (boost::filesystem::path const& path, int readers);
+    void init (const std::vector<const char *> &init);
+
+    Database* acquireReader ();
+    void releaseReader (Database* db);
+
+    // Runs the PRAGMAs a reader has not seen yet. Called with mReaderMutex.
+    void updateReader (Database* db);
+
     Database*               mDatabase;
     DeprecatedRecursiveMutex  mLock;
+
+    std::string mPath;
+    int mMaxReaders;
+
+    std::mutex mReaderMutex;
+    std::condition_variable mReaderCond;
+    std::vector <Database*> mIdleReaders;
+    std::vector <std::string> mPragmas;                 // Per connection settings
+    std::map <Database*, std::size_t> mReaderPragmas;   // How many each has run
+    int mOpenReaders;
+    int mBusyReaders;
+    int mMaxBusyReaders;
+    std::uint64_t mBorrows;
+    std::uint64_t mWaits;
+    std::chrono::microseconds mWaitTime;
 };
 
 } // ripple
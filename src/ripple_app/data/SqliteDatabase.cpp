@@ -112,8 +112,21 @@ sqlite3* SqliteDatabase::getAuxConnection ()
     return mAuxConnection;
 }
 
+SqliteStatement& SqliteDatabase::getStatement (std::string const& sql)
+{
+    std::unique_ptr <SqliteStatement>& statement = mStatements[sql];
+
+    if (!statement)
+        statement.reset (new SqliteStatement (this, sql));
+
+    return *statement;
+}
+
 void SqliteDatabase::disconnect ()
 {
+    // Cached statements must go before their connection
+    mStatements.clear ();
+
     sqlite3_finalize (mCurrentStmt);
     sqlite3_close (mConnection);
 
@@ -25,6 +25,8 @@
 
 namespace ripple {
 
+class SqliteStatement;
+
 class SqliteDatabase
     : public Database
     , private beast::Thread
@@ -65,6 +67,12 @@ public:
     {
         return mConnection;
     }
+
+    /** Returns a statement for `sql`, prepared on this connection the first
+        time it is asked for and kept until disconnect. The caller must hold
+        the database lock and reset the statement when done with it.
+    */
+    SqliteStatement& getStatement (std::string const& sql);
     sqlite3*    getAuxConnection ();
     virtual bool setupCheckpointing (JobQueue*);
     virtual SqliteDatabase* getSqliteDB ()
@@ -91,6 +99,8 @@ private:
     sqlite3_stmt* mCurrentStmt;
     bool mMoreRows;
 
+    std::map <std::string, std::unique_ptr <SqliteStatement>> mStatements;
+
     JobQueue*               mWalQ;
     bool                    walRunning;
 };
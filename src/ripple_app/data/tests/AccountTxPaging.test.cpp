@@ -0,0 +1,366 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include "../../../beast/beast/unit_test/suite.h"
+#include "../../../ripple/common/jsonrpc_fields.h"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdlib>
+
+namespace ripple {
+
+/** A temporary transaction database with one account's history.
+    Rows are numbered from 0, perLedger of them to a ledger starting at
+    ledger 1, so row i is at (1 + i / perLedger, i % perLedger).
+*/
+class AccountTxDatabase : public beast::unit_test::suite
+{
+public:
+    typedef std::pair <std::uint32_t, std::uint32_t> Position;
+
+    static int const perLedger = 4;
+
+    sqlite3* db_;
+    boost::filesystem::path path_;
+
+    AccountTxDatabase ()
+        : db_ (nullptr)
+    {
+    }
+
+    static RippleAddress account ()
+    {
+        return RippleAddress::createAccountPublic (
+            RippleAddress::createSeedGeneric ("masterpassphrase"));
+    }
+
+    bool open ()
+    {
+        path_ = boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ("account-tx-%%%%-%%%%.db");
+
+        if (sqlite3_open (path_.string ().c_str (), &db_) != SQLITE_OK)
+        {
+            fail ("Can't create " + path_.string ());
+            return false;
+        }
+
+        return true;
+    }
+
+    void close ()
+    {
+        sqlite3_close (db_);
+        db_ = nullptr;
+        boost::filesystem::remove (path_);
+    }
+
+    void exec (std::string const& sql)
+    {
+        char* error = nullptr;
+
+        if (sqlite3_exec (db_, sql.c_str (), nullptr, nullptr, &error) != SQLITE_OK)
+        {
+            fail (error ? error : sql);
+            sqlite3_free (error);
+        }
+    }
+
+    void populate (std::uint64_t rows)
+    {
+        std::string const account (AccountTxDatabase::account ().humanAccountID ());
+
+        exec ("PRAGMA synchronous=OFF;");
+        exec ("PRAGMA journal_mode=OFF;");
+
+        // As in TxnDBInit, with only the columns and index account_tx uses
+        exec ("CREATE TABLE Transactions ("
+              "TransID CHARACTER(64) PRIMARY KEY, Status CHARACTER(1), "
+              "RawTxn BLOB, TxnMeta BLOB);");
+        exec ("CREATE TABLE AccountTransactions ("
+              "TransID CHARACTER(64), Account CHARACTER(64), "
+              "LedgerSeq BIGINT UNSIGNED, TxnSeq INTEGER);");
+        exec ("CREATE INDEX AcctTxIndex ON "
+              "AccountTransactions(Account, LedgerSeq, TxnSeq, TransID);");
+
+        sqlite3_stmt* txn = nullptr;
+        sqlite3_prepare_v2 (db_, "INSERT INTO Transactions "
+            "(TransID, Status, RawTxn, TxnMeta) VALUES (?, 'V', x'00', x'00');",
+                -1, &txn, nullptr);
+
+        sqlite3_stmt* acct = nullptr;
+        sqlite3_prepare_v2 (db_, "INSERT INTO AccountTransactions "
+            "(TransID, Account, LedgerSeq, TxnSeq) VALUES (?, ?, ?, ?);",
+                -1, &acct, nullptr);
+
+        exec ("BEGIN TRANSACTION;");
+
+        for (std::uint64_t i = 0; i < rows; ++i)
+        {
+            uint256 id;
+            std::memcpy (id.begin (), &i, sizeof (i));
+            std::string const txID (to_string (id));
+
+            sqlite3_bind_text (txn, 1, txID.c_str (), -1, SQLITE_TRANSIENT);
+            sqlite3_step (txn);
+            sqlite3_reset (txn);
+
+            sqlite3_bind_text (acct, 1, txID.c_str (), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text (acct, 2, account.c_str (), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64 (acct, 3, 1 + (i / perLedger));
+            sqlite3_bind_int (acct, 4, static_cast <int> (i % perLedger));
+            sqlite3_step (acct);
+            sqlite3_reset (acct);
+        }
+
+        exec ("END TRANSACTION;");
+        sqlite3_finalize (txn);
+        sqlite3_finalize (acct);
+    }
+
+    // The positions of the rows a query returns, the first two columns
+    std::vector <Position> positions (std::string const& sql)
+    {
+        std::vector <Position> ret;
+        sqlite3_stmt* stmt = nullptr;
+
+        if (sqlite3_prepare_v2 (db_, sql.c_str (), -1, &stmt, nullptr) != SQLITE_OK)
+        {
+            fail (sqlite3_errmsg (db_));
+            return ret;
+        }
+
+        while (sqlite3_step (stmt) == SQLITE_ROW)
+            ret.emplace_back (
+                static_cast <std::uint32_t> (sqlite3_column_int64 (stmt, 0)),
+                static_cast <std::uint32_t> (sqlite3_column_int (stmt, 1)));
+
+        sqlite3_finalize (stmt);
+        return ret;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Checks that account_tx pages seeked to by marker fit together. */
+class AccountTxMarker_test : public AccountTxDatabase
+{
+public:
+    static std::uint64_t const rows = 50;
+
+    // Pages through the account as getTxsAccount does, with one row more
+    // than the page size to find the next page's marker
+    std::vector <Position> walk (bool forward, std::uint32_t pageSize,
+        std::uint64_t& markers)
+    {
+        std::uint32_t const maxLedger = 1 + rows / perLedger;
+        std::vector <Position> ret;
+        Json::Value marker;
+        markers = 0;
+
+        do
+        {
+            std::uint32_t findLedger = 0, findSeq = 0;
+
+            if (! marker.isNull ())
+                expect (parseAccountTxMarker (marker, findLedger, findSeq));
+
+            std::vector <Position> const page (positions (accountTxPageSQL (
+                account (), 0, maxLedger, forward, findLedger, findSeq,
+                    pageSize + 1)));
+
+            marker = Json::nullValue;
+
+            for (std::size_t i = 0; i < page.size (); ++i)
+            {
+                if (i == pageSize)
+                {
+                    marker = Json::objectValue;
+                    marker[jss::ledger] = static_cast <int> (page[i].first);
+                    marker[jss::seq] = static_cast <int> (page[i].second);
+                    break;
+                }
+
+                ret.push_back (page[i]);
+            }
+        }
+        while (! marker.isNull () && (++markers < rows));
+
+        return ret;
+    }
+
+    void testContinuity (bool forward)
+    {
+        testcase (forward ? "forward pages" : "backward pages");
+
+        std::vector <Position> all;
+
+        for (std::uint64_t i = 0; i < rows; ++i)
+            all.emplace_back (1 + i / perLedger, i % perLedger);
+
+        if (! forward)
+            std::reverse (all.begin (), all.end ());
+
+        // Page sizes that do and don't line up with the ledgers
+        for (std::uint32_t pageSize : { 1, 3, 4, 7, 50, 51 })
+        {
+            std::uint64_t markers;
+            std::vector <Position> const got (walk (forward, pageSize, markers));
+
+            expect (got == all, "Pages should continue where the last stopped");
+            expect (markers == (rows - 1) / pageSize,
+                "Every page but the last should return a marker");
+        }
+    }
+
+    void testParse ()
+    {
+        testcase ("marker");
+
+        std::uint32_t findLedger = 0, findSeq = 0;
+
+        Json::Value marker (Json::objectValue);
+        marker[jss::ledger] = 12;
+        marker[jss::seq] = 3;
+        expect (parseAccountTxMarker (marker, findLedger, findSeq));
+        expect (findLedger == 12 && findSeq == 3);
+
+        marker[jss::seq] = 3u;
+        expect (parseAccountTxMarker (marker, findLedger, findSeq));
+
+        marker[jss::seq] = -1;
+        expect (! parseAccountTxMarker (marker, findLedger, findSeq),
+            "negative seq");
+
+        marker[jss::seq] = "3";
+        expect (! parseAccountTxMarker (marker, findLedger, findSeq),
+            "string seq");
+
+        marker[jss::seq] = true;
+        expect (! parseAccountTxMarker (marker, findLedger, findSeq),
+            "boolean seq");
+
+        marker.removeMember (jss::seq);
+        expect (! parseAccountTxMarker (marker, findLedger, findSeq),
+            "missing seq");
+
+        marker[jss::seq] = 3;
+        marker[jss::ledger] = 0;
+        expect (! parseAccountTxMarker (marker, findLedger, findSeq),
+            "ledger zero");
+
+        expect (! parseAccountTxMarker (
+            Json::Value ("12:3"), findLedger, findSeq), "string marker");
+        expect (! parseAccountTxMarker (
+            Json::Value (Json::arrayValue), findLedger, findSeq), "array marker");
+    }
+
+    void run ()
+    {
+        testParse ();
+
+        if (! open ())
+            return;
+
+        populate (rows);
+        testContinuity (true);
+        testContinuity (false);
+        close ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountTxMarker,ripple_app,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times paging through a busy account's history.
+
+    Builds a temporary database holding one account with many transactions,
+    by default 10 million (set ACCOUNT_TX_BENCH_ROWS to change it), four to
+    a ledger. It then fetches a 200-row page at increasing depths, once
+    with the LIMIT/OFFSET query account_tx_old used, and once with the
+    query both account_tx handlers use now, which seeks to a marker.
+*/
+class AccountTxPaging_test : public AccountTxDatabase
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    static int const pageSize = 200;
+
+    // Runs a query, returning the time it took and the rows it found
+    std::chrono::microseconds query (std::string const& sql,
+        std::vector <Position>& rows)
+    {
+        auto const start = clock_type::now ();
+        rows = positions (sql);
+        return std::chrono::duration_cast <std::chrono::microseconds> (
+            clock_type::now () - start);
+    }
+
+    void run ()
+    {
+        std::uint64_t rows = 10000000;
+
+        if (char const* env = std::getenv ("ACCOUNT_TX_BENCH_ROWS"))
+            rows = std::max (std::uint64_t (pageSize * 2),
+                beast::lexicalCastThrow <std::uint64_t> (std::string (env)));
+
+        if (! open ())
+            return;
+
+        std::uint32_t const maxLedger = 1 + rows / perLedger;
+
+        auto const start = clock_type::now ();
+        populate (rows);
+        log << rows << " rows in " << std::chrono::duration_cast <
+            std::chrono::seconds> (clock_type::now () - start).count () << "s";
+
+        for (std::uint64_t depth = 1000; depth < rows; depth *= 10)
+        {
+            std::vector <Position> offsetRows, markerRows;
+
+            auto const byOffset = query (getApp().getOPs ().transactionsSQL (
+                "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq",
+                    account (), 0, maxLedger, false, depth, pageSize,
+                        false, false, true), offsetRows);
+
+            // The marker is the first row of the page
+            auto const byMarker = query (accountTxPageSQL (account (), 0,
+                maxLedger, true, 1 + depth / perLedger, depth % perLedger,
+                    pageSize), markerRows);
+
+            expect (offsetRows == markerRows,
+                "Both ways should find the same page");
+
+            log << "depth " << depth <<
+                ": offset " << byOffset.count () << "us" <<
+                ", marker " << byMarker.count () << "us";
+        }
+
+        close ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(AccountTxPaging,ripple_app,ripple);
+
+} // ripple
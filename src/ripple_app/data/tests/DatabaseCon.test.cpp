@@ -0,0 +1,202 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace ripple {
+
+class DatabaseCon_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    static std::vector <char const*> schema ()
+    {
+        return {
+            "PRAGMA journal_mode=WAL;",
+            "PRAGMA cache_size=-1234;",
+            "CREATE TABLE IF NOT EXISTS Things (Id INTEGER);"
+        };
+    }
+
+    static int cacheSize (Database* db)
+    {
+        int ret = 0;
+
+        if (SQL_EXISTS (db, "PRAGMA cache_size;"))
+            ret = db->getInt (0);
+
+        db->endIterRows ();
+        return ret;
+    }
+
+    // Is the lock held, by someone other than the calling thread
+    static bool isLocked (DeprecatedRecursiveMutex& mutex)
+    {
+        bool locked = true;
+
+        std::thread ([&]
+        {
+            if (mutex.try_lock ())
+            {
+                locked = false;
+                mutex.unlock ();
+            }
+        }).join ();
+
+        return locked;
+    }
+
+    // Waits up to a second for a condition another thread will make true
+    template <class Condition>
+    static bool eventually (Condition condition)
+    {
+        auto const end = clock_type::now () + std::chrono::seconds (1);
+
+        while (! condition ())
+        {
+            if (clock_type::now () > end)
+                return false;
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+
+        return true;
+    }
+
+    void testFallback (boost::filesystem::path const& path)
+    {
+        testcase ("fallback");
+
+        // Without readers, queries share the writer under its lock
+        {
+            DatabaseCon con (path, 0, schema ());
+            {
+                DatabaseCon::Reader reader (con);
+                expect (reader.getDB () == con.getDB ());
+                expect (isLocked (con.getDBLock ()), "writer not locked");
+            }
+            expect (! isLocked (con.getDBLock ()), "writer still locked");
+            expect (con.getJson ()["open"].asInt () == 0);
+        }
+
+        // A temporary database is private to its connection
+        {
+            DatabaseCon con ("", 4, schema ());
+            DatabaseCon::Reader reader (con);
+            expect (reader.getDB () == con.getDB ());
+            expect (con.getJson ()["max"].asInt () == 0);
+        }
+    }
+
+    void testBound (boost::filesystem::path const& path)
+    {
+        testcase ("bound");
+
+        DatabaseCon con (path, 2, schema ());
+        std::unique_ptr <DatabaseCon::Reader> first (new DatabaseCon::Reader (con));
+        DatabaseCon::Reader second (con);
+
+        expect (first->getDB () != con.getDB ());
+        expect (second.getDB () != con.getDB ());
+        expect (first->getDB () != second.getDB ());
+        expect (! isLocked (con.getDBLock ()), "reader took the writer lock");
+
+        // A third reader waits for one of the others
+        Database* const firstDB = first->getDB ();
+        std::atomic <Database*> third (nullptr);
+
+        std::thread waiter ([&]
+        {
+            DatabaseCon::Reader reader (con);
+            third = reader.getDB ();
+        });
+
+        expect (eventually ([&] { return con.getJson ()["waits"].asInt () == 1; }),
+            "third reader did not wait");
+        expect (third == nullptr, "third reader got a connection");
+
+        first.reset ();
+        waiter.join ();
+
+        expect (third == firstDB, "third reader should reuse the first's");
+
+        Json::Value const stats (con.getJson ());
+        expect (stats["open"].asInt () == 2);
+        expect (stats["max_busy"].asInt () == 2);
+        expect (stats["borrows"].asInt () == 3);
+    }
+
+    void testPragmas (boost::filesystem::path const& path)
+    {
+        testcase ("pragmas");
+
+        DatabaseCon con (path, 2, schema ());
+        std::unique_ptr <DatabaseCon::Reader> busy (new DatabaseCon::Reader (con));
+        expect (cacheSize (busy->getDB ()) == -1234, "init PRAGMA missing");
+
+        {
+            DatabaseCon::Reader idle (con);
+            expect (cacheSize (idle.getDB ()) == -1234, "init PRAGMA missing");
+        }
+
+        con.setPragma ("PRAGMA cache_size=-2345;");
+        expect (cacheSize (con.getDB ()) == -2345);
+
+        Database* const busyDB = busy->getDB ();
+        busy.reset ();
+
+        // Both readers now, the idle one and the one that was busy
+        DatabaseCon::Reader a (con);
+        DatabaseCon::Reader b (con);
+        expect ((a.getDB () == busyDB) || (b.getDB () == busyDB));
+        expect (cacheSize (a.getDB ()) == -2345, "setPragma missed a reader");
+        expect (cacheSize (b.getDB ()) == -2345, "setPragma missed a reader");
+
+        // And readers stay read only
+        expect (! a.getDB ()->executeSQL ("INSERT INTO Things VALUES (1);", true));
+    }
+
+    void run ()
+    {
+        boost::filesystem::path const path =
+            boost::filesystem::temp_directory_path () /
+                boost::filesystem::unique_path ("db-con-%%%%-%%%%.db");
+
+        testFallback (path);
+        testBound (path);
+        testPragmas (path);
+
+        boost::system::error_code ec;
+        boost::filesystem::remove (path, ec);
+        boost::filesystem::remove (path.string () + "-wal", ec);
+        boost::filesystem::remove (path.string () + "-shm", ec);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DatabaseCon,ripple_app,ripple);
+
+} // ripple
@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace ripple {
+
+/** Times account_tx style queries while ledgers are being saved.
+
+    A writer saves a ledger's worth of AccountTransactions rows in one
+    transaction, as fast as it can, while a number of clients (16, or
+    DATABASE_READERS_BENCH_CLIENTS) each fetch 200-row pages of a random
+    account's history. This runs once with every query sharing the writer
+    connection and its lock, which is what the server did before, and once
+    with a pool of reader connections.
+*/
+class DatabaseReaders_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    static int const accounts = 100;
+    static int const perLedger = 200;
+    static int const pageSize = 200;
+
+    static std::vector <char const*> schema ()
+    {
+        // As in TxnDBInit, with only the index account_tx uses
+        return {
+            "PRAGMA synchronous=NORMAL;",
+            "PRAGMA journal_mode=WAL;",
+            "CREATE TABLE IF NOT EXISTS AccountTransactions ("
+            "TransID CHARACTER(64), Account CHARACTER(64), "
+            "LedgerSeq BIGINT UNSIGNED, TxnSeq INTEGER);",
+            "CREATE INDEX IF NOT EXISTS AcctTxIndex ON "
+            "AccountTransactions(Account, LedgerSeq, TxnSeq, TransID);"
+        };
+    }
+
+    static std::string accountName (int i)
+    {
+        return "account" + std::to_string (i);
+    }
+
+    // Saves one ledger the way Ledger::saveValidatedLedger does
+    bool saveLedger (DatabaseCon& con, std::uint32_t seq)
+    {
+        DeprecatedScopedLock sl (con.getDBLock ());
+        Database* db = con.getDB ();
+
+        if (!db->executeSQL ("BEGIN TRANSACTION;"))
+            return false;
+
+        SqliteStatement& insert = db->getSqliteDB ()->getStatement (
+            "INSERT INTO AccountTransactions "
+            "(TransID, Account, LedgerSeq, TxnSeq) VALUES (?, ?, ?, ?);");
+
+        for (std::uint32_t i = 0; i < perLedger; ++i)
+        {
+            uint256 id;
+            std::uint64_t const n = (std::uint64_t (seq) << 32) | i;
+            std::memcpy (id.begin (), &n, sizeof (n));
+
+            insert.bind (1, to_string (id));
+            insert.bind (2, accountName ((seq + i) % accounts));
+            insert.bind (3, seq);
+            insert.bind (4, i);
+            insert.step ();
+            insert.reset ();
+        }
+
+        return db->executeSQL ("COMMIT TRANSACTION;");
+    }
+
+    void measure (boost::filesystem::path const& path, int readers,
+        int clients, std::chrono::seconds duration)
+    {
+        DatabaseCon con (path, readers, schema ());
+
+        std::atomic <bool> stop (false);
+        std::atomic <std::uint32_t> seq (1);
+
+        // Some history to page through before the clock starts
+        while (seq < 100)
+            saveLedger (con, seq++);
+
+        std::vector <std::vector <std::chrono::microseconds>> samples (clients);
+        std::vector <std::thread> threads;
+
+        for (int c = 0; c < clients; ++c)
+        {
+            threads.emplace_back ([&, c]
+            {
+                beast::Random random (c);
+
+                while (!stop)
+                {
+                    std::string const sql (
+                        "SELECT LedgerSeq, TxnSeq, TransID FROM AccountTransactions "
+                        "WHERE Account = '" + accountName (random.nextInt (accounts)) +
+                        "' ORDER BY LedgerSeq DESC, TxnSeq DESC LIMIT " +
+                        std::to_string (pageSize) + ";");
+
+                    auto const start = clock_type::now ();
+                    {
+                        DatabaseCon::Reader reader (con);
+                        Database* db = reader.getDB ();
+                        std::string id;
+
+                        SQL_FOREACH (db, sql)
+                        {
+                            db->getStr ("TransID", id);
+                        }
+                    }
+                    samples[c].push_back (std::chrono::duration_cast <
+                        std::chrono::microseconds> (clock_type::now () - start));
+                }
+            });
+        }
+
+        std::uint32_t const firstSeq = seq;
+        auto const start = clock_type::now ();
+
+        while (clock_type::now () - start < duration)
+            expect (saveLedger (con, seq++), "Ledger save failed");
+
+        stop = true;
+
+        for (auto& t : threads)
+            t.join ();
+
+        std::vector <std::chrono::microseconds> all;
+        for (auto const& s : samples)
+            all.insert (all.end (), s.begin (), s.end ());
+
+        std::sort (all.begin (), all.end ());
+
+        if (all.empty ())
+        {
+            fail ("No queries ran");
+            return;
+        }
+
+        log << (readers == 0 ? "shared writer" : std::to_string (readers) + " readers") <<
+            ": " << all.size () / duration.count () << " queries/s" <<
+            ", p50 " << all[all.size () / 2].count () << "us" <<
+            ", p99 " << all[all.size () * 99 / 100].count () << "us" <<
+            ", " << (seq - firstSeq) / duration.count () << " ledgers/s";
+    }
+
+    void run ()
+    {
+        int clients = 16;
+
+        if (char const* env = std::getenv ("DATABASE_READERS_BENCH_CLIENTS"))
+            clients = std::max (1, beast::lexicalCastThrow <int> (std::string (env)));
+
+        for (int readers : { 0, 4 })
+        {
+            boost::filesystem::path const path =
+                boost::filesystem::temp_directory_path () /
+                    boost::filesystem::unique_path ("db-readers-%%%%-%%%%.db");
+
+            measure (path, readers, clients, std::chrono::seconds (10));
+
+            boost::system::error_code ec;
+            boost::filesystem::remove (path, ec);
+            boost::filesystem::remove (path.string () + "-wal", ec);
+            boost::filesystem::remove (path.string () + "-shm", ec);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(DatabaseReaders,ripple_app,ripple);
+
+} // ripple
@@ -22,7 +22,7 @@ namespace ripple {
 // VFALCO TODO Remove this global and make it a member of the App
 //             Use a dependency injection to give AcceptedLedger access.
 //
-TaggedCache <uint256, AcceptedLedger> AcceptedLedger::s_cache (
+AcceptedLedger::Cache AcceptedLedger::s_cache (
     "AcceptedLedger", 4, 60, get_seconds_clock (),
         LogPartition::getJournal <TaggedCacheLog> ());
 
@@ -85,7 +85,9 @@ private:
     void insert (AcceptedLedgerTx::ref);
 
 private:
-    static TaggedCache <uint256, AcceptedLedger> s_cache;
+    typedef ShardedTaggedCache <uint256, AcceptedLedger, uint256::uniform_hasher> Cache;
+
+    static Cache s_cache;
 
     Ledger::pointer     mLedger;
     map_t               mMap;
@@ -34,6 +34,15 @@ enum
 
     // how many timeouts before we get aggressive
     ,ledgerBecomeAggressiveThreshold = 6
+
+    // how many missing nodes to look for when there is one request to fill
+    ,missingNodesFind = 256
+
+    // how many nodes to ask for in a single request
+    ,reqNodes = 128
+
+    // most missing nodes to look for in one pass, however many requests
+    ,missingNodesFindMax = 4096
 };
 
 InboundLedger::InboundLedger (uint256 const& hash, std::uint32_t seq, fcReason reason,
@@ -48,6 +57,7 @@ InboundLedger::InboundLedger (uint256 const& hash, std::uint32_t seq, fcReason r
     , mByHash (true)
     , mSeq (seq)
     , mReason (reason)
+    , mScheduler (getConfig ().FETCH_REQUESTS_PER_PEER)
     , mReceiveDispatched (false)
 {
 
@@ -219,6 +229,17 @@ bool InboundLedger::tryLocal ()
     return mComplete;
 }
 
+/** Request a fetch pack for a historical ledger
+    Anchored on the following ledger, if we have it
+*/
+static void LAFetchPack (Job&, uint256 hash, std::uint32_t seq)
+{
+    Ledger::pointer next = getApp().getLedgerMaster ().getLedgerBySeq (seq + 1);
+
+    if (next && (next->getParentHash () == hash))
+        getApp().getLedgerMaster ().getFetchPack (next);
+}
+
 /** Called with a lock by the PeerSet when the timer expires
 */
 void InboundLedger::onTimer (bool wasProgress, ScopedLockType&)
@@ -226,6 +247,10 @@ void InboundLedger::onTimer (bool wasProgress, ScopedLockType&)
     mRecentTXNodes.clear ();
     mRecentASNodes.clear ();
 
+    // Requests that have gone unanswered this long are not coming back
+    mScheduler.onTimeout (FetchScheduler::clock_type::now (),
+        std::chrono::milliseconds (ledgerAcquireTimeoutMillis));
+
     if (isDone())
     {
         if (m_journal.info) m_journal.info <<
@@ -262,6 +287,16 @@ void InboundLedger::onTimer (bool wasProgress, ScopedLockType&)
             "No progress(" << pc << 
             ") for ledger " << mHash;
 
+        // A historical ledger is usually the parent of one we have. A fetch
+        // pack anchored on that one brings this ledger and its predecessors
+        // in a single reply.
+        if ((mReason == fcHISTORY) && (mSeq != 0) &&
+            getApp().getOPs ().shouldFetchPack (mSeq))
+        {
+            getApp().getJobQueue ().addJob (jtLEDGER_DATA, "fetchPack",
+                BIND_TYPE (LAFetchPack, P_1, mHash, mSeq));
+        }
+
         trigger (Peer::ptr ());
         if (pc < 4)
             addPeers ();
@@ -554,18 +589,29 @@ void InboundLedger::trigger (Peer::ptr const& peer)
         }
         else
         {
+            int const slots = getRequestSlots ();
+
+            if (slots == 0)
+            {
+                if (m_journal.trace) m_journal.trace <<
+                    "All request windows full";
+                return;
+            }
+
+            int const want = std::min <int> (missingNodesFindMax,
+                std::max <int> (missingNodesFind, slots * reqNodes));
+
             std::vector<SHAMapNodeID> nodeIDs;
             std::vector<uint256> nodeHashes;
-            // VFALCO Why 256? Make this a constant
-            nodeIDs.reserve (256);
-            nodeHashes.reserve (256);
+            nodeIDs.reserve (want);
+            nodeHashes.reserve (want);
             AccountStateSF filter (mSeq);
 
             // Release the lock while we process the large state map
             sl.unlock();
 
             logTimedCall (m_journal.warning, "InboundLedger::trigger", __FILE__, __LINE__, boost::bind (
-               &SHAMap::getMissingNodes, boost::ref(mLedger->peekAccountStateMap ()), boost::ref(nodeIDs), boost::ref(nodeHashes), 256, &filter));
+               &SHAMap::getMissingNodes, boost::ref(mLedger->peekAccountStateMap ()), boost::ref(nodeIDs), boost::ref(nodeHashes), want, &filter));
 
             sl.lock();
 
@@ -586,25 +632,21 @@ void InboundLedger::trigger (Peer::ptr const& peer)
                 }
                 else
                 {
-                    // VFALCO Why 128? Make this a constant
                     if (!mAggressive)
                         filterNodes (nodeIDs, nodeHashes, mRecentASNodes,
-                            128, !isProgress ());
+                            slots * reqNodes, !isProgress ());
 
                     if (!nodeIDs.empty ())
                     {
                         tmGL.set_itype (protocol::liAS_NODE);
-                        BOOST_FOREACH (SHAMapNodeID const& it, nodeIDs)
-                        {
-                            * (tmGL.add_nodeids ()) = it.getRawString ();
-                        }
                         if (m_journal.trace) m_journal.trace <<
                             "Sending AS node " << nodeIDs.size () <<
-                                " request to " << (
-                                    peer ? "selected peer" : "all peers");
+                                " request to " << (mAggressive ? (
+                                    peer ? "selected peer" : "all peers") :
+                                        "scheduled peers");
                         if (nodeIDs.size () == 1 && m_journal.trace) m_journal.trace <<
                             "AS node: " << nodeIDs[0];
-                        sendRequest (tmGL, peer);
+                        sendNodeRequests (tmGL, nodeIDs, peer);
                         return;
                     }
                     else
@@ -636,15 +678,27 @@ void InboundLedger::trigger (Peer::ptr const& peer)
         }
         else
         {
+            int const slots = getRequestSlots ();
+
+            if (slots == 0)
+            {
+                if (m_journal.trace) m_journal.trace <<
+                    "All request windows full";
+                return;
+            }
+
+            int const want = std::min <int> (missingNodesFindMax,
+                std::max <int> (missingNodesFind, slots * reqNodes));
+
             std::vector<SHAMapNodeID> nodeIDs;
             std::vector<uint256> nodeHashes;
-            nodeIDs.reserve (256);
-            nodeHashes.reserve (256);
+            nodeIDs.reserve (want);
+            nodeHashes.reserve (want);
             TransactionStateSF filter (mSeq);
 
 
             logTimedCall (m_journal.warning, "InboundLedger::trigger", __FILE__, __LINE__, boost::bind (
-               &SHAMap::getMissingNodes, boost::ref(mLedger->peekTransactionMap ()), boost::ref(nodeIDs), boost::ref(nodeHashes), 256, &filter));
+               &SHAMap::getMissingNodes, boost::ref(mLedger->peekTransactionMap ()), boost::ref(nodeIDs), boost::ref(nodeHashes), want, &filter));
 
             if (nodeIDs.empty ())
             {
@@ -662,20 +716,17 @@ void InboundLedger::trigger (Peer::ptr const& peer)
             {
                 if (!mAggressive)
                     filterNodes (nodeIDs, nodeHashes, mRecentTXNodes,
-                        128, !isProgress ());
+                        slots * reqNodes, !isProgress ());
 
                 if (!nodeIDs.empty ())
                 {
                     tmGL.set_itype (protocol::liTX_NODE);
-                    BOOST_FOREACH (SHAMapNodeID const& it, nodeIDs)
-                    {
-                        * (tmGL.add_nodeids ()) = it.getRawString ();
-                    }
                     if (m_journal.trace) m_journal.trace <<
                         "Sending TX node " << nodeIDs.size () <<
-                        " request to " << (
-                            peer ? "selected peer" : "all peers");
-                    sendRequest (tmGL, peer);
+                        " request to " << (mAggressive ? (
+                            peer ? "selected peer" : "all peers") :
+                                "scheduled peers");
+                    sendNodeRequests (tmGL, nodeIDs, peer);
                     return;
                 }
                 else
@@ -696,6 +747,75 @@ void InboundLedger::trigger (Peer::ptr const& peer)
     }
 }
 
+/** Returns how many node requests we may send right now
+    Call with a lock
+*/
+int InboundLedger::getRequestSlots ()
+{
+    // Peers join the set through peerHas and takePeerSetFrom
+    for (auto const& p : mPeers)
+        mScheduler.addPeer (p.first);
+
+    // Without the scheduler, one request goes to everyone
+    if (mAggressive || (mScheduler.size () == 0))
+        return 1;
+
+    return mScheduler.getFreeSlots ();
+}
+
+/** Send requests for nodes
+    Spread them over the peers with room in their windows, reqNodes at a
+    time, or send them all to everyone if we are being aggressive.
+    Call with a lock
+*/
+void InboundLedger::sendNodeRequests (protocol::TMGetLedger const& tmGL,
+    std::vector<SHAMapNodeID> const& nodeIDs, Peer::ptr const& peer)
+{
+    if (mAggressive || (mScheduler.size () == 0))
+    {
+        protocol::TMGetLedger request (tmGL);
+
+        for (auto const& nodeID : nodeIDs)
+            * (request.add_nodeids ()) = nodeID.getRawString ();
+
+        sendRequest (request, peer);
+        return;
+    }
+
+    auto const now = FetchScheduler::clock_type::now ();
+    auto it = nodeIDs.begin ();
+
+    while (it != nodeIDs.end ())
+    {
+        Peer::ShortId id;
+
+        if (!mScheduler.choose (id))
+            break;
+
+        Peer::ptr target (getApp().overlay ().findPeerByShortID (id));
+
+        if (!target)
+        {
+            // Gone; stop considering it
+            mScheduler.removePeer (id);
+            mPeers.erase (id);
+            continue;
+        }
+
+        protocol::TMGetLedger request (tmGL);
+
+        for (int i = 0; (i < reqNodes) && (it != nodeIDs.end ()); ++i, ++it)
+            * (request.add_nodeids ()) = it->getRawString ();
+
+        target->sendPacket (boost::make_shared<Message> (
+            request, protocol::mtGET_LEDGER), false);
+        mScheduler.onRequest (id, now);
+    }
+
+    if ((it != nodeIDs.end ()) && m_journal.trace) m_journal.trace <<
+        (nodeIDs.end () - it) << " nodes left for the next trigger";
+}
+
 void InboundLedger::filterNodes (std::vector<SHAMapNodeID>& nodeIDs,
     std::vector<uint256>& nodeHashes, std::set<SHAMapNodeID>& recentNodes,
     int max, bool aggressive)
@@ -1122,6 +1242,10 @@ int InboundLedger::processData (boost::shared_ptr<Peer> peer,
     if ((packet.type () == protocol::liTX_NODE) || (
         packet.type () == protocol::liAS_NODE))
     {
+        // Frees a slot in this peer's window and times the round trip
+        mScheduler.onReply (peer->getShortId (),
+            FetchScheduler::clock_type::now ());
+
         std::list<SHAMapNodeID> nodeIDs;
         std::list< Blob > nodeData;
 
@@ -21,6 +21,7 @@
 #define RIPPLE_INBOUNDLEDGER_H
 
 #include "ripple_app/peers/PeerSet.h"
+#include "ripple_app/peers/FetchScheduler.h"
 
 namespace ripple {
 
@@ -129,6 +130,10 @@ private:
                      SHAMapAddNode&);
     bool takeAsRootNode (Blob const& data, SHAMapAddNode&);
 
+    int getRequestSlots ();
+    void sendNodeRequests (protocol::TMGetLedger const& tmGL,
+        std::vector<SHAMapNodeID> const& nodeIDs, Peer::ptr const& peer);
+
 private:
     Ledger::pointer    mLedger;
     bool               mHaveBase;
@@ -143,6 +148,8 @@ private:
     std::set <SHAMapNodeID> mRecentTXNodes;
     std::set <SHAMapNodeID> mRecentASNodes;
 
+    // Spreads node requests across our peers
+    FetchScheduler mScheduler;
 
     // Data we have received from peers
     PeerSet::LockType mReceivedDataLock;
@@ -380,7 +380,7 @@ private:
     LockType mLock;
 
     MapType mLedgers;
-    KeyCache <uint256> mRecentFailures;
+    KeyCache <uint256, uint256::uniform_hasher> mRecentFailures;
 
     uint256 mConsensusLedger;
     uint256 mValidationLedger;
@@ -571,12 +571,84 @@ uint256 Ledger::getHash ()
     return mHash;
 }
 
+// Steps a cached statement that returns no rows, and resets it for next time
+static bool runStatement (SqliteStatement& statement)
+{
+    int const rc = statement.step ();
+    bool const ok = statement.isDone (rc);
+
+    if (!ok)
+        WriteLog (lsWARNING, Ledger) << "Save failed: " << statement.getError (rc);
+
+    statement.reset ();
+    return ok;
+}
+
+bool Ledger::saveTransactions (SqliteDatabase* db, std::vector <TxnRow> const& rows)
+{
+    try
+    {
+        SqliteStatement& deleteTrans = db->getStatement (
+            "DELETE FROM Transactions WHERE LedgerSeq = ?;");
+        SqliteStatement& deleteAcctTrans = db->getStatement (
+            "DELETE FROM AccountTransactions WHERE LedgerSeq = ?;");
+        SqliteStatement& insertAcctTrans = db->getStatement (
+            "INSERT INTO AccountTransactions (TransID, Account, LedgerSeq, TxnSeq) "
+            "VALUES (?, ?, ?, ?);");
+        SqliteStatement& insertTrans = db->getStatement (
+            SerializedTransaction::getMetaSQLInsertReplaceHeader () +
+            "(?, ?, ?, ?, ?, ?, ?, ?);");
+
+        std::string const status (1, TXN_SQL_VALIDATED);
+
+        deleteTrans.bind (1, mLedgerSeq);
+        deleteAcctTrans.bind (1, mLedgerSeq);
+
+        if (!runStatement (deleteTrans) || !runStatement (deleteAcctTrans))
+            return false;
+
+        for (auto const& row : rows)
+        {
+            // do not delete by tx id as we can have transactions pointing to several ledgers
+
+            for (auto const& account : row.accounts)
+            {
+                insertAcctTrans.bindStatic (1, row.id);
+                insertAcctTrans.bindStatic (2, account);
+                insertAcctTrans.bind (3, mLedgerSeq);
+                insertAcctTrans.bind (4, row.txnSeq);
+
+                if (!runStatement (insertAcctTrans))
+                    return false;
+            }
+
+            // Blobs are bound as they are, no hex escaping
+            insertTrans.bindStatic (1, row.id);
+            insertTrans.bindStatic (2, row.type);
+            insertTrans.bindStatic (3, row.from);
+            insertTrans.bind (4, row.fromSeq);
+            insertTrans.bind (5, mLedgerSeq);
+            insertTrans.bindStatic (6, status);
+            insertTrans.bindStatic (7, row.raw.data (), row.raw.size ());
+            insertTrans.bindStatic (8, row.meta->data (), row.meta->size ());
+
+            if (!runStatement (insertTrans))
+                return false;
+        }
+    }
+    catch (int error)
+    {
+        WriteLog (lsWARNING, Ledger) << "Save failed to prepare: " << error;
+        return false;
+    }
+
+    return true;
+}
+
 bool Ledger::saveValidatedLedger (bool current)
 {
     WriteLog (lsTRACE, Ledger) << "saveValidatedLedger " << (current ? "" : "fromAcquire ") << getLedgerSeq ();
     static boost::format deleteLedger ("DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans1 ("DELETE FROM Transactions WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans2 ("DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
     static boost::format deleteAcctTrans ("DELETE FROM AccountTransactions WHERE TransID = '%s';");
     static boost::format transExists ("SELECT Status FROM Transactions WHERE TransID = '%s';");
     static boost::format updateTx ("UPDATE Transactions SET LedgerSeq = %u, Status = '%c', TxnMeta = %s WHERE TransID = '%s';");
@@ -623,62 +695,51 @@ bool Ledger::saveValidatedLedger (bool current)
         return false;
     }
 
-    bool res;
+    // Build the rows before taking the database lock, so readers only
+    // wait for the inserts themselves
+    std::vector <TxnRow> rows;
+    rows.reserve (aLedger->getMap ().size ());
 
+    for (const AcceptedLedger::value_type & vt: aLedger->getMap ())
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock dbLock (getApp().getTxnDB ()->getDBLock ());
-        res = db->executeSQL("BEGIN TRANSACTION;");
-        if (res)
-        {
-            res = res && db->executeSQL (boost::str (deleteTrans1 % mLedgerSeq));
-            res = res && db->executeSQL (boost::str (deleteTrans2 % mLedgerSeq));
+        uint256 txID = vt.second->getTransactionID ();
+        getApp().getMasterTransaction ().inLedger (txID, mLedgerSeq);
 
-            for (const AcceptedLedger::value_type & vt: aLedger->getMap ())
-            {
-                uint256 txID = vt.second->getTransactionID ();
-                getApp().getMasterTransaction ().inLedger (txID, mLedgerSeq);
+        SerializedTransaction::ref txn = vt.second->getTxn ();
+        Serializer s;
+        txn->add (s);
 
-                // do not delete by tx id as we can have transactions pointing to several ledgers
-                // res = res && db->executeSQL (boost::str (deleteAcctTrans % to_string (txID)));
+        rows.emplace_back ();
+        TxnRow& row = rows.back ();
+        row.id = to_string (txID);
+        row.type = txn->getTransactionType ();
+        row.from = txn->getSourceAccount ().humanAccountID ();
+        row.fromSeq = txn->getSequence ();
+        row.txnSeq = vt.second->getTxnSeq ();
+        row.raw = std::move (s.modData ());
+        row.meta = &vt.second->getRawMeta ();
 
-                const std::vector<RippleAddress>& accts = vt.second->getAffected ();
+        const std::vector<RippleAddress>& accts = vt.second->getAffected ();
 
-                if (!accts.empty ())
-                {
-                    std::string sql = "INSERT INTO AccountTransactions (TransID, Account, LedgerSeq, TxnSeq) VALUES ";
-                    bool first = true;
+        if (accts.empty ())
+            WriteLog (lsWARNING, Ledger) << "Transaction in ledger " << mLedgerSeq << " affects no accounts";
 
-                    for (auto it = accts.begin (), end = accts.end (); it != end; ++it)
-                    {
-                        if (!first)
-                            sql += ", ('";
-                        else
-                        {
-                            sql += "('";
-                            first = false;
-                        }
-
-                        sql += to_string (txID);
-                        sql += "','";
-                        sql += it->humanAccountID ();
-                        sql += "',";
-                        sql += beast::lexicalCastThrow <std::string> (getLedgerSeq ());
-                        sql += ",";
-                        sql += beast::lexicalCastThrow <std::string> (vt.second->getTxnSeq ());
-                        sql += ")";
-                    }
+        row.accounts.reserve (accts.size ());
 
-                    sql += ";";
-                    WriteLog (lsTRACE, Ledger) << "ActTx: " << sql;
-                    res = res && db->executeSQL (sql);
-                }
-                else
-                    WriteLog (lsWARNING, Ledger) << "Transaction in ledger " << mLedgerSeq << " affects no accounts";
+        for (auto const& acct : accts)
+            row.accounts.push_back (acct.humanAccountID ());
+    }
+
+    bool res;
+
+    {
+        Database* db = getApp().getTxnDB ()->getDB ();
+        DeprecatedScopedLock dbLock (getApp().getTxnDB ()->getDBLock ());
+        res = db->executeSQL("BEGIN TRANSACTION;");
+        if (res)
+        {
+            res = saveTransactions (db->getSqliteDB (), rows);
 
-                res = res && db->executeSQL (SerializedTransaction::getMetaSQLInsertReplaceHeader () +
-                                vt.second->getTxn ()->getMetaSQL (getLedgerSeq (), vt.second->getEscMeta ()) + ";");
-            }
             if (!res)
             {
                 db->executeSQL("ROLLBACK TRANSACTION;");
@@ -715,8 +776,8 @@ Ledger::pointer Ledger::loadByIndex (std::uint32_t ledgerIndex)
 {
     Ledger::pointer ledger;
     {
-        Database* db = getApp().getLedgerDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getLedgerDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getLedgerDB ());
+        Database* db = reader.getDB ();
 
         SqliteStatement pSt (db->getSqliteDB (), "SELECT "
 							"LedgerHash,PrevHash,AccountSetHash,TransSetHash,TotalCoins,"
@@ -741,8 +802,8 @@ Ledger::pointer Ledger::loadByHash (uint256 const& ledgerHash)
 {
     Ledger::pointer ledger;
     {
-        Database* db = getApp().getLedgerDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getLedgerDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getLedgerDB ());
+        Database* db = reader.getDB ();
 
         SqliteStatement pSt (db->getSqliteDB (), "SELECT "
                              "LedgerHash,PrevHash,AccountSetHash,TransSetHash,TotalCoins,"
@@ -797,8 +858,8 @@ Ledger::pointer Ledger::getSQL (const std::string& sql)
     std::string hash;
 
     {
-        Database* db = getApp().getLedgerDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getLedgerDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getLedgerDB ());
+        Database* db = reader.getDB ();
 
         if (!db->executeSQL (sql) || !db->startIterRows ())
             return Ledger::pointer ();
@@ -920,8 +981,8 @@ uint256 Ledger::getHashByIndex (std::uint32_t ledgerIndex)
 
     std::string hash;
     {
-        Database* db = getApp().getLedgerDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getLedgerDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getLedgerDB ());
+        Database* db = reader.getDB ();
 
         if (!db->executeSQL (sql) || !db->startIterRows ())
             return ret;
@@ -938,10 +999,9 @@ bool Ledger::getHashesByIndex (std::uint32_t ledgerIndex, uint256& ledgerHash, u
 {
 #ifndef NO_SQLITE3_PREPARE
 
-    DatabaseCon* con = getApp().getLedgerDB ();
-    DeprecatedScopedLock sl (con->getDBLock ());
+    DatabaseCon::Reader reader (*getApp().getLedgerDB ());
 
-    SqliteStatement pSt (con->getDB ()->getSqliteDB (),
+    SqliteStatement pSt (reader.getDB ()->getSqliteDB (),
                          "SELECT LedgerHash,PrevHash FROM Ledgers INDEXED BY SeqLedger Where LedgerSeq = ?;");
 
     pSt.bind (1, ledgerIndex);
@@ -974,8 +1034,8 @@ bool Ledger::getHashesByIndex (std::uint32_t ledgerIndex, uint256& ledgerHash, u
 
     std::string hash, prevHash;
     {
-        Database* db = getApp().getLedgerDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getLedgerDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getLedgerDB ());
+        Database* db = reader.getDB ();
 
         if (!db->executeSQL (sql) || !db->startIterRows ())
             return false;
@@ -1006,10 +1066,9 @@ Ledger::getHashesByIndex (std::uint32_t minSeq, std::uint32_t maxSeq)
     sql.append (beast::lexicalCastThrow <std::string> (maxSeq));
     sql.append (";");
 
-    DatabaseCon* con = getApp().getLedgerDB ();
-    DeprecatedScopedLock sl (con->getDBLock ());
+    DatabaseCon::Reader reader (*getApp().getLedgerDB ());
 
-    SqliteStatement pSt (con->getDB ()->getSqliteDB (), sql);
+    SqliteStatement pSt (reader.getDB ()->getSqliteDB (), sql);
 
     while (pSt.isRow (pSt.step ()))
     {
@@ -1322,6 +1381,22 @@ void Ledger::visitStateItems (std::function<void (SLE::ref)> function)
     }
 }
 
+void Ledger::visitStateItems (int branch, std::function<void (SLE::ref)> function)
+{
+    try
+    {
+        if (mAccountStateMap)
+            mAccountStateMap->visitLeaves (branch,
+                BIND_TYPE (&visitHelper, std::ref (function), P_1));
+    }
+    catch (SHAMapMissingNode&)
+    {
+        if (mHash.isNonZero ())
+            getApp().getInboundLedgers().findCreate(mHash, mLedgerSeq, InboundLedger::fcGENERIC);
+        throw;
+    }
+}
+
 /*
 // VFALCO: A proof of concept for making an iterator instead of a visitor
 class AccountItemIterator
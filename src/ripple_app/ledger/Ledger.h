@@ -61,6 +61,7 @@ enum LedgerStateParms
 #define LEDGER_JSON_FULL        0x80000000
 
 class SqliteStatement;
+class SqliteDatabase;
 
 class LedgerBase
 {
@@ -299,6 +300,11 @@ public:
     void visitAccountItems (const uint160 & acctID, std::function<void (SLE::ref)>);
     void visitStateItems (std::function<void (SLE::ref)>);
 
+    /** Visit the state items below one branch of the state map's root.
+        Visits of different branches may run on different threads.
+    */
+    void visitStateItems (int branch, std::function<void (SLE::ref)>);
+
     // database functions (low-level)
     static Ledger::pointer loadByIndex (std::uint32_t ledgerIndex);
     static Ledger::pointer loadByHash (uint256 const & ledgerHash);
@@ -488,6 +494,22 @@ protected:
 private:
     void initializeFees ();
 
+    // A transaction of this ledger, as saved in the transaction database
+    struct TxnRow
+    {
+        std::string id;
+        std::string type;
+        std::string from;
+        std::uint32_t fromSeq;
+        std::uint32_t txnSeq;
+        Blob raw;
+        Blob const* meta;
+        std::vector<std::string> accounts;
+    };
+
+    // Caller holds the transaction database lock and has begun a transaction
+    bool saveTransactions (SqliteDatabase* db, std::vector <TxnRow> const& rows);
+
 private:
     // The basic Ledger structure, can be opened, closed, or synching
     uint256     mHash;
@@ -58,6 +58,16 @@ void LedgerEntrySet::setTo (const LedgerEntrySet& e)
     mSeq = e.mSeq;
 }
 
+void LedgerEntrySet::setToDuplicate (const LedgerEntrySet& e)
+{
+    mLedger = e.mLedger;
+    mEntries = e.mEntries;
+    mSet = e.mSet;
+    mParams = tapNONE;
+    mSeq = e.mSeq + 1;
+    mImmutable = false;
+}
+
 void LedgerEntrySet::swapWith (LedgerEntrySet& e)
 {
     std::swap (mLedger, e.mLedger);
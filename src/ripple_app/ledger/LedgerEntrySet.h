@@ -105,6 +105,9 @@ public:
 
     void setTo (const LedgerEntrySet&); // Set this set to have the same contents as another
 
+    // Same as assigning duplicate (), but reuses this set's storage
+    void setToDuplicate (const LedgerEntrySet&);
+
     void swapWith (LedgerEntrySet&);    // Swap the contents of two sets
 
     void invalidate ()
@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include "../../beast/beast/unit_test/suite.h"
+
 namespace ripple {
 
 // VFALCO TODO replace macros
@@ -29,6 +31,10 @@ namespace ripple {
 #define CACHED_LEDGER_AGE 120
 #endif
 
+#ifndef CACHED_LEDGER_BYTES
+#define CACHED_LEDGER_BYTES (64 * 1024 * 1024)
+#endif
+
 // FIXME: Need to clean up ledgers by index at some point
 
 LedgerHistory::LedgerHistory ()
@@ -36,6 +42,15 @@ LedgerHistory::LedgerHistory ()
         get_seconds_clock (), LogPartition::getJournal <TaggedCacheLog> ())
     , m_consensus_validated ("ConsensusValidated", 64, 300,
         get_seconds_clock (), LogPartition::getJournal <TaggedCacheLog> ())
+    , m_newest (0)
+    , m_hotSize (CACHED_LEDGER_NUM)
+    , m_coldBudget (CACHED_LEDGER_BYTES)
+    , m_coldClock (0)
+    , m_coldHits (0)
+    , m_coldRebuilds (0)
+    , m_coldLoads (0)
+    , m_coldUnpinned (0)
+    , m_coldEvicted (0)
 {
 }
 
@@ -50,6 +65,17 @@ bool LedgerHistory::addLedger (Ledger::pointer ledger, bool validated)
     if (validated)
         mLedgersByIndex[ledger->getLedgerSeq()] = ledger->getHash();
 
+    sl.unlock ();
+
+    LedgerIndex newest = m_newest.load ();
+    while ((ledger->getLedgerSeq () > newest) &&
+        ! m_newest.compare_exchange_weak (newest, ledger->getLedgerSeq ()))
+        ;
+
+    // So it can be rebuilt cheaply once the hot tier lets go of it
+    if (! alreadyHad)
+        addCold (ledger, false);
+
     return alreadyHad;
 }
 
@@ -84,16 +110,17 @@ Ledger::pointer LedgerHistory::getLedgerBySeq (std::uint32_t index)
         return ret;
 
     assert (ret->getLedgerSeq () == index);
+    assert (ret->isImmutable ());
+
+    store (ret);
 
     {
         // Add this ledger to the local tracking by index
         LedgersByHash::ScopedLockType sl (m_ledgers_by_hash.peekMutex ());
-
-        assert (ret->isImmutable ());
-        m_ledgers_by_hash.canonicalize (ret->getHash (), ret);
         mLedgersByIndex[ret->getLedgerSeq ()] = ret->getHash ();
-        return (ret->getLedgerSeq () == index) ? ret : Ledger::pointer ();
     }
+
+    return ret;
 }
 
 Ledger::pointer LedgerHistory::getLedgerByHash (uint256 const& hash)
@@ -107,6 +134,11 @@ Ledger::pointer LedgerHistory::getLedgerByHash (uint256 const& hash)
         return ret;
     }
 
+    ret = fetchCold (hash);
+
+    if (ret)
+        return ret;
+
     ret = Ledger::loadByHash (hash);
 
     if (!ret)
@@ -114,12 +146,236 @@ Ledger::pointer LedgerHistory::getLedgerByHash (uint256 const& hash)
 
     assert (ret->isImmutable ());
     assert (ret->getHash () == hash);
-    m_ledgers_by_hash.canonicalize (ret->getHash (), ret);
+    store (ret);
     assert (ret->getHash () == hash);
 
     return ret;
 }
 
+bool LedgerHistory::isHot (LedgerIndex seq)
+{
+    return (seq + m_hotSize.load ()) > m_newest.load ();
+}
+
+void LedgerHistory::store (Ledger::ref ledger)
+{
+    if (isHot (ledger->getLedgerSeq ()))
+    {
+        Ledger::pointer hot (ledger);
+        m_ledgers_by_hash.canonicalize (hot->getHash (), hot);
+        addCold (hot, false);
+    }
+    else
+    {
+        addCold (ledger, true);
+
+        std::lock_guard <std::mutex> lock (m_coldLock);
+        ++m_coldLoads;
+    }
+}
+
+void LedgerHistory::addCold (Ledger::ref ledger, bool pin)
+{
+    Serializer s (128);
+    ledger->addRaw (s);
+
+    std::lock_guard <std::mutex> lock (m_coldLock);
+
+    ColdLedger& cold = m_cold[ledger->getHash ()];
+
+    if (cold.header.empty ())
+    {
+        cold.seq = ledger->getLedgerSeq ();
+        cold.header = s.peekData ();
+    }
+
+    if (pin && ! cold.pinned)
+    {
+        cold.pinned = ledger;
+        cold.live = ledger;
+    }
+
+    cold.lastUse = ++m_coldClock;
+}
+
+Ledger::pointer LedgerHistory::fetchCold (LedgerHash const& hash)
+{
+    Blob header;
+
+    {
+        std::lock_guard <std::mutex> lock (m_coldLock);
+
+        auto const it = m_cold.find (hash);
+
+        if (it == m_cold.end ())
+            return Ledger::pointer ();
+
+        ColdLedger& cold = it->second;
+        cold.lastUse = ++m_coldClock;
+
+        Ledger::pointer ret = cold.pinned ? cold.pinned : cold.live.lock ();
+
+        if (ret)
+        {
+            cold.pinned = ret;
+            ++m_coldHits;
+            return ret;
+        }
+
+        header = cold.header;
+    }
+
+    // Only the roots are loaded, the rest comes from the node store
+    Ledger::pointer ret (boost::make_shared <Ledger> (header, false));
+
+    if ((ret->getHash () != hash) || ! ret->loadMaps (false))
+        return Ledger::pointer ();
+
+    Ledger::getSQL2 (ret);
+    ret->setFull ();
+
+    std::lock_guard <std::mutex> lock (m_coldLock);
+
+    auto const it = m_cold.find (hash);
+
+    if (it != m_cold.end ())
+    {
+        // Someone may have rebuilt it while we were
+        if (it->second.pinned)
+            return it->second.pinned;
+
+        it->second.pinned = ret;
+        it->second.live = ret;
+    }
+
+    ++m_coldRebuilds;
+    return ret;
+}
+
+void LedgerHistory::sweepCold ()
+{
+    std::size_t const budget = m_coldBudget;
+    std::vector <std::pair <LedgerHash, Ledger::pointer>> pinned;
+
+    {
+        std::lock_guard <std::mutex> lock (m_coldLock);
+
+        for (auto const& entry : m_cold)
+        {
+            if (entry.second.pinned)
+                pinned.emplace_back (entry.first, entry.second.pinned);
+        }
+    }
+
+    // Measure outside the lock, walking loaded nodes takes a while. Nodes
+    // shared between ledgers are counted once per ledger, so this errs on
+    // the side of using less memory.
+    std::vector <std::size_t> bytes;
+    bytes.reserve (pinned.size ());
+
+    for (auto const& entry : pinned)
+    {
+        Ledger& ledger = *entry.second;
+        std::size_t const txBytes =
+            ledger.peekTransactionMap ()->getMemoryUsage (budget);
+        bytes.push_back (txBytes +
+            ledger.peekAccountStateMap ()->getMemoryUsage (budget));
+    }
+
+    std::lock_guard <std::mutex> lock (m_coldLock);
+
+    std::size_t total = m_cold.size () * coldHeaderBytes ();
+
+    for (std::size_t i = 0; i < pinned.size (); ++i)
+    {
+        auto const it = m_cold.find (pinned[i].first);
+
+        if ((it != m_cold.end ()) && it->second.pinned)
+        {
+            it->second.bytes = bytes[i];
+            total += bytes[i];
+        }
+    }
+
+    if (total <= budget)
+        return;
+
+    // Least recently used first
+    std::vector <std::pair <std::uint64_t, LedgerHash>> order;
+    order.reserve (m_cold.size ());
+
+    for (auto const& entry : m_cold)
+        order.emplace_back (entry.second.lastUse, entry.first);
+
+    std::sort (order.begin (), order.end ());
+
+    for (auto const& entry : order)
+    {
+        if (total <= budget)
+            break;
+
+        ColdLedger& cold = m_cold[entry.second];
+
+        if (cold.pinned)
+        {
+            total -= std::min (total, cold.bytes);
+            cold.pinned.reset ();
+            cold.bytes = 0;
+            ++m_coldUnpinned;
+        }
+    }
+
+    // Then the headers themselves, keeping the validated chain near the
+    // hot tier where the next lookups most likely are
+    for (auto const& entry : order)
+    {
+        if (total <= budget)
+            break;
+
+        auto const it = m_cold.find (entry.second);
+
+        if (isHot (it->second.seq))
+            continue;
+
+        m_cold.erase (it);
+        total -= std::min (total, coldHeaderBytes ());
+        ++m_coldEvicted;
+    }
+}
+
+Json::Value LedgerHistory::getJson ()
+{
+    Json::Value ret (Json::objectValue);
+
+    Json::Value& hot = ret["hot"];
+    hot["size"] = m_ledgers_by_hash.getCacheSize ();
+    hot["target_size"] = m_ledgers_by_hash.getTargetSize ();
+    hot["hit_rate"] = m_ledgers_by_hash.getHitRate ();
+
+    std::lock_guard <std::mutex> lock (m_coldLock);
+
+    std::size_t pinned = 0;
+
+    for (auto const& entry : m_cold)
+    {
+        if (entry.second.pinned)
+            ++pinned;
+    }
+
+    Json::Value& cold = ret["cold"];
+    cold["headers"] = static_cast <Json::UInt> (m_cold.size ());
+    cold["pinned"] = static_cast <Json::UInt> (pinned);
+    cold["bytes"] = static_cast <double> (coldBytes ());
+    cold["budget"] = static_cast <double> (m_coldBudget);
+    cold["hits"] = static_cast <double> (m_coldHits);
+    cold["rebuilds"] = static_cast <double> (m_coldRebuilds);
+    cold["loads"] = static_cast <double> (m_coldLoads);
+    cold["unpinned"] = static_cast <double> (m_coldUnpinned);
+    cold["evicted"] = static_cast <double> (m_coldEvicted);
+
+    return ret;
+}
+
 void LedgerHistory::builtLedger (Ledger::ref ledger)
 {
     LedgerIndex index = ledger->getLedgerSeq();
@@ -185,10 +441,164 @@ bool LedgerHistory::fixIndex (LedgerIndex ledgerIndex, LedgerHash const& ledgerH
     return true;
 }
 
-void LedgerHistory::tune (int size, int age)
+std::size_t LedgerHistory::getMemoryUsage ()
+{
+    std::lock_guard <std::mutex> lock (m_coldLock);
+    return coldBytes ();
+}
+
+std::size_t LedgerHistory::coldBytes () const
+{
+    std::size_t bytes = m_cold.size () * coldHeaderBytes ();
+
+    for (auto const& entry : m_cold)
+    {
+        if (entry.second.pinned)
+            bytes += entry.second.bytes;
+    }
+
+    return bytes;
+}
+
+void LedgerHistory::tune (int size, int age, std::size_t bytes)
 {
     m_ledgers_by_hash.setTargetSize (size);
     m_ledgers_by_hash.setTargetAge (age);
+
+    if (size > 0)
+        m_hotSize = size;
+
+    std::lock_guard <std::mutex> lock (m_coldLock);
+    m_coldBudget = bytes;
 }
 
+//------------------------------------------------------------------------------
+
+class LedgerHistory_test : public beast::unit_test::suite
+{
+public:
+    // A chain of accepted ledgers, starting with a genesis ledger
+    static std::vector <Ledger::pointer> makeChain (std::size_t count)
+    {
+        RippleAddress const rootAddress = RippleAddress::createAccountPublic (
+            RippleAddress::createSeedGeneric ("masterpassphrase"));
+
+        std::vector <Ledger::pointer> chain;
+        chain.push_back (boost::make_shared <Ledger> (
+            rootAddress, SYSTEM_CURRENCY_START));
+
+        for (;;)
+        {
+            Ledger::pointer const ledger = chain.back ();
+            ledger->setCloseTime (10 * chain.size ());
+            ledger->updateHash ();
+            ledger->setClosed ();
+            ledger->setAccepted ();
+
+            if (chain.size () == count)
+                break;
+
+            chain.push_back (boost::make_shared <Ledger> (
+                true, boost::ref (*ledger)));
+        }
+
+        return chain;
+    }
+
+    static bool isPinned (LedgerHistory& history, Ledger::ref ledger)
+    {
+        auto const it = history.m_cold.find (ledger->getHash ());
+        return (it != history.m_cold.end ()) &&
+            (it->second.pinned == ledger);
+    }
+
+    void testPlacement ()
+    {
+        testcase ("placement");
+
+        std::vector <Ledger::pointer> chain (makeChain (6));
+        LedgerHistory history;
+        history.tune (2, 120, 1024 * 1024 * 1024);
+
+        history.addLedger (chain[5], true);
+        expect (history.m_ledgers_by_hash.getCacheSize () == 1);
+        expect (history.m_cold.size () == 1);
+        expect (history.m_coldLoads == 0, "tracking is not a load");
+
+        // Too old for the hot tier
+        history.store (chain[1]);
+        expect (history.m_ledgers_by_hash.getCacheSize () == 1);
+        expect (isPinned (history, chain[1]));
+        expect (history.m_coldLoads == 1);
+
+        // Recent enough for the hot tier, the cold tier only remembers it
+        history.store (chain[4]);
+        expect (history.m_ledgers_by_hash.getCacheSize () == 2);
+        expect (history.m_cold.count (chain[4]->getHash ()) == 1);
+        expect (! isPinned (history, chain[4]));
+        expect (history.m_coldLoads == 1, "hot ledger counted as cold load");
+
+        // Found pinned in the cold tier
+        expect (history.getLedgerByHash (chain[1]->getHash ()) == chain[1]);
+        expect (history.m_coldHits == 1);
+        expect (history.m_coldRebuilds == 0);
+        expect (history.m_coldLoads == 1, "cold hit counted as load");
+    }
+
+    void testSweep ()
+    {
+        testcase ("sweep");
+
+        std::vector <Ledger::pointer> chain (makeChain (6));
+        LedgerHistory history;
+        history.tune (2, 120, 1024 * 1024 * 1024);
+
+        history.addLedger (chain[5], true);
+        history.store (chain[0]);
+        history.store (chain[1]);
+        history.store (chain[2]);
+
+        // chain[1] is now the least recently used pinned ledger
+        expect (history.fetchCold (chain[0]->getHash ()) == chain[0]);
+
+        // Within budget, only measures
+        history.sweepCold ();
+        expect (history.m_coldUnpinned == 0);
+        expect (history.m_coldEvicted == 0);
+
+        std::size_t const headers = 4 * LedgerHistory::coldHeaderBytes ();
+        std::size_t const bytes0 = history.m_cold[chain[0]->getHash ()].bytes;
+        std::size_t const bytes2 = history.m_cold[chain[2]->getHash ()].bytes;
+        expect (bytes0 > 0 && bytes2 > 0);
+
+        // Room for all the headers and two of the three pinned ledgers
+        history.m_coldBudget = headers + bytes0 + bytes2;
+        history.sweepCold ();
+        expect (history.m_coldUnpinned == 1);
+        expect (! isPinned (history, chain[1]), "LRU ledger still pinned");
+        expect (isPinned (history, chain[0]));
+        expect (isPinned (history, chain[2]));
+        expect (history.m_cold.size () == 4);
+        expect (history.getMemoryUsage () <= history.m_coldBudget);
+
+        // Not even room for the headers. The hot ledger's header stays.
+        history.m_coldBudget = headers - LedgerHistory::coldHeaderBytes ();
+        history.sweepCold ();
+        expect (history.m_coldUnpinned == 3);
+        expect (history.m_coldEvicted == 1);
+        expect (history.m_cold.size () == 3);
+        expect (history.m_cold.count (chain[1]->getHash ()) == 0);
+        expect (history.m_cold.count (chain[5]->getHash ()) == 1);
+        expect (history.getMemoryUsage () <= history.m_coldBudget);
+    }
+
+    void run ()
+    {
+        testPlacement ();
+        testSweep ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerHistory,ripple_app,ripple);
+
 } // ripple
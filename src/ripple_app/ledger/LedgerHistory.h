@@ -24,7 +24,20 @@ namespace ripple {
 
 // VFALCO TODO Rename to OldLedgers ?
 
-/** Retains historical ledgers. */
+/** Retains historical ledgers.
+
+    Ledgers are kept in two tiers. The hot tier holds recent ledgers, the
+    ones within the hot cache size of the newest ledger we have seen, fully
+    materialized in a TaggedCache sized by count and age.
+
+    The cold tier keeps only the header of every ledger it knows about.
+    An older ledger is rebuilt from its header with just the roots of its
+    maps loaded; state and transaction nodes come from the node store as
+    they are used. A rebuilt ledger stays pinned while it is being used,
+    and pinned ledgers and headers together are held to a byte budget,
+    least recently used first, so deep historical queries no longer make
+    the cache grow.
+*/
 class LedgerHistory : beast::LeakChecked <LedgerHistory>
 {
 public:
@@ -61,10 +74,11 @@ public:
     Ledger::pointer getLedgerByHash (LedgerHash const& ledgerHash);
 
     /** Set the history cache's paramters
-        @param size The target size of the cache
+        @param size The target size of the hot tier
         @param age The target age of the cache, in seconds
+        @param bytes The memory budget of the cold tier
     */
-    void tune (int size, int age);
+    void tune (int size, int age, std::size_t bytes);
 
     /** Remove stale cache entries
     */
@@ -72,8 +86,17 @@ public:
     {
         m_ledgers_by_hash.sweep ();
         m_consensus_validated.sweep ();
+        sweepCold ();
     }
 
+    /** Per-tier sizes and counters, for get_counts */
+    Json::Value getJson ();
+
+    /** Estimated bytes held by the cold tier.
+        Hot ledgers share their nodes with the tree node cache.
+    */
+    std::size_t getMemoryUsage ();
+
     /** Report that we have locally built a particular ledger
     */
     void builtLedger (Ledger::ref);
@@ -90,7 +113,54 @@ public:
     bool fixIndex(LedgerIndex ledgerIndex, LedgerHash const& ledgerHash);
 
 private:
-    typedef TaggedCache <LedgerHash, Ledger> LedgersByHash;
+    friend class LedgerHistory_test;
+
+    typedef TaggedCache <LedgerHash, Ledger,
+        LedgerHash::uniform_hasher> LedgersByHash;
+
+    // A ledger in the cold tier
+    struct ColdLedger
+    {
+        ColdLedger ()
+            : seq (0)
+            , bytes (0)
+            , lastUse (0)
+        {
+        }
+
+        LedgerIndex seq;
+        Blob header;                    // As written by Ledger::addRaw
+        Ledger::pointer pinned;         // Rebuilt ledger, while in budget
+        boost::weak_ptr <Ledger> live;  // Rebuilt ledger, while in use
+        std::size_t bytes;              // Estimated size of pinned
+        std::uint64_t lastUse;
+    };
+
+    typedef std::unordered_map <LedgerHash, ColdLedger,
+        LedgerHash::uniform_hasher> ColdLedgers;
+
+    // What a header costs in the cold tier, with the map's overhead
+    static std::size_t coldHeaderBytes ()
+    {
+        return sizeof (LedgerHash) + 128 + 2 * sizeof (void*) +
+            sizeof (ColdLedger);
+    }
+
+    // Is this ledger recent enough for the hot tier
+    bool isHot (LedgerIndex seq);
+
+    // Put a ledger we just loaded in the tier where it belongs
+    void store (Ledger::ref ledger);
+
+    // Remember a ledger's header in the cold tier
+    void addCold (Ledger::ref ledger, bool pin);
+
+    Ledger::pointer fetchCold (LedgerHash const& hash);
+
+    void sweepCold ();
+
+    // Bytes held by the cold tier. Called with m_coldLock held.
+    std::size_t coldBytes () const;
 
     LedgersByHash m_ledgers_by_hash;
 
@@ -105,6 +175,21 @@ private:
 
     // Maps ledger indexes to the corresponding hash.
     std::map <LedgerIndex, LedgerHash> mLedgersByIndex; // validated ledgers
+
+    std::atomic <LedgerIndex> m_newest;
+    std::atomic <int> m_hotSize;
+
+    std::mutex m_coldLock;
+    ColdLedgers m_cold;
+    std::size_t m_coldBudget;
+    std::uint64_t m_coldClock;
+
+    // Cold tier counters
+    std::uint64_t m_coldHits;       // Pinned or still in use
+    std::uint64_t m_coldRebuilds;   // Rebuilt from the header
+    std::uint64_t m_coldLoads;      // Read from the database, kept cold
+    std::uint64_t m_coldUnpinned;
+    std::uint64_t m_coldEvicted;
 };
 
 } // ripple
@@ -1409,9 +1409,9 @@ public:
         ScopedLockType sl (mCompleteLock);
         mCompleteLedgers.setRange (minV, maxV);
     }
-    void tune (int size, int age)
+    void tune (int size, int age, std::size_t bytes)
     {
-        mLedgerHistory.tune (size, age);
+        mLedgerHistory.tune (size, age, bytes);
     }
 
     void sweep ()
@@ -1424,6 +1424,16 @@ public:
         return mLedgerHistory.getCacheHitRate ();
     }
 
+    Json::Value getCacheJson ()
+    {
+        return mLedgerHistory.getJson ();
+    }
+
+    std::size_t getCacheMemoryUsage ()
+    {
+        return mLedgerHistory.getMemoryUsage ();
+    }
+
     void addValidateCallback (callback& c)
     {
         mOnValidate.push_back (c);
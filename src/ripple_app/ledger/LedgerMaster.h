@@ -110,6 +110,9 @@ public:
 
     virtual Ledger::pointer findAcquireLedger (std::uint32_t index, uint256 const& hash) = 0;
 
+    /** Ask a peer for a fetch pack holding the ledgers before nextLedger. */
+    virtual void getFetchPack (Ledger::ref nextLedger) = 0;
+
     virtual Ledger::pointer getLedgerBySeq (std::uint32_t index) = 0;
 
     virtual Ledger::pointer getLedgerByHash (uint256 const& hash) = 0;
@@ -127,9 +130,11 @@ public:
     virtual bool getValidatedRange (std::uint32_t& minVal, std::uint32_t& maxVal) = 0;
     virtual bool getFullValidatedRange (std::uint32_t& minVal, std::uint32_t& maxVal) = 0;
 
-    virtual void tune (int size, int age) = 0;
+    virtual void tune (int size, int age, std::size_t bytes) = 0;
     virtual void sweep () = 0;
     virtual float getCacheHitRate () = 0;
+    virtual Json::Value getCacheJson () = 0;
+    virtual std::size_t getCacheMemoryUsage () = 0;
     virtual void addValidateCallback (callback& c) = 0;
 
     virtual void checkAccept (Ledger::ref ledger) = 0;
@@ -221,10 +221,10 @@ BookListeners::pointer OrderBookDB::getBookListeners (RippleCurrency const& curr
 
 // Based on the meta, send the meta to the streams that are listening
 // We need to determine which streams a given meta effects
-void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
+void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+    Json::Value const& jvObj, InfoSub::Payload const& payload)
 {
-    ScopedLockType sl (mLock);
-
+    // getBookListeners takes the lock, it is not held while publishing.
     if (alTx.getResult () == tesSUCCESS)
     {
         // check if this is an offer or an offer cancel or a payment that consumes an offer
@@ -270,7 +270,7 @@ void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
                                 getBookListeners (currencyPays, currencyGets, issuerPays, issuerGets);
 
                             if (book)
-                                book->publish (jvObj);
+                                book->publish (jvObj, payload);
                         }
                     }
                 }
@@ -301,26 +301,32 @@ void BookListeners::removeSubscriber (std::uint64_t seq)
     mListeners.erase (seq);
 }
 
-void BookListeners::publish (Json::Value const& jvObj)
+void BookListeners::publish (Json::Value const& jvObj, InfoSub::Payload const& payload)
 {
-    Json::FastWriter jfwWriter;
-    std::string sObj = jfwWriter.write (jvObj);
+    std::vector <InfoSub::pointer> listeners;
 
-    ScopedLockType sl (mLock);
-    NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
-
-    while (it != mListeners.end ())
     {
-        InfoSub::pointer p = it->second.lock ();
+        ScopedLockType sl (mLock);
+        listeners.reserve (mListeners.size ());
 
-        if (p)
+        NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
+
+        while (it != mListeners.end ())
         {
-            p->send (jvObj, sObj, true);
-            ++it;
+            InfoSub::pointer p = it->second.lock ();
+
+            if (p)
+            {
+                listeners.push_back (p);
+                ++it;
+            }
+            else
+                it = mListeners.erase (it);
         }
-        else
-            it = mListeners.erase (it);
     }
+
+    for (auto const& p : listeners)
+        p->send (jvObj, payload, true);
 }
 
 } // ripple
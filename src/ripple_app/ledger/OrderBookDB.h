@@ -31,7 +31,11 @@ public:
     BookListeners ();
     void addSubscriber (InfoSub::ref sub);
     void removeSubscriber (std::uint64_t sub);
-    void publish (Json::Value const& jvObj);
+
+    /** Send an encoded event to each listener.
+        The lock is only held while the listeners are copied out.
+    */
+    void publish (Json::Value const& jvObj, InfoSub::Payload const& payload);
 
 private:
     typedef RippleRecursiveMutex LockType;
@@ -75,7 +79,8 @@ public:
             RippleIssuer const& issuerPays, RippleIssuer const& issuerGets);
 
     // see if this txn effects any orderbook
-    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value const& jvObj);
+    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+        Json::Value const& jvObj, InfoSub::Payload const& payload);
 
 private:
     // by ci/ii
@@ -100,6 +100,12 @@ public:
 
 Application* ApplicationImpBase::s_instance;
 
+std::size_t MemoryEstimate <SerializedLedgerEntry>::operator() (
+    SerializedLedgerEntry const& entry) const
+{
+    return entry.getMemoryUsage ();
+}
+
 //------------------------------------------------------------------------------
 
 // VFALCO TODO Move the function definitions into the class declaration
@@ -214,6 +220,7 @@ public:
     std::unique_ptr <Validations> mValidations;
     std::unique_ptr <ProofOfWorkFactory> mProofOfWorkFactory;
     std::unique_ptr <LoadManager> m_loadManager;
+    MemoryBudget m_memoryBudget;
     beast::DeadlineTimer m_sweepTimer;
     bool volatile mShutdown;
 
@@ -353,6 +360,9 @@ public:
 
         , m_loadManager (LoadManager::New (*this, LogPartition::getJournal <LoadManagerLog> ()))
 
+        , m_memoryBudget (std::size_t (getConfig ().MEMORY_BUDGET) * 1024 * 1024,
+            m_collectorManager->collector ())
+
         , m_sweepTimer (this)
 
         , mShutdown (false)
@@ -385,6 +395,8 @@ public:
 
         add (m_ledgerMaster->getPropertySource ());
 
+        addMemorySources ();
+
         // VFALCO TODO remove these once the call is thread safe.
         HashMaps::getInstance ().initializeNonce <size_t> ();
     }
@@ -396,6 +408,11 @@ public:
         return *m_collectorManager;
     }
 
+    MemoryBudget& getMemoryBudget ()
+    {
+        return m_memoryBudget;
+    }
+
     FullBelowCache& getFullBelowCache ()
     {
         return *m_fullBelowCache;
@@ -700,14 +717,14 @@ public:
 
         initSqliteDbs ();
 
-        getApp().getLedgerDB ()->getDB ()->executeSQL (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
+        getApp().getLedgerDB ()->setPragma (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
                 (getConfig ().getSize (siLgrDBCache) * 1024)));
-        getApp().getTxnDB ()->getDB ()->executeSQL (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
+        getApp().getTxnDB ()->setPragma (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
                 (getConfig ().getSize (siTxnDBCache) * 1024)));
 
         mTxnDB->getDB ()->setupCheckpointing (m_jobQueue.get());
 
-        getApp().getWorkingLedgerDB ()->getDB ()->executeSQL (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
+        getApp().getWorkingLedgerDB ()->setPragma (boost::str (boost::format ("PRAGMA cache_size=-%d;") %
                 (getConfig ().getSize (siWorkingLgrDBCache) * 1024)));
 
         if (!getConfig ().RUN_STANDALONE)
@@ -722,7 +739,8 @@ public:
 
         mValidations->tune (getConfig ().getSize (siValidationsSize), getConfig ().getSize (siValidationsAge));
         m_nodeStore->tune (getConfig ().getSize (siNodeCacheSize), getConfig ().getSize (siNodeCacheAge));
-        m_ledgerMaster->tune (getConfig ().getSize (siLedgerSize), getConfig ().getSize (siLedgerAge));
+        m_ledgerMaster->tune (getConfig ().getSize (siLedgerSize), getConfig ().getSize (siLedgerAge),
+            std::size_t (getConfig ().getSize (siLedgerHistoryMB)) * 1024 * 1024);
         m_sleCache.setTargetSize (getConfig ().getSize (siSLECacheSize));
         m_sleCache.setTargetAge (getConfig ().getSize (siSLECacheAge));
 
@@ -1151,10 +1169,43 @@ public:
         logTimedCall (m_journal.warning, "NetworkOPs::sweepFetchPack", __FILE__, __LINE__, boost::bind (
             &NetworkOPs::sweepFetchPack, m_networkOPs.get ()));
 
+        logTimedCall (m_journal.warning, "MemoryBudget::update", __FILE__, __LINE__, boost::bind (
+            &MemoryBudget::update, &m_memoryBudget));
+
         // VFALCO NOTE does the call to sweep() happen on another thread?
         m_sweepTimer.setExpiration (getConfig ().getSize (siSweepInterval));
     }
 
+    // Shares are relative weights, over what the hash router leaves
+    void addMemorySources ()
+    {
+#ifdef ENABLE_SHAMAP_CACHE
+        m_memoryBudget.addCache ("tree_nodes", 35, SHAMap::getTreeNodeCache ());
+#endif
+
+        m_memoryBudget.addEntries ("node_store", 25,
+            [this] { return m_nodeStore->getCacheMemoryUsage (); },
+            [this] { return m_nodeStore->getCacheSize (); },
+            [this] (std::size_t target)
+            {
+                m_nodeStore->tune (int (target), getConfig ().getSize (siNodeCacheAge));
+            });
+
+        m_memoryBudget.addBytes ("ledgers", 15,
+            [this] { return m_ledgerMaster->getCacheMemoryUsage (); },
+            [this] (std::size_t bytes)
+            {
+                m_ledgerMaster->tune (getConfig ().getSize (siLedgerSize),
+                    getConfig ().getSize (siLedgerAge), bytes);
+            });
+
+        m_memoryBudget.addCache ("ledger_entries", 15, m_sleCache);
+        m_memoryBudget.addCache ("transactions", 10, m_txMaster.getCache ());
+
+        m_memoryBudget.add ("hash_router",
+            [this] { return mHashRouter->getMemoryUsage (); });
+    }
+
     void startNewLedger (std::uint32_t closeTime = 0);
 
 private:
@@ -22,7 +22,7 @@
 
 #include <boost/asio.hpp>
 #include "FullBelowCache.h"
-#include "ripple/common/TaggedCache.h"
+#include "ripple/common/ShardedTaggedCache.h"
 #include "beast/beast/utility/PropertyStream.h"
 #include "ripple_basics/types/BasicTypes.h"
 #include "ripple_core/functional/Job.h"
@@ -46,6 +46,7 @@ class JobQueue;
 class InboundLedgers;
 class LedgerMaster;
 class LoadManager;
+class MemoryBudget;
 class NetworkOPs;
 class OrderBookDB;
 class ProofOfWorkFactory;
@@ -58,8 +59,14 @@ class PathRequests;
 class DatabaseCon;
 class Validations;
 
-typedef TaggedCache <uint256, Blob> NodeCache;
-typedef TaggedCache <uint256, SerializedLedgerEntry> SLECache;
+typedef TaggedCache <uint256, Blob, uint256::uniform_hasher> NodeCache;
+template <>
+struct MemoryEstimate <SerializedLedgerEntry>
+{
+    std::size_t operator() (SerializedLedgerEntry const& entry) const;
+};
+
+typedef ShardedTaggedCache <uint256, SerializedLedgerEntry, uint256::uniform_hasher> SLECache;
 
 class Application : public beast::PropertyStream::Source
 {
@@ -88,6 +95,7 @@ public:
     virtual boost::asio::io_service& getIOService () = 0;
     virtual CollectorManager&       getCollectorManager () = 0;
     virtual FullBelowCache&         getFullBelowCache () = 0;
+    virtual MemoryBudget&           getMemoryBudget () = 0;
     virtual JobQueue&               getJobQueue () = 0;
     virtual RPC::Manager&           getRPCManager () = 0;
     virtual SiteFiles::Manager&     getSiteFiles () = 0;
@@ -17,6 +17,10 @@
 */
 //==============================================================================
 
+#include "../src/ledger/LedgerMaster.h"
+
+#include <array>
+#include <chrono>
 #include <fstream>
 
 namespace ripple
@@ -77,16 +81,82 @@ LedgerDump::dumpLedger (int ledgerNum)
 }
 
 
+/**
+ * Fill a dump record with a ledger's raw header and its transactions,
+ * without metadata, in the order they were applied.
+ */
+static void
+makeDumpRecord (Ledger& ledger, LedgerDumpRecord& record)
+{
+    Serializer s (128);
+    s.add32 (HashPrefix::ledgerMaster);
+    ledger.addRaw (s);
+
+    record.seq = ledger.getLedgerSeq ();
+    record.header = s.peekData ();
+    record.txs.clear ();
+
+    std::vector<std::pair<std::uint32_t, Blob>> txs;
+    SHAMap& txMap = *ledger.peekTransactionMap ();
+    SHAMapTreeNode::TNType type;
+
+    for (SHAMapItem::pointer item = txMap.peekFirstItem (type); !!item;
+         item = txMap.peekNextItem (item->getTag (), type))
+    {
+        SerializerIterator sit (item->peekSerializer ());
+
+        if (type == SHAMapTreeNode::tnTRANSACTION_NM)
+        {
+            txs.push_back (std::make_pair (
+                static_cast<std::uint32_t> (txs.size ()),
+                item->peekData ()));
+        }
+        else
+        {
+            require (type == SHAMapTreeNode::tnTRANSACTION_MD,
+                     "Unexpected transaction map entry");
+            Blob txn (sit.getVL ());
+            TransactionMetaSet meta (item->getTag (), record.seq, sit.getVL ());
+            txs.push_back (std::make_pair (meta.getIndex (), std::move (txn)));
+        }
+    }
+
+    std::sort (txs.begin (), txs.end (),
+        [](std::pair<std::uint32_t, Blob> const& a,
+           std::pair<std::uint32_t, Blob> const& b)
+        {
+            return a.first < b.first;
+        });
+
+    record.txs.reserve (txs.size ());
+    for (auto& tx : txs)
+        record.txs.push_back (std::move (tx.second));
+}
+
 /**
  * Instantiate an application, enumerate all its ledgers, and dump them
- * to `filename` as a stream of JSON objects, one per ledger,
- * delimited by the `DUMP_DELIM` character.
+ * to `filename`. The "json" format is a stream of JSON objects, one per
+ * ledger, delimited by the `DUMP_DELIM` character. The "binary" and
+ * "snappy" formats are described in LedgerDumpFile.h.
  */
 void
-LedgerDump::dumpTransactions (std::string const& filename)
+LedgerDump::dumpTransactions (std::string const& filename,
+                              std::string const& format)
 {
-    std::ofstream out (filename);
-    require(bool(out), "Cannot open output file");
+    require (format == "json" || format == "binary" || format == "snappy",
+             "Unknown dump format");
+
+    std::ofstream out;
+    std::unique_ptr<LedgerDumpWriter> writer;
+    if (format == "json")
+    {
+        out.open (filename);
+        require(bool(out), "Cannot open output file");
+    }
+    else
+    {
+        writer.reset (new LedgerDumpWriter (filename, format == "snappy"));
+    }
 
     std::unique_ptr <Application> app (make_Application ());
     std::uint32_t minLedgerSeq = 0, maxLedgerSeq = static_cast<uint32_t> (-1);
@@ -99,9 +169,10 @@ LedgerDump::dumpTransactions (std::string const& filename)
         << "Dumping " << ledgerHashes.size () << " ledgers to " << filename;
 
     auto nLedgers = 0;
+    LedgerDumpRecord record;
     for (auto const &ix : ledgerHashes)
     {
-        if (nLedgers != 0)
+        if (nLedgers != 0 && !writer)
         {
             out << DUMP_DELIM << std::endl;
         }
@@ -113,9 +184,20 @@ LedgerDump::dumpTransactions (std::string const& filename)
 
         nLedgers++;
         auto ledger = lm.getLedgerBySeq (ix.first);
-        out << ledger->getJson (LEDGER_JSON_BULK) << std::endl;
+        if (writer)
+        {
+            makeDumpRecord (*ledger, record);
+            writer->add (record);
+        }
+        else
+        {
+            out << ledger->getJson (LEDGER_JSON_BULK) << std::endl;
+        }
     }
 
+    if (writer)
+        writer->finish ();
+
     WriteLog (lsINFO, LedgerDump) << "Dumped " << ledgerHashes.size()
                                   << " ledgers to " << filename;
     exit (0);
@@ -177,6 +259,38 @@ loadLedgerAndTransactionsFromJSON(Application& app, Json::Value const& j)
     return std::make_tuple (ledger, txSet, txOrder);
 }
 
+/**
+ * Decode a record of a binary dump into the same 3-tuple as
+ * loadLedgerAndTransactionsFromJSON.
+ */
+static std::tuple<Ledger::pointer, SHAMap::pointer, std::vector<uint256> >
+loadLedgerAndTransactionsFromRecord(Application& app,
+                                    LedgerDumpRecord const& record)
+{
+    Ledger::pointer ledger = boost::make_shared<Ledger> (record.header, true);
+    require (ledger->getLedgerSeq () == record.seq,
+             "Ledger header does not match record sequence");
+
+    SHAMap::pointer txSet =
+        boost::make_shared<SHAMap> (smtTRANSACTION, app.getFullBelowCache());
+
+    std::vector<uint256> txOrder;
+    txOrder.reserve (record.txs.size ());
+
+    for (auto const& blob : record.txs)
+    {
+        Serializer ser (blob);
+        SerializerIterator sit (ser);
+        SerializedTransaction stx (sit);
+
+        auto txID = stx.getTransactionID();
+        require (txSet->addItem (SHAMapItem (txID, ser), true, true),
+                 "Error adding transaction");
+        txOrder.push_back (txID);
+    }
+    return std::make_tuple (ledger, txSet, txOrder);
+}
+
 static std::map<LedgerEntryType, std::string>
 entryTypeNames =
 {
@@ -259,15 +373,171 @@ loadJsonRecord (std::istream& in)
     return j;
 }
 
+/**
+ * Times the phases of each replayed ledger close and, when given a file,
+ * writes them there as one JSON object per line, followed by a summary
+ * line with per-phase totals and percentiles. Running the replay with a
+ * Memory or Null node store leaves only the CPU cost of a close.
+ */
+class ReplayBenchmark
+{
+public:
+    enum Phase
+    {
+        phaseApply,     // applying the transaction set
+        phaseHash,      // skip list and ledger header hashing
+        phaseFlush,     // writing dirty map nodes to the node store
+        phaseCommit,    // stellar::LedgerMaster::commitLedgerClose
+        phaseSave,      // Ledger::saveValidatedLedger
+        phaseCount
+    };
+
+    typedef std::chrono::steady_clock clock_type;
+    typedef std::chrono::microseconds duration;
+
+    explicit ReplayBenchmark (std::string const& filename)
+        : mLedgers (0)
+        , mTxs (0)
+    {
+        if (!filename.empty ())
+        {
+            mOut.open (filename);
+            require ((bool)mOut, "opening benchmark file");
+        }
+    }
+
+    bool enabled () const
+    {
+        return mOut.is_open ();
+    }
+
+    void startLedger ()
+    {
+        mTimes.fill (duration::zero ());
+        mStart = clock_type::now ();
+        mLast = mStart;
+    }
+
+    // Charges the time since the previous mark to `phase`.
+    void mark (Phase phase)
+    {
+        auto const now = clock_type::now ();
+        mTimes[phase] += std::chrono::duration_cast<duration> (now - mLast);
+        mLast = now;
+    }
+
+    // Skips the time since the previous mark.
+    void skip ()
+    {
+        mLast = clock_type::now ();
+    }
+
+    void endLedger (LedgerSeq seq, std::size_t txs, int accountNodes,
+                    int txNodes)
+    {
+        if (!enabled ())
+            return;
+
+        auto const close = std::chrono::duration_cast<duration> (
+            clock_type::now () - mStart);
+
+        Json::Value j (Json::objectValue);
+        j["seq"] = seq;
+        j["txs"] = static_cast<Json::UInt> (txs);
+        j["account_nodes"] = accountNodes;
+        j["tx_nodes"] = txNodes;
+        for (int i = 0; i < phaseCount; ++i)
+        {
+            j[std::string (name (i)) + "_us"] =
+                static_cast<Json::UInt> (mTimes[i].count ());
+            mHistograms[i].record (mTimes[i]);
+        }
+        j["close_us"] = static_cast<Json::UInt> (close.count ());
+        mClose.record (close);
+
+        mOut << mWriter.write (j);
+
+        ++mLedgers;
+        mTxs += txs;
+    }
+
+    void finish ()
+    {
+        if (!enabled ())
+            return;
+
+        Json::Value summary (Json::objectValue);
+        summary["ledgers"] = static_cast<Json::UInt> (mLedgers);
+        summary["txs"] = static_cast<Json::UInt> (mTxs);
+        summary["node_store"] =
+            getConfig ().nodeDatabase["type"].toStdString ();
+
+        Json::Value& phases = summary["phases"];
+        for (int i = 0; i < phaseCount; ++i)
+            phases[name (i)] = getJson (mHistograms[i]);
+        summary["close"] = getJson (mClose);
+
+        Json::Value j (Json::objectValue);
+        j["summary"] = summary;
+        mOut << mWriter.write (j);
+        mOut.close ();
+    }
+
+private:
+    static char const* name (int phase)
+    {
+        static char const* const names[phaseCount] =
+            { "apply", "hash", "flush", "commit", "save" };
+        return names[phase];
+    }
+
+    static Json::Value getJson (LatencyHistogram const& h)
+    {
+        auto const s = h.snapshot ();
+        Json::Value j (Json::objectValue);
+        // The total can outgrow Json::UInt on a long replay
+        j["total_us"] = static_cast<double> (s.sum);
+        j["mean_us"] = static_cast<Json::UInt> (s.mean ());
+        j["p50_us"] = static_cast<Json::UInt> (s.percentile (50));
+        j["p90_us"] = static_cast<Json::UInt> (s.percentile (90));
+        j["p99_us"] = static_cast<Json::UInt> (s.percentile (99));
+        j["max_us"] = static_cast<Json::UInt> (s.max);
+        return j;
+    }
+
+    std::ofstream mOut;
+    Json::FastWriter mWriter;
+
+    clock_type::time_point mStart;
+    clock_type::time_point mLast;
+    std::array<duration, phaseCount> mTimes;
+
+    std::array<LatencyHistogram, phaseCount> mHistograms;
+    LatencyHistogram mClose;
+    std::size_t mLedgers;
+    std::size_t mTxs;
+};
+
 /**
  * Instantiate an application and replay a ledger history out
- * of the dump file `filename`.
+ * of the dump file `filename`, in either format. If `benchmark`
+ * is not empty, per-ledger close timings are written to it.
  */
 void
-LedgerDump::loadTransactions (std::string const& filename)
+LedgerDump::loadTransactions (std::string const& filename,
+                              std::string const& benchmark)
 {
-    std::ifstream in (filename);
-    require ((bool)in, "opening file");
+    std::ifstream in;
+    std::unique_ptr<LedgerDumpReader> reader;
+    if (LedgerDumpReader::isDumpFile (filename))
+    {
+        reader.reset (new LedgerDumpReader (filename));
+    }
+    else
+    {
+        in.open (filename);
+        require ((bool)in, "opening file");
+    }
 
     std::unique_ptr <Application> app (make_Application ());
     app->setup ();
@@ -275,6 +545,7 @@ LedgerDump::loadTransactions (std::string const& filename)
     WriteLog (lsINFO, LedgerDump) << "Loading ledgers from " << filename;
 
     auto nTxs = 0;
+    ReplayBenchmark bench (benchmark);
 
     // app->setup() when called with START_UP == Config::FRESH calls
     // ApplicationImp::startNewLedger(). Unfortunately it starts the new
@@ -301,20 +572,44 @@ LedgerDump::loadTransactions (std::string const& filename)
 
     Ledger::pointer parentLedger;
 
-    while (in)
+    if (reader && !getConfig ().START_LEDGER.empty ())
+    {
+        // With --ledger, the index takes us straight to the record
+        // following the loaded ledger.
+        require (app->loadOldLedger (getConfig ().START_LEDGER, false),
+                 "Reloading old ledger failed.");
+        parentLedger = lm.getClosedLedger ();
+        require (reader->seek (parentLedger->getLedgerSeq () + 1),
+                 "Missing ledgers between loaded and replay-start");
+        gLedgerSeq = parentLedger->getLedgerSeq ();
+    }
+
+    LedgerDumpRecord record;
+
+    while (reader || in)
     {
         if ((gLedgerSeq & 0xfff) == 0) {
             Job j;
             app->doSweep (j);
         }
 
-        Json::Value j = loadJsonRecord (in);
-
         Ledger::pointer deserializedLedger;
         SHAMap::pointer txSet;
         std::vector<uint256> txOrder;
-        std::tie (deserializedLedger, txSet, txOrder) =
-            loadLedgerAndTransactionsFromJSON (*app, j);
+
+        if (reader)
+        {
+            if (!reader->next (record))
+                break;
+            std::tie (deserializedLedger, txSet, txOrder) =
+                loadLedgerAndTransactionsFromRecord (*app, record);
+        }
+        else
+        {
+            Json::Value j = loadJsonRecord (in);
+            std::tie (deserializedLedger, txSet, txOrder) =
+                loadLedgerAndTransactionsFromJSON (*app, j);
+        }
 
         if (!parentLedger)
         {
@@ -341,13 +636,13 @@ LedgerDump::loadTransactions (std::string const& filename)
             }
 
             auto const parentSeq = parentLedger->getLedgerSeq ();
-            auto seq = j["seq"].asUInt ();
-            while (parentSeq + 1 > seq)
+            auto seq = deserializedLedger->getLedgerSeq ();
+            while (!reader && parentSeq + 1 > seq)
             {
                 // Fast-scan JSON records until we hit the right one.
                 WriteLog (lsINFO, LedgerDump) << "scanning past ledger: "
                                               << seq;
-                j = loadJsonRecord (in);
+                Json::Value j = loadJsonRecord (in);
                 seq = j["seq"].asUInt ();
                 if (parentSeq + 1 <= seq)
                 {
@@ -382,7 +677,14 @@ LedgerDump::loadTransactions (std::string const& filename)
 
         gLedgerSeq++;
 
+        // As in consensus, the SQL mirror's changes for this ledger go
+        // into a single database transaction.
+        bench.startLedger ();
+        stellar::gLedgerMaster->beginClosingLedger ();
+
         // Apply transactions, transitioning from one ledger state to next.
+        // The state map rehashes the paths it modifies as it goes, so
+        // most of the map hashing is counted here.
         WriteLog (lsDEBUG, LedgerDump)
             << "Applying set of " << txOrder.size() << " transactions";
         CanonicalTXSet retriableTransactions (txSet->getHash ());
@@ -390,18 +692,22 @@ LedgerDump::loadTransactions (std::string const& filename)
         LedgerConsensus::applyTransactions (txSet, currentLedger, currentLedger,
                                             retriableTransactions, failedTransactions,
                                             false, txOrder);
+        bench.mark (ReplayBenchmark::phaseApply);
 
         require (retriableTransactions.empty (), "failed retriable tx set is not empty");
         require (failedTransactions.empty (), "failed tx set is not empty");
 
+        bench.skip ();
         currentLedger->updateSkipList ();
         currentLedger->setClosed ();
         currentLedger->setCloseTime (deserializedLedger->getCloseTimeNC ());
+        bench.mark (ReplayBenchmark::phaseHash);
 
         int asf = currentLedger->peekAccountStateMap ()->flushDirty (
             hotACCOUNT_NODE, currentLedger->getLedgerSeq());
         int tmf = currentLedger->peekTransactionMap ()->flushDirty (
             hotTRANSACTION_NODE, currentLedger->getLedgerSeq());
+        bench.mark (ReplayBenchmark::phaseFlush);
         nTxs += tmf;
 
         WriteLog (lsDEBUG, LedgerDump) << "Flushed " << asf << " account "
@@ -409,9 +715,22 @@ LedgerDump::loadTransactions (std::string const& filename)
 
         // Finalize with the LedgerMaster.
         currentLedger->setAccepted ();
+        bench.mark (ReplayBenchmark::phaseHash);
+
+        require (stellar::gLedgerMaster->commitLedgerClose (currentLedger),
+                 "Could not commit to the database");
+        bench.mark (ReplayBenchmark::phaseCommit);
+
+        // Standalone pushLedger would save the ledger anyway; doing it
+        // here lets us time it. The second save is skipped.
+        currentLedger->pendSaveValidated (true, false);
+        bench.mark (ReplayBenchmark::phaseSave);
+
         bool alreadyHadLedger = lm.storeLedger (currentLedger);
         assert (! alreadyHadLedger);
         lm.pushLedger (currentLedger);
+        bench.endLedger (currentLedger->getLedgerSeq (), txOrder.size (),
+                         asf, tmf);
 
         WriteLog (lsTRACE, LedgerDump) << "parent ledger:";
         traceLedgerContents (*parentLedger);
@@ -435,6 +754,7 @@ LedgerDump::loadTransactions (std::string const& filename)
                              << gLedgerSeq << "ledgers, "
                              << nTxs << " transactions from "
                              << filename;
+    bench.finish ();
     exit (0);
 }
 
@@ -45,7 +45,9 @@ namespace ripple
     {
         static bool enactHistoricalQuirk (HistoricalQuirk k);
         static void dumpLedger (int ledgerNum);
-        static void dumpTransactions (std::string const& filename);
-        static void loadTransactions (std::string const& filename);
+        static void dumpTransactions (std::string const& filename,
+                                      std::string const& format);
+        static void loadTransactions (std::string const& filename,
+                                      std::string const& benchmark);
     };
 }
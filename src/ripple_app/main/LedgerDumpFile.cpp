@@ -0,0 +1,483 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <snappy.h>
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple
+{
+
+static char const DUMP_MAGIC[8] = { 'S', 'L', 'D', 'G', 'D', 'U', 'M', 'P' };
+static char const INDEX_MAGIC[8] = { 'S', 'L', 'D', 'G', 'I', 'N', 'D', 'X' };
+
+static std::uint32_t const DUMP_VERSION = 1;
+static std::uint32_t const DUMP_FLAG_SNAPPY = 1;
+
+// Sizes of the fixed parts of the file
+static int const HEADER_SIZE = 16;
+static int const BLOCK_HEADER_SIZE = 12;
+static int const INDEX_ENTRY_SIZE = 12;
+static int const TRAILER_SIZE = 24;
+
+// A block is written once its records reach this many bytes
+static int const BLOCK_TARGET_SIZE = 64 * 1024;
+
+// How many decoded blocks the reader keeps ready
+static std::size_t const READ_AHEAD_BLOCKS = 16;
+
+static void
+requireDump (bool b, char const* msg)
+{
+    if (!b)
+        throw std::runtime_error (std::string ("ledger dump: ") + msg);
+}
+
+// Read `size` bytes at `offset` into a Serializer.
+static Serializer
+readAt (std::ifstream& in, std::uint64_t offset, std::size_t size)
+{
+    Serializer s (size);
+    s.modData ().resize (size);
+    in.seekg (offset);
+    if (size != 0)
+        in.read (reinterpret_cast<char*> (&s.modData ().front ()), size);
+    requireDump (bool (in), "short read");
+    return s;
+}
+
+//------------------------------------------------------------------------------
+
+LedgerDumpWriter::LedgerDumpWriter (std::string const& filename, bool compress)
+    : mOut (filename, std::ios::out | std::ios::binary | std::ios::trunc)
+    , mCompress (compress)
+    , mFinished (false)
+    , mOffset (0)
+    , mBlock (BLOCK_TARGET_SIZE + 4096)
+    , mBlockRecords (0)
+{
+    requireDump (bool (mOut), "cannot open output file");
+
+    Serializer s (HEADER_SIZE);
+    s.addRaw (DUMP_MAGIC, sizeof (DUMP_MAGIC));
+    s.add32 (DUMP_VERSION);
+    s.add32 (mCompress ? DUMP_FLAG_SNAPPY : 0);
+    write (s);
+}
+
+void
+LedgerDumpWriter::add (LedgerDumpRecord const& record)
+{
+    requireDump (!mFinished, "add after finish");
+    requireDump (mIndex.empty () || mIndex.back ().first < record.seq,
+                 "records out of order");
+
+    // The block is written at the current offset when it is flushed
+    mIndex.push_back (std::make_pair (record.seq, mOffset));
+
+    mBlock.add32 (record.seq);
+    mBlock.addVL (record.header);
+    mBlock.add32 (static_cast<std::uint32_t> (record.txs.size ()));
+    for (auto const& tx : record.txs)
+        mBlock.addVL (tx);
+    ++mBlockRecords;
+
+    if (mBlock.getLength () >= BLOCK_TARGET_SIZE)
+        flushBlock ();
+}
+
+void
+LedgerDumpWriter::finish ()
+{
+    if (mFinished)
+        return;
+
+    flushBlock ();
+
+    std::uint64_t const indexOffset = mOffset;
+
+    Serializer index (mIndex.size () * INDEX_ENTRY_SIZE);
+    for (auto const& entry : mIndex)
+    {
+        index.add32 (entry.first);
+        index.add64 (entry.second);
+    }
+    write (index);
+
+    Serializer trailer (TRAILER_SIZE);
+    trailer.add64 (indexOffset);
+    trailer.add64 (mIndex.size ());
+    trailer.addRaw (INDEX_MAGIC, sizeof (INDEX_MAGIC));
+    write (trailer);
+
+    mOut.close ();
+    requireDump (!mOut.fail (), "error closing output file");
+    mFinished = true;
+}
+
+void
+LedgerDumpWriter::write (Serializer const& s)
+{
+    mOut.write (static_cast<char const*> (s.getDataPtr ()), s.getLength ());
+    requireDump (bool (mOut), "write failed");
+    mOffset += s.getLength ();
+}
+
+void
+LedgerDumpWriter::flushBlock ()
+{
+    if (mBlockRecords == 0)
+        return;
+
+    char const* data = static_cast<char const*> (mBlock.getDataPtr ());
+    std::size_t const rawSize = mBlock.getLength ();
+
+    std::string compressed;
+    if (mCompress)
+    {
+        snappy::Compress (data, rawSize, &compressed);
+        data = compressed.data ();
+    }
+    std::size_t const storedSize = mCompress ? compressed.size () : rawSize;
+
+    Serializer header (BLOCK_HEADER_SIZE);
+    header.add32 (static_cast<std::uint32_t> (storedSize));
+    header.add32 (static_cast<std::uint32_t> (rawSize));
+    header.add32 (mBlockRecords);
+    write (header);
+
+    mOut.write (data, storedSize);
+    requireDump (bool (mOut), "write failed");
+    mOffset += storedSize;
+
+    mBlock.erase ();
+    mBlockRecords = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool
+LedgerDumpReader::isDumpFile (std::string const& filename)
+{
+    std::ifstream in (filename, std::ios::in | std::ios::binary);
+    char magic[sizeof (DUMP_MAGIC)];
+    in.read (magic, sizeof (magic));
+    return in && std::equal (magic, magic + sizeof (magic), DUMP_MAGIC);
+}
+
+LedgerDumpReader::LedgerDumpReader (std::string const& filename)
+    : mFilename (filename)
+    , mCompressed (false)
+    , mDataEnd (0)
+    , mStart (HEADER_SIZE)
+    , mSkipTo (0)
+    , mStarted (false)
+    , mDone (false)
+    , mStop (false)
+    , mCurrentPos (0)
+{
+    std::ifstream in (filename, std::ios::in | std::ios::binary);
+    requireDump (bool (in), "cannot open input file");
+
+    in.seekg (0, std::ios::end);
+    std::uint64_t const fileSize = in.tellg ();
+    requireDump (fileSize >= HEADER_SIZE + TRAILER_SIZE, "file too short");
+
+    {
+        Serializer s (readAt (in, 0, HEADER_SIZE));
+        requireDump (std::equal (DUMP_MAGIC, DUMP_MAGIC + sizeof (DUMP_MAGIC),
+            static_cast<char const*> (s.getDataPtr ())), "bad magic");
+        SerializerIterator sit (s);
+        sit.getRaw (sizeof (DUMP_MAGIC));
+        requireDump (sit.get32 () == DUMP_VERSION, "unknown version");
+        mCompressed = (sit.get32 () & DUMP_FLAG_SNAPPY) != 0;
+    }
+
+    std::uint64_t count;
+    {
+        Serializer s (readAt (in, fileSize - TRAILER_SIZE, TRAILER_SIZE));
+        SerializerIterator sit (s);
+        mDataEnd = sit.get64 ();
+        count = sit.get64 ();
+        Blob const magic (sit.getRaw (sizeof (INDEX_MAGIC)));
+        requireDump (std::equal (INDEX_MAGIC, INDEX_MAGIC + sizeof (INDEX_MAGIC),
+            magic.begin ()), "missing index; was the dump finished?");
+    }
+
+    requireDump (mDataEnd >= HEADER_SIZE &&
+        mDataEnd + count * INDEX_ENTRY_SIZE + TRAILER_SIZE == fileSize,
+        "bad index size");
+
+    Serializer s (readAt (in, mDataEnd, count * INDEX_ENTRY_SIZE));
+    SerializerIterator sit (s);
+    mIndex.reserve (count);
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        LedgerSeq const seq = sit.get32 ();
+        std::uint64_t const offset = sit.get64 ();
+        mIndex.push_back (std::make_pair (seq, offset));
+    }
+}
+
+LedgerDumpReader::~LedgerDumpReader ()
+{
+    {
+        std::lock_guard<std::mutex> lock (mMutex);
+        mStop = true;
+    }
+    mCond.notify_all ();
+
+    if (mThread.joinable ())
+        mThread.join ();
+}
+
+bool
+LedgerDumpReader::seek (LedgerSeq seq)
+{
+    requireDump (!mStarted, "seek after reading");
+
+    auto const iter = std::lower_bound (mIndex.begin (), mIndex.end (),
+        std::make_pair (seq, std::uint64_t (0)));
+
+    if (iter == mIndex.end () || iter->first != seq)
+        return false;
+
+    mStart = iter->second;
+    mSkipTo = seq;
+    return true;
+}
+
+bool
+LedgerDumpReader::next (LedgerDumpRecord& record)
+{
+    if (!mStarted)
+    {
+        mStarted = true;
+        mThread = std::thread (&LedgerDumpReader::readAhead, this);
+    }
+
+    while (mCurrentPos == mCurrent.size ())
+    {
+        std::unique_lock<std::mutex> lock (mMutex);
+
+        while (mQueue.empty () && !mDone)
+            mCond.wait (lock);
+
+        if (mQueue.empty ())
+        {
+            requireDump (mError.empty (), mError.c_str ());
+            return false;
+        }
+
+        mCurrent = std::move (mQueue.front ());
+        mQueue.pop_front ();
+        mCurrentPos = 0;
+        lock.unlock ();
+        mCond.notify_all ();
+
+        while (mCurrentPos < mCurrent.size () &&
+               mCurrent[mCurrentPos].seq < mSkipTo)
+            ++mCurrentPos;
+    }
+
+    record = std::move (mCurrent[mCurrentPos++]);
+    return true;
+}
+
+void
+LedgerDumpReader::readAhead ()
+{
+    try
+    {
+        std::ifstream in (mFilename, std::ios::in | std::ios::binary);
+        requireDump (bool (in), "cannot open input file");
+
+        std::uint64_t offset = mStart;
+        while (offset < mDataEnd)
+        {
+            Block block;
+            offset = readBlock (in, offset, block);
+
+            std::unique_lock<std::mutex> lock (mMutex);
+            while (mQueue.size () >= READ_AHEAD_BLOCKS && !mStop)
+                mCond.wait (lock);
+            if (mStop)
+                return;
+            mQueue.push_back (std::move (block));
+            lock.unlock ();
+            mCond.notify_all ();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        std::lock_guard<std::mutex> lock (mMutex);
+        mError = e.what ();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock (mMutex);
+        mDone = true;
+    }
+    mCond.notify_all ();
+}
+
+std::uint64_t
+LedgerDumpReader::readBlock (std::ifstream& in, std::uint64_t offset,
+                             Block& block)
+{
+    requireDump (offset + BLOCK_HEADER_SIZE <= mDataEnd, "truncated block");
+
+    Serializer header (readAt (in, offset, BLOCK_HEADER_SIZE));
+    SerializerIterator hit (header);
+    std::uint32_t const storedSize = hit.get32 ();
+    std::uint32_t const rawSize = hit.get32 ();
+    std::uint32_t const records = hit.get32 ();
+
+    offset += BLOCK_HEADER_SIZE;
+    requireDump (offset + storedSize <= mDataEnd, "truncated block");
+
+    Serializer data (readAt (in, offset, storedSize));
+
+    if (mCompressed)
+    {
+        char const* compressed = static_cast<char const*> (data.getDataPtr ());
+        std::size_t size;
+        requireDump (snappy::GetUncompressedLength (compressed, storedSize, &size)
+            && size == rawSize, "bad compressed block");
+
+        Serializer raw (rawSize);
+        raw.modData ().resize (rawSize);
+        requireDump (rawSize == 0 || snappy::RawUncompress (compressed, storedSize,
+            reinterpret_cast<char*> (&raw.modData ().front ())),
+            "bad compressed block");
+        data = std::move (raw);
+    }
+    else
+    {
+        requireDump (storedSize == rawSize, "bad block size");
+    }
+
+    SerializerIterator sit (data);
+    block.resize (records);
+    for (auto& record : block)
+    {
+        record.seq = sit.get32 ();
+        record.header = sit.getVL ();
+        std::uint32_t const txCount = sit.get32 ();
+        record.txs.resize (txCount);
+        for (auto& tx : record.txs)
+            tx = sit.getVL ();
+    }
+    requireDump (sit.empty (), "trailing bytes in block");
+
+    return offset + storedSize;
+}
+
+//------------------------------------------------------------------------------
+
+class LedgerDumpFile_test : public beast::unit_test::suite
+{
+public:
+    static LedgerDumpRecord makeRecord (LedgerSeq seq)
+    {
+        LedgerDumpRecord record;
+        record.seq = seq;
+        record.header.assign (118, static_cast<unsigned char> (seq));
+        for (LedgerSeq i = 0; i < seq % 7; ++i)
+            record.txs.push_back (Blob (100 + i * 37, static_cast<unsigned char> (i)));
+        return record;
+    }
+
+    bool sameRecord (LedgerDumpRecord const& a, LedgerDumpRecord const& b)
+    {
+        return a.seq == b.seq && a.header == b.header && a.txs == b.txs;
+    }
+
+    void testRoundTrip (bool compress)
+    {
+        testcase (compress ? "snappy" : "uncompressed");
+
+        beast::File const file (beast::File::createTempFile ("ledger_dump"));
+        std::string const path (file.getFullPathName ().toStdString ());
+
+        // Enough records to span several blocks, with a gap
+        LedgerSeq const first = 3;
+        LedgerSeq const last = 2000;
+        LedgerSeq const gap = 1000;
+
+        {
+            LedgerDumpWriter writer (path, compress);
+            for (LedgerSeq seq = first; seq <= last; ++seq)
+                if (seq != gap)
+                    writer.add (makeRecord (seq));
+            writer.finish ();
+        }
+
+        expect (LedgerDumpReader::isDumpFile (path), "Dump not recognized");
+
+        {
+            LedgerDumpReader reader (path);
+            expect (reader.isCompressed () == compress);
+            expect (reader.size () == last - first);
+
+            LedgerDumpRecord record;
+            LedgerSeq expected = first;
+            bool ok = true;
+            while (reader.next (record))
+            {
+                if (expected == gap)
+                    ++expected;
+                ok = ok && sameRecord (record, makeRecord (expected));
+                ++expected;
+            }
+            expect (ok, "Record mismatch");
+            expect (expected == last + 1, "Wrong record count");
+        }
+
+        {
+            LedgerDumpReader reader (path);
+            expect (!reader.seek (gap), "Seek to a missing ledger");
+            expect (!reader.seek (last + 1), "Seek past the end");
+            expect (reader.seek (1234), "Seek failed");
+
+            LedgerDumpRecord record;
+            expect (reader.next (record) && sameRecord (record, makeRecord (1234)));
+            expect (reader.next (record) && sameRecord (record, makeRecord (1235)));
+        }
+
+        {
+            // Abandoning a reader part way must not hang
+            LedgerDumpReader reader (path);
+            LedgerDumpRecord record;
+            expect (reader.next (record) && record.seq == first);
+        }
+
+        file.deleteFile ();
+    }
+
+    void run ()
+    {
+        testRoundTrip (false);
+        testRoundTrip (true);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerDumpFile,ripple_app,ripple);
+
+} // ripple
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_LEDGERDUMPFILE_H_INCLUDED
+#define RIPPLE_LEDGERDUMPFILE_H_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace ripple
+{
+    // The binary transaction-history dump written by --dump_transactions
+    // when --dump_format is "binary" or "snappy".
+    //
+    // The file is a header, a run of blocks, an index and a trailer:
+    //
+    //   header:  "SLDGDUMP", u32 version, u32 flags
+    //   block:   u32 stored size, u32 raw size, u32 record count, data
+    //   record:  u32 seq, VL ledger header, u32 tx count, VL tx...
+    //   index:   (u32 seq, u64 block offset) per ledger, ascending
+    //   trailer: u64 index offset, u64 ledger count, "SLDGINDX"
+    //
+    // Integers are big-endian and VL is the Serializer length prefix. The
+    // ledger header is the raw ledger with its hash prefix, transactions
+    // are serialized without metadata, in the order they were applied.
+    // Blocks hold whole records and, with the snappy flag, their data is
+    // snappy-compressed. Finding a ledger is a lookup in the index followed
+    // by a single block read.
+
+    // One ledger of a dump.
+    struct LedgerDumpRecord
+    {
+        LedgerSeq seq;
+        Blob header;
+        std::vector<Blob> txs;
+    };
+
+    // Writes a binary dump. Records must be added in ascending seq order.
+    class LedgerDumpWriter
+    {
+    public:
+        LedgerDumpWriter (std::string const& filename, bool compress);
+
+        void add (LedgerDumpRecord const& record);
+
+        // Writes the last block, the index and the trailer.
+        void finish ();
+
+    private:
+        void write (Serializer const& s);
+        void flushBlock ();
+
+        std::ofstream mOut;
+        bool mCompress;
+        bool mFinished;
+        std::uint64_t mOffset;
+
+        Serializer mBlock;
+        std::uint32_t mBlockRecords;
+
+        std::vector<std::pair<LedgerSeq, std::uint64_t>> mIndex;
+    };
+
+    // Reads a binary dump, decoding blocks on a background thread a few
+    // blocks ahead of the caller.
+    class LedgerDumpReader
+    {
+    public:
+        explicit LedgerDumpReader (std::string const& filename);
+        ~LedgerDumpReader ();
+
+        LedgerDumpReader (LedgerDumpReader const&) = delete;
+        LedgerDumpReader& operator= (LedgerDumpReader const&) = delete;
+
+        // Returns true if the file starts like a binary dump.
+        static bool isDumpFile (std::string const& filename);
+
+        bool isCompressed () const
+        {
+            return mCompressed;
+        }
+
+        // The number of ledgers in the dump.
+        std::size_t size () const
+        {
+            return mIndex.size ();
+        }
+
+        // Makes `seq` the next record returned. Only valid before the
+        // first call to next (). Returns false if the dump lacks `seq`.
+        bool seek (LedgerSeq seq);
+
+        // Returns false at the end of the dump.
+        bool next (LedgerDumpRecord& record);
+
+    private:
+        typedef std::vector<LedgerDumpRecord> Block;
+
+        void readAhead ();
+        std::uint64_t readBlock (std::ifstream& in, std::uint64_t offset,
+                                 Block& block);
+
+        std::string mFilename;
+        bool mCompressed;
+        std::uint64_t mDataEnd;
+        std::vector<std::pair<LedgerSeq, std::uint64_t>> mIndex;
+
+        // Where reading starts, and records before mSkipTo in that block
+        std::uint64_t mStart;
+        LedgerSeq mSkipTo;
+
+        std::thread mThread;
+        std::mutex mMutex;
+        std::condition_variable mCond;
+        std::deque<Block> mQueue;
+        bool mStarted;
+        bool mDone;
+        bool mStop;
+        std::string mError;
+
+        Block mCurrent;
+        std::size_t mCurrentPos;
+    };
+}
+
+#endif
@@ -86,6 +86,7 @@ void printHelp (const po::options_description& desc)
     cerr << "     connect <ip> [<port>]" << endl;
     cerr << "     consensus_info" << endl;
     cerr << "     get_counts" << endl;
+    cerr << "     job_latency [<job_type>]" << endl;
     cerr << "     json <method> <json>" << endl;
     cerr << "     ledger [<id>|current|closed|validated] [full]" << endl;
     cerr << "     ledger_accept" << endl;
@@ -99,6 +100,7 @@ void printHelp (const po::options_description& desc)
     cerr << "     proof_verify <token> <solution> [<difficulty>] [<secret>]" << endl;
     cerr << "     random" << endl;
     cerr << "     ripple ..." << endl;
+    cerr << "     slow_subscribers [<limit>]" << endl;
     cerr << "     static_path_find <json> [<ledger>]" << endl;
     //  cerr << "     send <seed> <paying_account> <account_id> <amount> [<currency>] [<send_max>] [<send_currency>]" << endl;
     cerr << "     stop" << endl;
@@ -198,7 +200,10 @@ int run (int argc, char** argv)
     ("load", "Load the current ledger from the local DB.")
     ("replay","Replay a ledger close.")
     ("dump_transactions", po::value <std::string> (), "Write a log of all transactions to a sequential file.")
+    ("dump_format", po::value <std::string> (), "Format for --dump_transactions: json (default), binary or snappy.")
     ("load_transactions", po::value <std::string> (), "Load and apply a log of transactions from a sequential file.")
+    ("replay_benchmark", po::value <std::string> (), "With --load_transactions, write per-ledger close timings to a file as JSON lines.")
+    ("replay_node_db", po::value <std::string> (), "With --load_transactions, use this node store type (e.g. Memory or Null) instead of [node_db].")
     ("dump_ledger", po::value <int> (), "Emit a ledger in full, including account-state.")
     ("ledger", po::value<std::string> (), "Load the specified ledger and start from .")
     ("start", "Start from a fresh Ledger.")
@@ -344,7 +349,9 @@ int run (int argc, char** argv)
         getConfig ().RUN_STANDALONE = true;
         getConfig ().START_UP = Config::LOAD;
         auto filename = vm["dump_transactions"].as<std::string> ();
-        LedgerDump::dumpTransactions (filename);
+        auto format = vm.count ("dump_format")
+            ? vm["dump_format"].as<std::string> () : std::string ("json");
+        LedgerDump::dumpTransactions (filename, format);
         return EXIT_SUCCESS;
     }
 
@@ -362,7 +369,12 @@ int run (int argc, char** argv)
         getConfig ().RUN_STANDALONE = true;
         getConfig ().START_UP = Config::FRESH;
         auto filename = vm["load_transactions"].as<std::string> ();
-        LedgerDump::loadTransactions (filename);
+        auto benchmark = vm.count ("replay_benchmark")
+            ? vm["replay_benchmark"].as<std::string> () : std::string ();
+        if (vm.count ("replay_node_db"))
+            getConfig ().nodeDatabase.set ("type",
+                vm["replay_node_db"].as<std::string> ());
+        LedgerDump::loadTransactions (filename, benchmark);
         return EXIT_SUCCESS;
     }
 
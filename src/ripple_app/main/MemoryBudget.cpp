@@ -0,0 +1,320 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+#include "../../beast/beast/chrono/manual_clock.h"
+
+namespace ripple {
+
+MemoryBudget::MemoryBudget (std::size_t budget,
+    beast::insight::Collector::ptr const& collector)
+    : m_budget (budget)
+    , m_collector (collector)
+    , m_total (collector->make_gauge ("memory", "total"))
+    , m_hook (collector->make_hook (
+        std::bind (&MemoryBudget::collect_metrics, this)))
+{
+}
+
+void MemoryBudget::add (std::string const& name, usage_type usage)
+{
+    addBytes (name, 0, usage, apply_type ());
+}
+
+void MemoryBudget::addBytes (std::string const& name, int share,
+    usage_type usage, apply_type apply)
+{
+    addEntries (name, share, usage, count_type (), apply);
+}
+
+void MemoryBudget::addEntries (std::string const& name, int share,
+    usage_type usage, count_type count, apply_type apply)
+{
+    Source source;
+    source.name = name;
+    source.share = std::max (0, share);
+    source.usage = usage;
+    source.count = count;
+    source.apply = apply;
+    source.bytes = 0;
+    source.budget = 0;
+    source.limit = 0;
+    source.gauge = m_collector->make_gauge ("memory", name);
+
+    std::lock_guard <std::mutex> lock (m_mutex);
+    m_sources.push_back (source);
+}
+
+void MemoryBudget::update ()
+{
+    if (m_budget == 0)
+        return;
+
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    measure ();
+
+    std::size_t untunable = 0;
+    std::size_t shares = 0;
+
+    for (auto const& source : m_sources)
+    {
+        if (source.share == 0)
+            untunable += source.bytes;
+        else
+            shares += source.share;
+    }
+
+    if (shares == 0)
+        return;
+
+    std::size_t const pool = (m_budget > untunable) ? (m_budget - untunable) : 0;
+
+    for (auto& source : m_sources)
+    {
+        if (source.share == 0)
+            continue;
+
+        source.budget = pool / shares * source.share;
+
+        std::size_t limit = source.budget;
+
+        if (source.count)
+        {
+            int const count = source.count ();
+
+            // Too few entries to judge their size by
+            if (count < minimumEntries)
+                continue;
+
+            limit = getTargetEntries (source.budget, source.bytes, count);
+        }
+
+        if (isSignificant (source.limit, limit))
+        {
+            source.apply (limit);
+            source.limit = limit;
+        }
+    }
+}
+
+Json::Value MemoryBudget::getJson ()
+{
+    Json::Value ret (Json::objectValue);
+
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    measure ();
+
+    std::size_t total = 0;
+
+    for (auto const& source : m_sources)
+    {
+        Json::Value& entry = ret[source.name];
+        entry["bytes"] = static_cast <double> (source.bytes);
+        total += source.bytes;
+
+        if ((m_budget != 0) && (source.share != 0))
+        {
+            entry["budget"] = static_cast <double> (source.budget);
+
+            if (source.count)
+                entry["target_size"] = static_cast <double> (source.limit);
+        }
+    }
+
+    ret["total"] = static_cast <double> (total);
+    ret["budget"] = static_cast <double> (m_budget);
+
+    return ret;
+}
+
+std::size_t MemoryBudget::getTargetEntries (std::size_t bytes,
+    std::size_t usage, int count)
+{
+    if ((count <= 0) || (usage == 0))
+        return minimumEntries;
+
+    std::size_t const perEntry = std::max <std::size_t> (1, usage / count);
+
+    return std::max <std::size_t> (minimumEntries, bytes / perEntry);
+}
+
+bool MemoryBudget::isSignificant (std::size_t current, std::size_t wanted)
+{
+    std::size_t const change = (wanted > current) ?
+        (wanted - current) : (current - wanted);
+
+    return (current == 0) ? (wanted != 0) : (change > current / 8);
+}
+
+void MemoryBudget::measure ()
+{
+    for (auto& source : m_sources)
+        source.bytes = source.usage ();
+}
+
+void MemoryBudget::collect_metrics ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    measure ();
+
+    std::size_t total = 0;
+
+    for (auto const& source : m_sources)
+    {
+        source.gauge.set (source.bytes);
+        total += source.bytes;
+    }
+
+    m_total.set (total);
+}
+
+//------------------------------------------------------------------------------
+
+class MemoryBudget_test : public beast::unit_test::suite
+{
+public:
+    void testShares ()
+    {
+        testcase ("shares");
+
+        MemoryBudget budget (1000000, beast::insight::NullCollector::New ());
+
+        std::size_t routerBytes = 200000;
+        std::size_t ledgerBytes = 0;
+        std::size_t ledgerBudget = 0;
+        std::size_t cacheTarget = 0;
+        int cacheCount = 1000;
+
+        budget.add ("router", [&] { return routerBytes; });
+
+        budget.addBytes ("ledgers", 1,
+            [&] { return ledgerBytes; },
+            [&] (std::size_t bytes) { ledgerBudget = bytes; });
+
+        // 1000 entries of 100 bytes each
+        budget.addEntries ("cache", 3,
+            [&] { return std::size_t (100) * cacheCount; },
+            [&] { return cacheCount; },
+            [&] (std::size_t target) { cacheTarget = target; });
+
+        budget.update ();
+        expect (ledgerBudget == 200000, "Wrong byte budget");
+        expect (cacheTarget == 6000, "Wrong target size");
+
+        // Small moves leave the limits alone
+        routerBytes = 210000;
+        budget.update ();
+        expect (ledgerBudget == 200000, "Retuned for a small change");
+        expect (cacheTarget == 6000, "Retuned for a small change");
+
+        // Large ones do not
+        routerBytes = 600000;
+        budget.update ();
+        expect (ledgerBudget == 100000, "Not retuned for a large change");
+        expect (cacheTarget == 3000, "Not retuned for a large change");
+
+        // Untunable use past the budget leaves the minimum
+        routerBytes = 2000000;
+        budget.update ();
+        expect (ledgerBudget == 0, "Budget left over");
+        expect (cacheTarget == MemoryBudget::minimumEntries,
+            "Target below the minimum");
+
+        Json::Value const json (budget.getJson ());
+        expect (json["total"].asDouble () == 2000000 + 100000, "Wrong total");
+        expect (json["cache"]["target_size"].asDouble () ==
+            MemoryBudget::minimumEntries, "Wrong target reported");
+    }
+
+    void testCache ()
+    {
+        testcase ("cache");
+
+        typedef ShardedTaggedCache <int, std::string> Cache;
+
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache cache ("test", 4096, 60, clock, j);
+
+        for (int i = 0; i < 4096; ++i)
+            cache.insert (i, std::to_string (i));
+
+        int const full (cache.getCacheSize ());
+        std::size_t const bytes (cache.getMemoryUsage ());
+
+        // Room for the cache twice over
+        MemoryBudget budget (2 * bytes, beast::insight::NullCollector::New ());
+        std::size_t other = 0;
+        budget.add ("other", [&] { return other; });
+        budget.addCache ("cache", 1, cache);
+
+        budget.update ();
+        expect (cache.getCacheSize () == full, "Evicted within budget");
+        int const target (cache.getTargetSize ());
+
+        // A wobble in what others hold changes nothing
+        other = bytes / 8;
+        budget.update ();
+        expect (cache.getTargetSize () == target, "Retuned for a small change");
+        expect (cache.getCacheSize () == full, "Evicted for a small change");
+
+        // Room for half of it evicts at once
+        other = 3 * bytes / 2;
+        budget.update ();
+        expect (cache.getTargetSize () < full * 9 / 16, "Target not lowered");
+        expect (cache.getCacheSize () <= cache.getTargetSize () + int (Cache::shardCount),
+            "Cache kept entries past its budget");
+    }
+
+    void testUnbudgeted ()
+    {
+        testcase ("unbudgeted");
+
+        MemoryBudget budget (0, beast::insight::NullCollector::New ());
+
+        bool applied = false;
+
+        budget.addBytes ("ledgers", 1,
+            [] { return std::size_t (5000); },
+            [&] (std::size_t) { applied = true; });
+
+        budget.update ();
+        expect (! applied, "Tuned without a budget");
+
+        Json::Value const json (budget.getJson ());
+        expect (json["ledgers"]["bytes"].asDouble () == 5000, "Wrong bytes");
+        expect (! json["ledgers"].isMember ("budget"), "Budget reported");
+    }
+
+    void run ()
+    {
+        testShares ();
+        testCache ();
+        testUnbudgeted ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryBudget,ripple_app,ripple);
+
+}
@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_MEMORYBUDGET_H_INCLUDED
+#define RIPPLE_MEMORYBUDGET_H_INCLUDED
+
+#include "../../beast/beast/Insight.h"
+
+#include <functional>
+#include <mutex>
+
+namespace ripple {
+
+/** Shares one memory budget between the caches.
+
+    Every source reports the bytes it holds, as estimated by the source.
+    Tunable sources also have a share: update() takes what the untunable
+    sources hold off the budget, splits the rest in proportion to the
+    shares, and hands each tunable source its part. A source limited by
+    entries rather than bytes gets a target size instead, worked out from
+    its current bytes per entry.
+
+    A limit is only changed when it moves by more than an eighth. The
+    bytes per entry, and so the limits worked out from them, wobble from
+    one measurement to the next, and a lower target can evict at once.
+    Following every wobble would evict entries only to let them back in.
+
+    With no budget the sources are measured but never retuned.
+*/
+class MemoryBudget
+{
+public:
+    typedef std::function <std::size_t ()> usage_type;
+    typedef std::function <int ()> count_type;
+    typedef std::function <void (std::size_t)> apply_type;
+
+    // Entry limits are never set below this
+    static int const minimumEntries = 256;
+
+    /** @param budget The total for the tunable sources, in bytes, or 0. */
+    MemoryBudget (std::size_t budget,
+        beast::insight::Collector::ptr const& collector);
+
+    MemoryBudget (MemoryBudget const&) = delete;
+    MemoryBudget& operator= (MemoryBudget const&) = delete;
+
+    /** Adds a source which is counted against the budget but not tuned. */
+    void add (std::string const& name, usage_type usage);
+
+    /** Adds a source limited by bytes.
+        @param apply Called with the source's part of the budget.
+    */
+    void addBytes (std::string const& name, int share,
+        usage_type usage, apply_type apply);
+
+    /** Adds a source limited by entries.
+        @param count Returns the number of entries held.
+        @param apply Called with the target number of entries.
+    */
+    void addEntries (std::string const& name, int share,
+        usage_type usage, count_type count, apply_type apply);
+
+    /** Adds a cache with getMemoryUsage, getCacheSize and setTargetSize. */
+    template <class Cache>
+    void addCache (std::string const& name, int share, Cache& cache)
+    {
+        addEntries (name, share,
+            [&cache] { return cache.getMemoryUsage (); },
+            [&cache] { return cache.getCacheSize (); },
+            [&cache] (std::size_t target) { cache.setTargetSize (int (target)); });
+    }
+
+    std::size_t getBudget () const
+    {
+        return m_budget;
+    }
+
+    /** Measures every source and retunes the tunable ones. */
+    void update ();
+
+    /** Bytes held by each source and the limits last set, for get_counts. */
+    Json::Value getJson ();
+
+    /** Returns the entries that fit in bytes at the given bytes per entry. */
+    static std::size_t getTargetEntries (std::size_t bytes,
+        std::size_t usage, int count);
+
+    /** Returns true if the change from current to wanted is worth making. */
+    static bool isSignificant (std::size_t current, std::size_t wanted);
+
+private:
+    struct Source
+    {
+        std::string name;
+        int share;              // 0 for untunable sources
+        usage_type usage;
+        count_type count;       // Empty for sources limited by bytes
+        apply_type apply;
+        std::size_t bytes;      // As last measured
+        std::size_t budget;     // Part of the budget last given
+        std::size_t limit;      // Limit last applied
+        beast::insight::Gauge gauge;
+    };
+
+    void measure ();
+    void collect_metrics ();
+
+    std::size_t const m_budget;
+    beast::insight::Collector::ptr m_collector;
+
+    std::mutex m_mutex;
+    std::vector <Source> m_sources;
+
+    beast::insight::Gauge m_total;
+    beast::insight::Hook m_hook;
+};
+
+}
+
+#endif
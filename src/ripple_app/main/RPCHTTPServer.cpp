@@ -156,8 +156,8 @@ public:
 
     void processSession (Job& job, HTTP::Session& session)
     {
-        session.write (m_deprecatedHandler.processRequest (
-            session.content(), session.remoteAddress().at_port(0)));
+        m_deprecatedHandler.processSession (session.content(),
+            session.remoteAddress().at_port(0), session);
 
         session.close();
     }
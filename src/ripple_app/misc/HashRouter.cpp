@@ -40,10 +40,9 @@ private:
             return mPeers;
         }
 
-        void addPeer (PeerShortID peer)
+        bool addPeer (PeerShortID peer)
         {
-            if (peer != 0)
-                mPeers.insert (peer);
+            return (peer != 0) && mPeers.insert (peer).second;
         }
         
         bool hasPeer (PeerShortID peer) const
@@ -84,6 +83,7 @@ private:
 public:
     explicit HashRouter (int holdTime)
         : mHoldTime (holdTime)
+        , mPeerCount (0)
     {
     }
 
@@ -97,6 +97,8 @@ public:
 
     bool swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag);
 
+    std::size_t getMemoryUsage ();
+
 private:
     Entry getEntry (uint256 const& );
 
@@ -107,19 +109,22 @@ private:
     LockType mLock;
 
     // Stores all suppressed hashes and their expiration time
-    ripple::unordered_map <uint256, Entry> mSuppressionMap;
+    ripple::unordered_map <uint256, Entry, uint256::uniform_hasher> mSuppressionMap;
 
     // Stores all expiration times and the hashes indexed for them
     std::map< int, std::list<uint256> > mSuppressionTimes;
 
     int mHoldTime;
+
+    // Peers over all entries, for the memory estimate
+    std::size_t mPeerCount;
 };
 
 //------------------------------------------------------------------------------
 
 HashRouter::Entry& HashRouter::findCreateEntry (uint256 const& index, bool& created)
 {
-    ripple::unordered_map<uint256, Entry>::iterator fit = mSuppressionMap.find (index);
+    auto fit = mSuppressionMap.find (index);
 
     if (fit != mSuppressionMap.end ())
     {
@@ -138,7 +143,15 @@ HashRouter::Entry& HashRouter::findCreateEntry (uint256 const& index, bool& crea
     if ((it != mSuppressionTimes.end ()) && (it->first <= expireTime))
     {
         BOOST_FOREACH (uint256 const & lit, it->second)
-        mSuppressionMap.erase (lit);
+        {
+            auto const expired = mSuppressionMap.find (lit);
+
+            if (expired != mSuppressionMap.end ())
+            {
+                mPeerCount -= expired->second.peekPeers ().size ();
+                mSuppressionMap.erase (expired);
+            }
+        }
         mSuppressionTimes.erase (it);
     }
 
@@ -168,7 +181,8 @@ bool HashRouter::addSuppressionPeer (uint256 const& index, PeerShortID peer)
     ScopedLockType sl (mLock);
 
     bool created;
-    findCreateEntry (index, created).addPeer (peer);
+    if (findCreateEntry (index, created).addPeer (peer))
+        ++mPeerCount;
     return created;
 }
 
@@ -178,7 +192,8 @@ bool HashRouter::addSuppressionPeer (uint256 const& index, PeerShortID peer, int
 
     bool created;
     Entry& s = findCreateEntry (index, created);
-    s.addPeer (peer);
+    if (s.addPeer (peer))
+        ++mPeerCount;
     flags = s.getFlags ();
     return created;
 }
@@ -231,12 +246,28 @@ bool HashRouter::swapSet (uint256 const& index, std::set<PeerShortID>& peers, in
     if ((s.getFlags () & flag) == flag)
         return false;
 
+    mPeerCount += peers.size ();
     s.swapSet (peers);
+    mPeerCount -= peers.size ();
     s.setFlag (flag);
 
     return true;
 }
 
+std::size_t HashRouter::getMemoryUsage ()
+{
+    // A map node and bucket, and a node in the expiration list
+    std::size_t const entryBytes = sizeof (uint256) + sizeof (Entry) +
+        2 * sizeof (void*) + sizeof (uint256) + 2 * sizeof (void*);
+
+    // A node in an entry's peer set
+    std::size_t const peerBytes = sizeof (PeerShortID) + 4 * sizeof (void*);
+
+    ScopedLockType sl (mLock);
+
+    return mSuppressionMap.size () * entryBytes + mPeerCount * peerBytes;
+}
+
 IHashRouter* IHashRouter::New (int holdTime)
 {
     return new HashRouter (holdTime);
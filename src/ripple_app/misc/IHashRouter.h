@@ -77,6 +77,9 @@ public:
 
     virtual bool swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag) = 0;
 
+    /** Returns the estimated bytes used by the table. */
+    virtual std::size_t getMemoryUsage () = 0;
+
     // VFALCO TODO This appears to be unused!
     //
 //    virtual Entry getEntry (uint256 const&) = 0;
@@ -1191,46 +1191,53 @@ void NetworkOPsImp::consensusViewChange ()
 
 void NetworkOPsImp::pubServer ()
 {
-    // VFALCO TODO Don't hold the lock across calls to send...make a copy of the
-    //             list into a local array while holding the lock then release the
-    //             lock and call send on everyone.
-    //
-    ScopedLockType sl (mLock);
+    SubscriberList subscribers;
+    Json::Value jvObj (Json::objectValue);
 
-    if (!mSubServer.empty ())
     {
-        Json::Value jvObj (Json::objectValue);
+        ScopedLockType sl (mLock);
+
+        collectSubscribers (mSubServer, subscribers);
+
+        if (subscribers.empty ())
+            return;
 
         jvObj [jss::type]          = "serverStatus";
         jvObj [jss::server_status] = strOperatingMode ();
         jvObj [jss::load_base]     = (mLastLoadBase = getApp().getFeeTrack ().getLoadBase ());
         jvObj [jss::load_factor]   = (mLastLoadFactor = getApp().getFeeTrack ().getLoadFactor ());
+    }
 
-        Json::FastWriter w;
-        std::string sObj = w.write (jvObj);
-
-        NetworkOPsImp::SubMapType::const_iterator it = mSubServer.begin ();
+    publish (subscribers, jvObj, InfoSub::encode (jvObj));
+}
 
-        while (it != mSubServer.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+void NetworkOPsImp::collectSubscribers (SubMapType& subMap, SubscriberList& list)
+{
+    SubMapType::const_iterator it = subMap.begin ();
 
-            // VFALCO TODO research the possibility of using thread queues and linearizing
-            //             the deletion of subscribers with the sending of JSON data.
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
+    while (it != subMap.end ())
+    {
+        InfoSub::pointer p = it->second.lock ();
 
-                ++it;
-            }
-            else
-            {
-                it = mSubServer.erase (it);
-            }
+        if (p)
+        {
+            list.push_back (p);
+            ++it;
+        }
+        else
+        {
+            it = subMap.erase (it);
         }
     }
 }
 
+void NetworkOPsImp::publish (SubscriberList const& list,
+    Json::Value const& jvObj, InfoSub::Payload const& payload)
+{
+    for (auto const& p : list)
+        p->send (jvObj, payload, true);
+}
+
 void NetworkOPsImp::setMode (OperatingMode om)
 {
 
@@ -1336,8 +1343,8 @@ NetworkOPsImp::getAccountTxs (const RippleAddress& account, std::int32_t minLedg
                       minLedger, maxLedger, descending, offset, limit, false, false, bAdmin);
 
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         SQL_FOREACH (db, sql)
         {
@@ -1386,8 +1393,8 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
                       minLedger, maxLedger, descending, offset, limit, true/*binary*/, false, bAdmin);
 
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         SQL_FOREACH (db, sql)
         {
@@ -1427,6 +1434,74 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
 }
 
 
+std::string
+accountTxPageSQL (const RippleAddress& account,
+                  std::uint32_t minLedger, std::uint32_t maxLedger,
+                  bool forward, std::uint32_t findLedger,
+                  std::uint32_t findSeq, std::uint32_t limit)
+{
+    // A page starts at the marker, the first row the previous page did not
+    // return. Seeking to it in AcctTxIndex (Account, LedgerSeq, TxnSeq,
+    // TransID) costs the same however deep the page is, where an OFFSET
+    // would walk every row before it.
+    std::string resumeClause;
+
+    if (findLedger != 0)
+    {
+        if (forward)
+            minLedger = std::max (minLedger, findLedger);
+        else
+            maxLedger = std::min (maxLedger, findLedger);
+
+        resumeClause = boost::str (boost::format
+            ("AND (AccountTransactions.LedgerSeq <> '%u' OR AccountTransactions.TxnSeq %s '%u') ")
+                % findLedger
+                % (forward ? ">=" : "<=")
+                % findSeq);
+    }
+
+    return boost::str (boost::format
+        ("SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,Status,RawTxn,TxnMeta "
+         "FROM AccountTransactions INNER JOIN Transactions ON Transactions.TransID = AccountTransactions.TransID "
+         "WHERE AccountTransactions.Account = '%s' AND AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' "
+         "%s"
+         "ORDER BY AccountTransactions.LedgerSeq %s, AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
+         "LIMIT %u;")
+             % account.humanAccountID()
+             % minLedger
+             % maxLedger
+             % resumeClause
+             % (forward ? "ASC" : "DESC")
+             % (forward ? "ASC" : "DESC")
+             % (forward ? "ASC" : "DESC")
+             % limit);
+}
+
+bool
+parseAccountTxMarker (Json::Value const& marker,
+                      std::uint32_t& findLedger, std::uint32_t& findSeq)
+{
+    if (!marker.isObject () ||
+        !marker.isMember (jss::ledger) || !marker.isMember (jss::seq))
+        return false;
+
+    // Both are written as ints, but may come back from a client unsigned
+    auto const isIndex = [] (Json::Value const& v)
+    {
+        return (v.isInt () || v.isUInt ()) &&
+            v.isConvertibleTo (Json::uintValue);
+    };
+
+    if (!isIndex (marker[jss::ledger]) || !isIndex (marker[jss::seq]))
+        return false;
+
+    findLedger = marker[jss::ledger].asUInt ();
+    findSeq = marker[jss::seq].asUInt ();
+
+    // No ledger has sequence 0, and 0 means no marker to the query
+    return findLedger != 0;
+}
+
 std::vector< std::pair<Transaction::pointer, TransactionMetaSet::pointer> >
 NetworkOPsImp::getTxsAccount (const RippleAddress& account, std::int32_t minLedger,
                               std::int32_t maxLedger, bool forward, Json::Value& token,
@@ -1435,9 +1510,8 @@ NetworkOPsImp::getTxsAccount (const RippleAddress& account, std::int32_t minLedg
     std::vector< std::pair<Transaction::pointer, TransactionMetaSet::pointer> > ret;
 
     std::uint32_t NONBINARY_PAGE_LENGTH = 200;
-    std::uint32_t EXTRA_LENGTH = 20;
 
-    bool foundResume = token.isNull() || !token.isObject();
+    bool const resume = !token.isNull();
 
     std::uint32_t numberOfResults, queryLimit;
     if (limit <= 0)
@@ -1446,53 +1520,26 @@ NetworkOPsImp::getTxsAccount (const RippleAddress& account, std::int32_t minLedg
         numberOfResults = NONBINARY_PAGE_LENGTH;
     else
         numberOfResults = limit;
-    queryLimit = numberOfResults + 1 + (foundResume ? 0 : EXTRA_LENGTH);
+    // One more than asked for, to find where the next page starts
+    queryLimit = numberOfResults + 1;
 
     std::uint32_t findLedger = 0, findSeq = 0;
-    if (!foundResume)
-    {
-        try
-        {
-            if (!token.isMember(jss::ledger) || !token.isMember(jss::seq))
-                return ret;
-            findLedger = token[jss::ledger].asInt();
-            findSeq = token[jss::seq].asInt();
-        }
-        catch (...)
-        {
-            return ret;
-        }
-    }
+    if (resume && !parseAccountTxMarker (token, findLedger, findSeq))
+        return ret;
 
     // ST NOTE We're using the token reference both for passing inputs and
     //         outputs, so we need to clear it in between.
     token = Json::nullValue;
 
-    std::string sql = boost::str (boost::format
-        ("SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,Status,RawTxn,TxnMeta "
-         "FROM AccountTransactions INNER JOIN Transactions ON Transactions.TransID = AccountTransactions.TransID "
-         "WHERE AccountTransactions.Account = '%s' AND AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' "
-         "ORDER BY AccountTransactions.LedgerSeq %s, AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-         "LIMIT %u;")
-             % account.humanAccountID()
-             % ((forward && (findLedger != 0)) ? findLedger : minLedger)
-             % ((!forward && (findLedger != 0)) ? findLedger: maxLedger)
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % queryLimit);
+    std::string sql = accountTxPageSQL (account, minLedger, maxLedger,
+        forward, findLedger, findSeq, queryLimit);
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         SQL_FOREACH (db, sql)
         {
-            if (!foundResume)
-            {
-                if ((findLedger == db->getInt("LedgerSeq")) && (findSeq == db->getInt("TxnSeq")))
-                    foundResume = true;
-            }
-            else if (numberOfResults == 0)
+            if (numberOfResults == 0)
             {
                 token = Json::objectValue;
                 token[jss::ledger] = db->getInt("LedgerSeq");
@@ -1500,37 +1547,34 @@ NetworkOPsImp::getTxsAccount (const RippleAddress& account, std::int32_t minLedg
                 break;
             }
 
-            if (foundResume)
-            {
-                Transaction::pointer txn = Transaction::transactionFromSQL (db, false);
+            Transaction::pointer txn = Transaction::transactionFromSQL (db, false);
 
-                Serializer rawMeta;
-                int metaSize = 2048;
+            Serializer rawMeta;
+            int metaSize = 2048;
+            rawMeta.resize (metaSize);
+            metaSize = db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
+
+            if (metaSize > rawMeta.getLength ())
+            {
+                rawMeta.resize (metaSize);
+                db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
+            }
+            else
                 rawMeta.resize (metaSize);
-                metaSize = db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
 
-                if (metaSize > rawMeta.getLength ())
-                {
-                    rawMeta.resize (metaSize);
-                    db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.getLength ());
-                }
-                else
-                    rawMeta.resize (metaSize);
-
-                if (rawMeta.getLength() == 0)
-                { // Work around a bug that could leave the metadata missing
-                    std::uint32_t seq = static_cast<std::uint32_t>(db->getBigInt("LedgerSeq"));
-                    m_journal.warning << "Recovering ledger " << seq << ", txn " << txn->getID();
-                    Ledger::pointer ledger = getLedgerBySeq(seq); // ???? this looks up in SQL... and we save it back in SQL afterwards?!
-                    if (ledger)
-                        ledger->pendSaveValidated(false, false);
-                }
+            if (rawMeta.getLength() == 0)
+            { // Work around a bug that could leave the metadata missing
+                std::uint32_t seq = static_cast<std::uint32_t>(db->getBigInt("LedgerSeq"));
+                m_journal.warning << "Recovering ledger " << seq << ", txn " << txn->getID();
+                Ledger::pointer ledger = getLedgerBySeq(seq); // ???? this looks up in SQL... and we save it back in SQL afterwards?!
+                if (ledger)
+                    ledger->pendSaveValidated(false, false);
+            }
 
-                --numberOfResults;
-                TransactionMetaSet::pointer meta = boost::make_shared<TransactionMetaSet> (txn->getID (), txn->getLedger (), rawMeta.getData ());
+            --numberOfResults;
+            TransactionMetaSet::pointer meta = boost::make_shared<TransactionMetaSet> (txn->getID (), txn->getLedger (), rawMeta.getData ());
 
-                ret.push_back (std::pair<Transaction::ref, TransactionMetaSet::ref> (txn, meta));
-            }
+            ret.push_back (std::pair<Transaction::ref, TransactionMetaSet::ref> (txn, meta));
         }
     }
 
@@ -1545,9 +1589,8 @@ NetworkOPsImp::getTxsAccountB (const RippleAddress& account, std::int32_t minLed
     std::vector<txnMetaLedgerType> ret;
 
     std::uint32_t BINARY_PAGE_LENGTH = 500;
-    std::uint32_t EXTRA_LENGTH = 20;
 
-    bool foundResume = token.isNull() || !token.isObject();
+    bool const resume = !token.isNull();
 
     std::uint32_t numberOfResults, queryLimit;
     if (limit <= 0)
@@ -1556,51 +1599,24 @@ NetworkOPsImp::getTxsAccountB (const RippleAddress& account, std::int32_t minLed
         numberOfResults = BINARY_PAGE_LENGTH;
     else
         numberOfResults = limit;
-    queryLimit = numberOfResults + 1 + (foundResume ? 0 : EXTRA_LENGTH);
+    // One more than asked for, to find where the next page starts
+    queryLimit = numberOfResults + 1;
 
     std::uint32_t findLedger = 0, findSeq = 0;
-    if (!foundResume)
-    {
-        try
-        {
-            if (!token.isMember(jss::ledger) || !token.isMember(jss::seq))
-                return ret;
-            findLedger = token[jss::ledger].asInt();
-            findSeq = token[jss::seq].asInt();
-        }
-        catch (...)
-        {
-            return ret;
-        }
-    }
+    if (resume && !parseAccountTxMarker (token, findLedger, findSeq))
+        return ret;
 
     token = Json::nullValue;
 
-    std::string sql = boost::str (boost::format
-        ("SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,Status,RawTxn,TxnMeta "
-         "FROM AccountTransactions INNER JOIN Transactions ON Transactions.TransID = AccountTransactions.TransID "
-         "WHERE AccountTransactions.Account = '%s' AND AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' "
-         "ORDER BY AccountTransactions.LedgerSeq %s, AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-         "LIMIT %u;")
-             % account.humanAccountID()
-             % ((forward && (findLedger != 0)) ? findLedger : minLedger)
-             % ((!forward && (findLedger != 0)) ? findLedger: maxLedger)
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % (forward ? "ASC" : "DESC")
-             % queryLimit);
+    std::string sql = accountTxPageSQL (account, minLedger, maxLedger,
+        forward, findLedger, findSeq, queryLimit);
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         SQL_FOREACH (db, sql)
         {
-            if (!foundResume)
-            {
-                if ((findLedger == db->getInt("LedgerSeq")) && (findSeq == db->getInt("TxnSeq")))
-                    foundResume = true;
-            }
-            else if (numberOfResults == 0)
+            if (numberOfResults == 0)
             {
                 token = Json::objectValue;
                 token[jss::ledger] = db->getInt("LedgerSeq");
@@ -1608,36 +1624,33 @@ NetworkOPsImp::getTxsAccountB (const RippleAddress& account, std::int32_t minLed
                 break;
             }
 
-            if (foundResume)
-            {
-                int txnSize = 2048;
-                Blob rawTxn (txnSize);
-                txnSize = db->getBinary ("RawTxn", &rawTxn[0], rawTxn.size ());
-
-                if (txnSize > rawTxn.size ())
-                {
-                    rawTxn.resize (txnSize);
-                    db->getBinary ("RawTxn", &*rawTxn.begin (), rawTxn.size ());
-                }
-                else
-                    rawTxn.resize (txnSize);
+            int txnSize = 2048;
+            Blob rawTxn (txnSize);
+            txnSize = db->getBinary ("RawTxn", &rawTxn[0], rawTxn.size ());
 
-                int metaSize = 2048;
-                Blob rawMeta (metaSize);
-                metaSize = db->getBinary ("TxnMeta", &rawMeta[0], rawMeta.size ());
+            if (txnSize > rawTxn.size ())
+            {
+                rawTxn.resize (txnSize);
+                db->getBinary ("RawTxn", &*rawTxn.begin (), rawTxn.size ());
+            }
+            else
+                rawTxn.resize (txnSize);
 
-                if (metaSize > rawMeta.size ())
-                {
-                    rawMeta.resize (metaSize);
-                    db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.size ());
-                }
-                else
-                    rawMeta.resize (metaSize);
+            int metaSize = 2048;
+            Blob rawMeta (metaSize);
+            metaSize = db->getBinary ("TxnMeta", &rawMeta[0], rawMeta.size ());
 
-                ret.push_back (std::make_tuple (
-                    strHex (rawTxn), strHex (rawMeta), db->getInt ("LedgerSeq")));
-                --numberOfResults;
+            if (metaSize > rawMeta.size ())
+            {
+                rawMeta.resize (metaSize);
+                db->getBinary ("TxnMeta", &*rawMeta.begin (), rawMeta.size ());
             }
+            else
+                rawMeta.resize (metaSize);
+
+            ret.push_back (std::make_tuple (
+                strHex (rawTxn), strHex (rawMeta), db->getInt ("LedgerSeq")));
+            --numberOfResults;
         }
     }
 
@@ -1654,8 +1667,8 @@ NetworkOPsImp::getLedgerAffectedAccounts (std::uint32_t ledgerSeq)
                            % ledgerSeq);
     RippleAddress acct;
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
         SQL_FOREACH (db, sql)
         {
             if (acct.setAccountID (db->getStrBinary ("Account")))
@@ -1873,25 +1886,20 @@ Json::Value NetworkOPsImp::pubBootstrapAccountInfo (Ledger::ref lpAccepted, cons
 
 void NetworkOPsImp::pubProposedTransaction (Ledger::ref lpCurrent, SerializedTransaction::ref stTxn, TER terResult)
 {
-    Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
+    SubscriberList subscribers;
 
     {
         ScopedLockType sl (mLock);
-        NetworkOPsImp::SubMapType::const_iterator it = mSubRTTransactions.begin ();
+        collectSubscribers (mSubRTTransactions, subscribers);
+    }
 
-        while (it != mSubRTTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+    if (! subscribers.empty ())
+    {
+        Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
 
-            if (p)
-            {
-                p->send (jvObj, true);
-                ++it;
-            }
-            else
-                it = mSubRTTransactions.erase (it);
-        }
+        publish (subscribers, jvObj, InfoSub::encode (jvObj));
     }
+
     AcceptedLedgerTx alt (stTxn, terResult);
     m_journal.trace << "pubProposed: " << alt.getJson ();
     pubAccountTransaction (lpCurrent, alt, false);
@@ -1905,43 +1913,33 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
     AcceptedLedger::pointer alpAccepted = AcceptedLedger::makeAcceptedLedger (accepted);
     Ledger::ref lpAccepted = alpAccepted->getLedger ();
 
+    SubscriberList subscribers;
+
     {
         ScopedLockType sl (mLock);
+        collectSubscribers (mSubLedger, subscribers);
+    }
 
-        if (!mSubLedger.empty ())
-        {
-            Json::Value jvObj (Json::objectValue);
-
-            jvObj[jss::type]           = jss::ledgerClosed;
-            jvObj[jss::ledger_index]   = lpAccepted->getLedgerSeq ();
-            jvObj[jss::ledger_hash]    = to_string (lpAccepted->getHash ());
-            jvObj[jss::ledger_time]    = Json::Value::UInt (lpAccepted->getCloseTimeNC ());
-
-            jvObj[jss::fee_ref]        = Json::UInt (lpAccepted->getReferenceFeeUnits ());
-            jvObj[jss::fee_base]       = Json::UInt (lpAccepted->getBaseFee ());
-            jvObj[jss::reserve_base]   = Json::UInt (lpAccepted->getReserve (0));
-            jvObj[jss::reserve_inc]    = Json::UInt (lpAccepted->getReserveInc ());
+    if (! subscribers.empty ())
+    {
+        Json::Value jvObj (Json::objectValue);
 
-            jvObj[jss::txn_count]      = Json::UInt (alpAccepted->getTxnCount ());
+        jvObj[jss::type]           = jss::ledgerClosed;
+        jvObj[jss::ledger_index]   = lpAccepted->getLedgerSeq ();
+        jvObj[jss::ledger_hash]    = to_string (lpAccepted->getHash ());
+        jvObj[jss::ledger_time]    = Json::Value::UInt (lpAccepted->getCloseTimeNC ());
 
-            if (mMode >= omSYNCING)
-                jvObj[jss::validated_ledgers]  = getApp().getLedgerMaster ().getCompleteLedgers ();
+        jvObj[jss::fee_ref]        = Json::UInt (lpAccepted->getReferenceFeeUnits ());
+        jvObj[jss::fee_base]       = Json::UInt (lpAccepted->getBaseFee ());
+        jvObj[jss::reserve_base]   = Json::UInt (lpAccepted->getReserve (0));
+        jvObj[jss::reserve_inc]    = Json::UInt (lpAccepted->getReserveInc ());
 
-            NetworkOPsImp::SubMapType::const_iterator it = mSubLedger.begin ();
+        jvObj[jss::txn_count]      = Json::UInt (alpAccepted->getTxnCount ());
 
-            while (it != mSubLedger.end ())
-            {
-                InfoSub::pointer p = it->second.lock ();
+        if (mMode >= omSYNCING)
+            jvObj[jss::validated_ledgers]  = getApp().getLedgerMaster ().getCompleteLedgers ();
 
-                if (p)
-                {
-                    p->send (jvObj, true);
-                    ++it;
-                }
-                else
-                    it = mSubLedger.erase (it);
-            }
-        }
+        publish (subscribers, jvObj, InfoSub::encode (jvObj));
     }
 
     // Don't lock since pubAcceptedTransaction is locking.
@@ -2003,43 +2001,22 @@ void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const Accep
     Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
     jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-    Json::FastWriter w;
-    std::string sObj = w.write (jvObj);
+    // Encoded once here and shared by the transaction streams and every
+    // order book stream the transaction touches.
+    InfoSub::Payload const payload (InfoSub::encode (jvObj));
+
+    SubscriberList subscribers;
 
     {
         ScopedLockType sl (mLock);
 
-        NetworkOPsImp::SubMapType::const_iterator it = mSubTransactions.begin ();
-
-        while (it != mSubTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
-
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
-                ++it;
-            }
-            else
-                it = mSubTransactions.erase (it);
-        }
-
-        it = mSubRTTransactions.begin ();
+        collectSubscribers (mSubTransactions, subscribers);
+        collectSubscribers (mSubRTTransactions, subscribers);
+    }
 
-        while (it != mSubRTTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+    publish (subscribers, jvObj, payload);
 
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
-                ++it;
-            }
-            else
-                it = mSubRTTransactions.erase (it);
-        }
-    }
-    getApp().getOrderBookDB ().processTxn (alAccepted, alTx, jvObj);
+    getApp().getOrderBookDB ().processTxn (alAccepted, alTx, jvObj, payload);
     pubAccountTransaction (alAccepted, alTx, true);
 }
 
@@ -2117,12 +2094,11 @@ void NetworkOPsImp::pubAccountTransaction (Ledger::ref lpCurrent, const Accepted
         if (alTx.isApplied ())
             jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-        Json::FastWriter w;
-        std::string sObj = w.write (jvObj);
+        InfoSub::Payload const payload (InfoSub::encode (jvObj));
 
         BOOST_FOREACH (InfoSub::ref isrListener, notify)
         {
-            isrListener->send (jvObj, sObj, true);
+            isrListener->send (jvObj, payload, true);
         }
     }
 }
@@ -2372,6 +2348,72 @@ InfoSub::pointer NetworkOPsImp::addRpcSub (const std::string& strUrl, InfoSub::r
     return rspEntry;
 }
 
+Json::Value NetworkOPsImp::getSlowSubscribers (int limit)
+{
+    SubscriberList subscribers;
+
+    {
+        ScopedLockType sl (mLock);
+
+        collectSubscribers (mSubLedger, subscribers);
+        collectSubscribers (mSubServer, subscribers);
+        collectSubscribers (mSubTransactions, subscribers);
+        collectSubscribers (mSubRTTransactions, subscribers);
+
+        for (auto& account : mSubAccount)
+            collectSubscribers (account.second, subscribers);
+
+        for (auto& account : mSubRTAccount)
+            collectSubscribers (account.second, subscribers);
+
+        for (auto const& rpcSub : mRpcSubMap)
+            subscribers.push_back (rpcSub.second);
+    }
+
+    // A client with several subscriptions is reported once
+    std::sort (subscribers.begin (), subscribers.end ());
+    subscribers.erase (std::unique (subscribers.begin (), subscribers.end ()),
+        subscribers.end ());
+
+    typedef std::pair <InfoSub::Backlog, InfoSub::pointer> Entry;
+    std::vector <Entry> entries;
+    entries.reserve (subscribers.size ());
+
+    for (auto const& sub : subscribers)
+        entries.emplace_back (sub->getBacklog (), sub);
+
+    std::sort (entries.begin (), entries.end (),
+        [](Entry const& lhs, Entry const& rhs)
+        {
+            if (lhs.first.bytes != rhs.first.bytes)
+                return lhs.first.bytes > rhs.first.bytes;
+            return lhs.first.dropped > rhs.first.dropped;
+        });
+
+    Json::Value ret (Json::objectValue);
+    Json::Value& list = (ret["subscribers"] = Json::arrayValue);
+
+    ret["count"] = static_cast <Json::UInt> (entries.size ());
+
+    for (auto const& entry : entries)
+    {
+        if (list.size () >= static_cast <Json::UInt> (limit))
+            break;
+
+        InfoSub::Backlog const& backlog (entry.first);
+        Json::Value& sub (list.append (Json::objectValue));
+
+        sub["address"]          = entry.second->getConsumer ().to_string ();
+        sub["queued_messages"]  = static_cast <Json::UInt> (backlog.messages);
+        sub["queued_bytes"]     = static_cast <Json::UInt> (backlog.bytes);
+        sub["peak_bytes"]       = static_cast <Json::UInt> (backlog.peakBytes);
+        sub["sent"]             = static_cast <Json::UInt> (backlog.sent);
+        sub["dropped"]          = static_cast <Json::UInt> (backlog.dropped);
+    }
+
+    return ret;
+}
+
 #ifndef USE_NEW_BOOK_PAGE
 // NIKB FIXME this should be looked at. There's no reason why this shouldn't
 //            work, but it demonstrated poor performance.
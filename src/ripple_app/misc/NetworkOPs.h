@@ -265,6 +265,9 @@ public:
     virtual Json::Value getServerInfo (bool human, bool admin) = 0;
     virtual void clearLedgerFetch () = 0;
     virtual Json::Value getLedgerFetchInfo () = 0;
+
+    /** Returns the stream subscribers with the largest outbound backlogs. */
+    virtual Json::Value getSlowSubscribers (int limit) = 0;
     virtual std::uint32_t acceptLedger () = 0;
 
     typedef ripple::unordered_map <uint160, std::list<LedgerProposal::pointer> > Proposals;
@@ -319,6 +322,20 @@ public:
         SerializedTransaction::ref stTxn, TER terResult) = 0;
 };
 
+/** Query for the page of an account's transactions starting at a marker,
+    (findLedger, findSeq), or at the first one when findLedger is 0.
+    Pages are ordered by (LedgerSeq, TxnSeq, TransID) in either direction.
+*/
+std::string accountTxPageSQL (const RippleAddress& account,
+    std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+    std::uint32_t findLedger, std::uint32_t findSeq, std::uint32_t limit);
+
+/** Read a marker that account_tx returned.
+    @return `false` if the marker is not in the form account_tx returns it
+*/
+bool parseAccountTxMarker (Json::Value const& marker,
+    std::uint32_t& findLedger, std::uint32_t& findSeq);
+
 } // ripple
 
 #endif
@@ -307,6 +307,7 @@ namespace ripple {
 		Json::Value getServerInfo(bool human, bool admin);
 		void clearLedgerFetch();
 		Json::Value getLedgerFetchInfo();
+		Json::Value getSlowSubscribers(int limit);
 		std::uint32_t acceptLedger();
 		ripple::unordered_map < uint160,
 			std::list<LedgerProposal::pointer> > & peekStoredProposals()
@@ -428,6 +429,19 @@ namespace ripple {
 
 		void pubServer();
 
+	private:
+		typedef std::vector <InfoSub::pointer> SubscriberList;
+
+		// Appends the live subscribers in the map to the list, erasing any
+		// that have gone away. The caller must hold mLock.
+		static void collectSubscribers(SubMapType& subMap, SubscriberList& list);
+
+		// Sends an encoded event to each subscriber in the list. This is
+		// called without holding mLock, so a slow subscriber can't stall
+		// other publishers or the subscription calls.
+		static void publish(SubscriberList const& list, Json::Value const& jvObj,
+			InfoSub::Payload const& payload);
+
 	private:
 		clock_type& m_clock;
 
@@ -484,7 +498,7 @@ namespace ripple {
 		SubMapType                                          mSubTransactions;       // all accepted transactions
 		SubMapType                                          mSubRTTransactions;     // all proposed and accepted transactions
 
-		TaggedCache< uint256, Blob>                         mFetchPack;
+		TaggedCache< uint256, Blob, uint256::uniform_hasher> mFetchPack;
 		std::uint32_t                                       mFetchSeq;
 
 		std::uint32_t                                       mLastLoadBase;
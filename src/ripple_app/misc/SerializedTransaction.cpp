@@ -73,6 +73,8 @@ SerializedTransaction::SerializedTransaction (SerializerIterator& sit) : STObjec
         throw std::runtime_error ("Transaction length invalid");
     }
 
+    SerializedArena::Scope arena (length);
+
     set (sit);
     mType = static_cast<TxType> (getFieldU16 (sfTransactionType));
 
@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include "../../beast/beast/unit_test/suite.h"
+
 namespace ripple {
 
 class ValidationsImp;
@@ -24,46 +26,113 @@ class ValidationsImp;
 SETUP_LOG (Validations)
 
 typedef std::map<uint160, SerializedValidation::pointer>::value_type u160_val_pair;
-typedef boost::shared_ptr<ValidationSet> VSpointer;
 
 class ValidationsImp : public Validations
 {
 private:
+    friend class Validations_test;
+
     typedef RippleMutex LockType;
     typedef std::lock_guard <LockType> ScopedLockType;
     typedef beast::GenericScopedUnlock <LockType> ScopedUnlockType;
+
+    // The validations for one ledger. The totals are kept as validations
+    // are added, so quorum checks read them without taking any lock.
+    struct LedgerValidations
+    {
+        LedgerValidations ()
+            : trusted (0)
+            , full (0)
+            , withFee (0)
+            , feeTotal (0)
+        {
+        }
+
+        LockType lock;                          // Guards set
+        ValidationSet set;
+
+        std::atomic <int> trusted;
+        std::atomic <int> full;                 // Trusted and full
+        std::atomic <int> withFee;              // Trusted with a load fee
+        std::atomic <std::uint64_t> feeTotal;   // Sum of those fees
+    };
+
+    typedef boost::shared_ptr <LedgerValidations> VSpointer;
+
+    // Guards the current validations and the write queue
     LockType mLock;
 
-    TaggedCache<uint256, ValidationSet>     mValidations;
+    TaggedCache<uint256, LedgerValidations, uint256::uniform_hasher> mValidations;
     ripple::unordered_map<uint160, SerializedValidation::pointer>   mCurrentValidations;
     std::vector<SerializedValidation::pointer>                      mStaleValidations;
 
     bool mWriting;
+    bool const mSave;
 
 private:
-    boost::shared_ptr<ValidationSet> findCreateSet (uint256 const& ledgerHash)
+    VSpointer findCreateSet (uint256 const& ledgerHash)
     {
         VSpointer j = mValidations.fetch (ledgerHash);
 
         if (!j)
         {
-            j = boost::make_shared<ValidationSet> ();
+            j = boost::make_shared<LedgerValidations> ();
             mValidations.canonicalize (ledgerHash, j);
         }
 
         return j;
     }
 
-    boost::shared_ptr<ValidationSet> findSet (uint256 const& ledgerHash)
+    VSpointer findSet (uint256 const& ledgerHash)
     {
         return mValidations.fetch (ledgerHash);
     }
 
+    // Returns false if the node already validated this ledger
+    static bool insert (LedgerValidations& entry, uint160 const& node,
+        SerializedValidation::ref val)
+    {
+        {
+            ScopedLockType sl (entry.lock);
+
+            if (!entry.set.insert (std::make_pair (node, val)).second)
+                return false;
+        }
+
+        if (val->isTrusted ())
+        {
+            ++entry.trusted;
+
+            if (val->isFull ())
+                ++entry.full;
+
+            if (val->isFieldPresent (sfLoadFee))
+            {
+                ++entry.withFee;
+                entry.feeTotal += val->getFieldU32 (sfLoadFee);
+            }
+        }
+
+        return true;
+    }
+
+    // Queues a validation that is no longer current to be saved.
+    // Called with mLock held.
+    void retire (SerializedValidation::ref val)
+    {
+        if (!mSave)
+            return;
+
+        mStaleValidations.push_back (val);
+        condWrite ();
+    }
+
 public:
     ValidationsImp ()
         : mValidations ("Validations", 128, 600, get_seconds_clock (),
             LogPartition::getJournal <TaggedCacheLog> ())
         , mWriting (false)
+        , mSave (getConfig ().SAVE_VALIDATIONS)
     {
         mStaleValidations.reserve (512);
     }
@@ -96,11 +165,11 @@ private:
 
         if (val->isTrusted () && isCurrent)
         {
-            ScopedLockType sl (mLock);
-
-            if (!findCreateSet (hash)->insert (std::make_pair (node, val)).second)
+            if (!insert (*findCreateSet (hash), node, val))
                 return false;
 
+            ScopedLockType sl (mLock);
+
             auto it = mCurrentValidations.find (node);
 
             if (it == mCurrentValidations.end ())
@@ -117,9 +186,8 @@ private:
             {
                 // This is a newer validation
                 val->setPreviousHash (it->second->getLedgerHash ());
-                mStaleValidations.push_back (it->second);
+                retire (it->second);
                 it->second = val;
-                condWrite ();
             }
             else
             {
@@ -149,26 +217,27 @@ private:
 
     ValidationSet getValidations (uint256 const& ledger)
     {
-        {
-            ScopedLockType sl (mLock);
-            VSpointer set = findSet (ledger);
+        VSpointer set = findSet (ledger);
 
-            if (set)
-                return *set;
+        if (set)
+        {
+            ScopedLockType sl (set->lock);
+            return set->set;
         }
+
         return ValidationSet ();
     }
 
     void getValidationCount (uint256 const& ledger, bool currentOnly, int& trusted, int& untrusted)
     {
         trusted = untrusted = 0;
-        ScopedLockType sl (mLock);
         VSpointer set = findSet (ledger);
 
         if (set)
         {
             std::uint32_t now = getApp().getOPs ().getNetworkTimeNC ();
-            BOOST_FOREACH (u160_val_pair & it, *set)
+            ScopedLockType sl (set->lock);
+            BOOST_FOREACH (u160_val_pair & it, set->set)
             {
                 bool isTrusted = it.second->isTrusted ();
 
@@ -197,21 +266,12 @@ private:
     void getValidationTypes (uint256 const& ledger, int& full, int& partial)
     {
         full = partial = 0;
-        ScopedLockType sl (mLock);
         VSpointer set = findSet (ledger);
 
         if (set)
         {
-            BOOST_FOREACH (u160_val_pair & it, *set)
-            {
-                if (it.second->isTrusted ())
-                {
-                    if (it.second->isFull ())
-                        ++full;
-                    else
-                        ++partial;
-                }
-            }
+            full = set->full;
+            partial = set->trusted - full;
         }
 
         WriteLog (lsTRACE, Validations) << "VC: " << ledger << "f:" << full << " p:" << partial;
@@ -220,20 +280,9 @@ private:
 
     int getTrustedValidationCount (uint256 const& ledger)
     {
-        int trusted = 0;
-        ScopedLockType sl (mLock);
         VSpointer set = findSet (ledger);
 
-        if (set)
-        {
-            BOOST_FOREACH (u160_val_pair & it, *set)
-            {
-                if (it.second->isTrusted ())
-                    ++trusted;
-            }
-        }
-
-        return trusted;
+        return set ? int (set->trusted) : 0;
     }
 
     int getFeeAverage (uint256 const& ledger, std::uint64_t ref, std::uint64_t& fee)
@@ -241,22 +290,14 @@ private:
         int trusted = 0;
         fee = 0;
 
-        ScopedLockType sl (mLock);
         VSpointer set = findSet (ledger);
 
         if (set)
         {
-            BOOST_FOREACH (u160_val_pair & it, *set)
-            {
-                if (it.second->isTrusted ())
-                {
-                    ++trusted;
-                    if (it.second->isFieldPresent(sfLoadFee))
-                        fee += it.second->getFieldU32(sfLoadFee);
-                    else
-                        fee += ref;
-                 }
-            }
+            // Validations without a load fee count at the reference fee
+            trusted = set->trusted;
+            int const withFee = set->withFee;
+            fee = set->feeTotal + std::uint64_t (std::max (0, trusted - withFee)) * ref;
         }
 
         if (trusted == 0)
@@ -316,9 +357,7 @@ private:
             else if (it->second->getSignTime () < cutoff)
             {
                 // contains a stale record
-                mStaleValidations.push_back (it->second);
-                it->second.reset ();
-                condWrite ();
+                retire (it->second);
                 it = mCurrentValidations.erase (it);
             }
             else
@@ -353,9 +392,7 @@ private:
             else if (it->second->getSignTime () < cutoff)
             {
                 // contains a stale record
-                mStaleValidations.push_back (it->second);
-                it->second.reset ();
-                condWrite ();
+                retire (it->second);
                 it = mCurrentValidations.erase (it);
             }
             else
@@ -387,22 +424,15 @@ private:
 
     void flush ()
     {
-        bool anyNew = false;
-
         WriteLog (lsINFO, Validations) << "Flushing validations";
         ScopedLockType sl (mLock);
         BOOST_FOREACH (u160_val_pair & it, mCurrentValidations)
         {
             if (it.second)
-                mStaleValidations.push_back (it.second);
-
-            anyNew = true;
+                retire (it.second);
         }
         mCurrentValidations.clear ();
 
-        if (anyNew)
-            condWrite ();
-
         while (mWriting)
         {
             ScopedUnlockType sul (mLock);
@@ -422,11 +452,11 @@ private:
                                        BIND_TYPE (&ValidationsImp::doWrite, this, P_1));
     }
 
+    // One write job runs at a time. It takes whatever has queued up while
+    // the previous batch was being written, so batches grow with the load.
     void doWrite (Job&)
     {
         LoadEvent::autoptr event (getApp().getJobQueue ().getLoadEventAP (jtDISK, "ValidationWrite"));
-        boost::format insVal ("INSERT INTO Validations "
-                              "(LedgerHash,NodePubKey,SignTime,RawData) VALUES ('%s','%s','%u',%s);");
 
         ScopedLockType sl (mLock);
         assert (mWriting);
@@ -439,35 +469,78 @@ private:
 
             {
                 ScopedUnlockType sul (mLock);
-                {
-                    Database* db = getApp().getLedgerDB ()->getDB ();
-                    DeprecatedScopedLock dbl (getApp().getLedgerDB ()->getDBLock ());
-
-                    Serializer s (1024);
-                    bool tx_ok = db->executeSQL("BEGIN TRANSACTION;");
-                    if (tx_ok)
-                    {
-                        BOOST_FOREACH (SerializedValidation::ref it, vector)
-                        {
-                            s.erase ();
-                            it->add (s);
-                            db->executeSQL (boost::str (
-                                insVal % to_string (it->getLedgerHash ()) %
-                                it->getSignerPublic ().humanNodePublic () %
-                                it->getSignTime () % sqlEscape (s.peekData ())));
-                        }
-                        tx_ok = db->executeSQL ("END TRANSACTION;");
-                    }
-                }
+                save (vector);
             }
         }
 
         mWriting = false;
     }
 
+    // Writes one batch in a single transaction
+    static void save (std::vector<SerializedValidation::pointer> const& batch)
+    {
+        struct Row
+        {
+            std::string ledgerHash;
+            std::string nodePubKey;
+            std::uint32_t signTime;
+            Blob raw;
+        };
+
+        // Serialize before taking the database lock
+        std::vector<Row> rows;
+        rows.reserve (batch.size ());
+
+        BOOST_FOREACH (SerializedValidation::ref it, batch)
+        {
+            Serializer s (1024);
+            it->add (s);
+
+            Row row;
+            row.ledgerHash = to_string (it->getLedgerHash ());
+            row.nodePubKey = it->getSignerPublic ().humanNodePublic ();
+            row.signTime = it->getSignTime ();
+            row.raw.swap (s.modData ());
+            rows.push_back (std::move (row));
+        }
+
+        Database* db = getApp().getLedgerDB ()->getDB ();
+        DeprecatedScopedLock dbl (getApp().getLedgerDB ()->getDBLock ());
+
+        if (!db->executeSQL ("BEGIN TRANSACTION;"))
+            return;
+
+        try
+        {
+            SqliteStatement& insert = db->getSqliteDB ()->getStatement (
+                "INSERT INTO Validations "
+                "(LedgerHash,NodePubKey,SignTime,RawData) VALUES (?,?,?,?);");
+
+            for (auto const& row : rows)
+            {
+                insert.bindStatic (1, row.ledgerHash);
+                insert.bindStatic (2, row.nodePubKey);
+                insert.bind (3, row.signTime);
+                insert.bindStatic (4, row.raw);
+
+                int const rc = insert.step ();
+
+                if (!insert.isDone (rc))
+                    WriteLog (lsWARNING, Validations) << "Save failed: " << insert.getError (rc);
+
+                insert.reset ();
+            }
+        }
+        catch (int error)
+        {
+            WriteLog (lsWARNING, Validations) << "Save failed to prepare: " << error;
+        }
+
+        db->executeSQL ("END TRANSACTION;");
+    }
+
     void sweep ()
     {
-        ScopedLockType sl (mLock);
         mValidations.sweep ();
     }
 };
@@ -477,4 +550,176 @@ Validations* Validations::New ()
     return new ValidationsImp;
 }
 
+//------------------------------------------------------------------------------
+
+class Validations_test : public beast::unit_test::suite
+{
+public:
+    static SerializedValidation::pointer makeValidation (uint256 const& ledger,
+        int node, bool trusted, bool full, std::uint32_t loadFee = 0)
+    {
+        RippleAddress const nodePublic = RippleAddress::createNodePublic (
+            RippleAddress::createSeedGeneric ("node" + std::to_string (node)));
+
+        SerializedValidation::pointer val = boost::make_shared <SerializedValidation> (
+            ledger, 100, nodePublic, full);
+
+        if (trusted)
+            val->setTrusted ();
+
+        if (loadFee != 0)
+            val->setFieldU32 (sfLoadFee, loadFee);
+
+        return val;
+    }
+
+    static uint256 ledgerHash (std::uint32_t seq)
+    {
+        Serializer s;
+        s.add32 (seq);
+        return s.getSHA512Half ();
+    }
+
+    static bool add (ValidationsImp& validations, SerializedValidation::ref val)
+    {
+        return ValidationsImp::insert (
+            *validations.findCreateSet (val->getLedgerHash ()),
+                val->getNodeID (), val);
+    }
+
+    // Checks the kept totals against a walk of the set, the way
+    // they were computed before the totals were kept
+    void expectTotals (Validations& validations, uint256 const& ledger,
+        std::uint64_t ref)
+    {
+        int trusted = 0;
+        int full = 0;
+        int partial = 0;
+        std::uint64_t fee = 0;
+
+        BOOST_FOREACH (u160_val_pair const& it, validations.getValidations (ledger))
+        {
+            if (!it.second->isTrusted ())
+                continue;
+
+            ++trusted;
+
+            if (it.second->isFull ())
+                ++full;
+            else
+                ++partial;
+
+            if (it.second->isFieldPresent (sfLoadFee))
+                fee += it.second->getFieldU32 (sfLoadFee);
+            else
+                fee += ref;
+        }
+
+        if (trusted == 0)
+            fee = ref;
+        else
+            fee /= trusted;
+
+        expect (validations.getTrustedValidationCount (ledger) == trusted,
+            "Trusted count mismatch");
+
+        int gotFull = -1;
+        int gotPartial = -1;
+        validations.getValidationTypes (ledger, gotFull, gotPartial);
+        expect (gotFull == full, "Full count mismatch");
+        expect (gotPartial == partial, "Partial count mismatch");
+
+        std::uint64_t gotFee = 0;
+        expect (validations.getFeeAverage (ledger, ref, gotFee) == trusted,
+            "Fee average count mismatch");
+        expect (gotFee == fee, "Fee average mismatch");
+    }
+
+    void testTotals ()
+    {
+        testcase ("totals");
+
+        ValidationsImp imp;
+        Validations& validations (imp);
+
+        uint256 const ledger (ledgerHash (1));
+        uint256 const other (ledgerHash (2));
+        std::uint64_t const ref = 256;
+
+        expectTotals (validations, ledger, ref);
+
+        expect (add (imp, makeValidation (ledger, 1, true, true)));
+        expectTotals (validations, ledger, ref);
+
+        expect (add (imp, makeValidation (ledger, 2, true, false)));
+        expect (add (imp, makeValidation (ledger, 3, true, true, 1000)));
+        expect (add (imp, makeValidation (ledger, 4, true, false, 333)));
+        expect (add (imp, makeValidation (ledger, 5, false, true, 5000)));
+        expect (add (imp, makeValidation (other, 6, true, true, 9000)));
+        expectTotals (validations, ledger, ref);
+        expectTotals (validations, other, ref);
+
+        expect (validations.getTrustedValidationCount (ledger) == 4);
+        expect (validations.getValidations (ledger).size () == 5);
+
+        // A second validation from the same node changes nothing
+        expect (! add (imp, makeValidation (ledger, 3, true, false, 7000)),
+            "Duplicate inserted");
+        expect (! add (imp, makeValidation (ledger, 2, true, true)),
+            "Duplicate inserted");
+        expectTotals (validations, ledger, ref);
+        expect (validations.getTrustedValidationCount (ledger) == 4);
+
+        std::uint64_t fee = 0;
+        validations.getFeeAverage (ledger, ref, fee);
+        expect (fee == (ref + ref + 1000 + 333) / 4);
+    }
+
+    void testSave ()
+    {
+        testcase ("save");
+
+        bool const save = getConfig ().SAVE_VALIDATIONS;
+
+        uint256 const ledger (ledgerHash (3));
+        SerializedValidation::pointer const val (
+            makeValidation (ledger, 1, true, true));
+
+        {
+            getConfig ().SAVE_VALIDATIONS = false;
+            ValidationsImp imp;
+
+            ValidationsImp::ScopedLockType sl (imp.mLock);
+            imp.retire (val);
+            expect (imp.mStaleValidations.empty (), "Queued with saving off");
+            expect (! imp.mWriting, "Write started with saving off");
+        }
+
+        {
+            getConfig ().SAVE_VALIDATIONS = true;
+            ValidationsImp imp;
+
+            ValidationsImp::ScopedLockType sl (imp.mLock);
+
+            // Stand in for a running write so no job is posted
+            imp.mWriting = true;
+            imp.retire (val);
+            expect (imp.mStaleValidations.size () == 1, "Not queued with saving on");
+
+            imp.mStaleValidations.clear ();
+            imp.mWriting = false;
+        }
+
+        getConfig ().SAVE_VALIDATIONS = save;
+    }
+
+    void run ()
+    {
+        testTotals ();
+        testSave ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Validations,ripple_app,ripple);
+
 } // ripple
@@ -106,6 +106,7 @@ bool PathRequest::needsUpdate (bool newOnly, LedgerIndex index)
     }
 
     mInProgress = true;
+    mLastIndex = index;
     return true;
 }
 
@@ -67,6 +67,11 @@ public:
     Json::Value doUpdate (const boost::shared_ptr<RippleLineCache>&, bool fast); // update jvStatus
     InfoSub::pointer getSubscriber ();
 
+    int getIdentifier () const
+    {
+        return iIdentifier;
+    }
+
 private:
     void setValid ();
     void resetLevel (int level);
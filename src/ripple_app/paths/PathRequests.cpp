@@ -17,6 +17,10 @@
 */
 //==============================================================================
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace ripple {
 
 /** Get the current RippleLineCache, updating it if necessary.
@@ -35,7 +39,17 @@ RippleLineCache::pointer PathRequests::getLineCache (Ledger::pointer& ledger, bo
          (lgrSeq > (lineSeq + 8)))                         // we jumped way forward for some reason
     {
         ledger = boost::make_shared<Ledger>(*ledger, false); // Take a snapshot of the ledger
-        mLineCache = boost::make_shared<RippleLineCache> (ledger);
+        RippleLineCache::pointer cache = boost::make_shared<RippleLineCache> (ledger);
+
+        boost::unordered_set<uint160> changed;
+        if (mLineCache && getChangedAccounts (mLineCache->getLedger (), ledger, changed))
+        {
+            int const kept = cache->inherit (*mLineCache, changed);
+            mJournal.debug << "Line cache for " << lgrSeq << " kept " << kept <<
+                " accounts, " << changed.size () << " changed";
+        }
+
+        mLineCache = cache;
     }
     else
     {
@@ -44,6 +58,67 @@ RippleLineCache::pointer PathRequests::getLineCache (Ledger::pointer& ledger, bo
     return mLineCache;
 }
 
+/** Find the accounts whose trust lines may differ between two ledgers.
+    Walks back from `ledger` to `base` through the transaction metadata
+    of the ledgers in between.
+    @return false if `ledger` does not follow `base` closely enough.
+*/
+bool PathRequests::getChangedAccounts (Ledger::ref base, Ledger::ref ledger,
+                                       boost::unordered_set<uint160>& changed)
+{
+    if (!base->isClosed () || !ledger->isClosed () ||
+        (ledger->getLedgerSeq () <= base->getLedgerSeq ()) ||
+        (ledger->getLedgerSeq () > (base->getLedgerSeq () + 8)))
+    {
+        return false;
+    }
+
+    Ledger::pointer current = ledger;
+
+    while (current->getLedgerSeq () > base->getLedgerSeq ())
+    {
+        AcceptedLedger::pointer accepted =
+            AcceptedLedger::makeAcceptedLedger (current);
+
+        BOOST_FOREACH (AcceptedLedger::value_type const& tx, accepted->getMap ())
+        {
+            BOOST_FOREACH (RippleAddress const& account, tx.second->getAffected ())
+                changed.insert (account.getAccountID ());
+        }
+
+        if (current->getParentHash () == base->getHash ())
+            return true;
+
+        current = getApp().getLedgerMaster ().getLedgerByHash (
+            current->getParentHash ());
+
+        if (!current)
+            return false;
+    }
+
+    // A different chain
+    return false;
+}
+
+/** A request to bring up to date in this pass, and how urgent it is. */
+struct PathRequests::Task
+{
+    PathRequest::pointer request;
+    bool isNew;
+    int balance;
+
+    // Requests waiting for their first full reply go first, then those
+    // of the clients using the fewest resources, then the oldest.
+    bool operator< (Task const& other) const
+    {
+        if (isNew != other.isNew)
+            return isNew;
+        if (balance != other.balance)
+            return balance < other.balance;
+        return request->getIdentifier () < other.request->getIdentifier ();
+    }
+};
+
 void PathRequests::updateAll (Ledger::ref inLedger, CancelCallback shouldCancel)
 {
     std::vector<PathRequest::wptr> requests;
@@ -60,71 +135,48 @@ void PathRequests::updateAll (Ledger::ref inLedger, CancelCallback shouldCancel)
     }
 
     bool newRequests = getApp().getLedgerMaster().isNewPathRequest();
-    bool mustBreak = false;
 
     mJournal.trace << "updateAll seq=" << ledger->getLedgerSeq() << ", " <<
         requests.size() << " requests";
-    int processed = 0, removed = 0;
+    int processed = 0, removed = 0, skipped = 0;
 
     do
     {
+        std::vector<Task> tasks;
+        tasks.reserve (requests.size ());
 
         BOOST_FOREACH (PathRequest::wref wRequest, requests)
         {
-            if (shouldCancel())
-                break;
-
-            bool remove = true;
             PathRequest::pointer pRequest = wRequest.lock ();
+            if (!pRequest)
+                continue;
 
-            if (pRequest)
-            {
-                if (!pRequest->needsUpdate (newRequests, ledger->getLedgerSeq ()))
-                    remove = false;
-                else
-                {
-                    InfoSub::pointer ipSub = pRequest->getSubscriber ();
-                    if (ipSub)
-                    {
-                        ipSub->getConsumer ().charge (Resource::feePathFindUpdate);
-                        if (!ipSub->getConsumer ().warn ())
-                        {
-                            Json::Value update = pRequest->doUpdate (cache, false);
-                            pRequest->updateComplete ();
-                            update["type"] = "find_path";
-                            ipSub->send (update, false);
-                            remove = false;
-                            ++processed;
-                        }
-                    }
-                }
-            }
+            Task task;
+            task.request = pRequest;
+            task.isNew = pRequest->isNew ();
+            task.balance = 0;
 
-            if (remove)
-            {
-                PathRequest::pointer pRequest = wRequest.lock ();
+            InfoSub::pointer ipSub = pRequest->getSubscriber ();
+            if (ipSub)
+                task.balance = ipSub->getConsumer ().balance ();
 
-                ScopedLockType sl (mLock);
+            tasks.push_back (task);
+        }
 
-                // Remove any dangling weak pointers or weak pointers that refer to this path request.
-                std::vector<PathRequest::wptr>::iterator it = mRequests.begin();
-                while (it != mRequests.end())
-                {
-                    PathRequest::pointer itRequest = it->lock ();
-                    if (!itRequest || (itRequest == pRequest))
-                    {
-                        ++removed;
-                        it = mRequests.erase (it);
-                    }
-                    else
-                        ++it;
-                }
-            }
+        std::sort (tasks.begin (), tasks.end ());
 
-            mustBreak = !newRequests && getApp().getLedgerMaster().isNewPathRequest();
-            if (mustBreak) // We weren't handling new requests and then there was a new request
-                break;
+        std::vector<PathRequest::pointer> toRemove;
+        bool mustBreak = false;
+        bool movedOn = false;
 
+        processed += runTasks (tasks, ledger, cache, newRequests, shouldCancel,
+                               toRemove, mustBreak, movedOn, skipped);
+
+        removed += removeRequests (toRemove);
+
+        if (movedOn)
+        { // a newer ledger was validated, start over with it
+            break;
         }
 
         if (mustBreak)
@@ -139,7 +191,7 @@ void PathRequests::updateAll (Ledger::ref inLedger, CancelCallback shouldCancel)
         { // check if there are any new requests, otherwise we are done
             newRequests = getApp().getLedgerMaster().isNewPathRequest();
             if (!newRequests) // We did a full pass and there are no new requests
-                return;
+                break;
         }
 
         {
@@ -156,8 +208,189 @@ void PathRequests::updateAll (Ledger::ref inLedger, CancelCallback shouldCancel)
     }
     while (!shouldCancel ());
 
-    mJournal.debug << "updateAll complete " << processed << " process and " <<
-        removed << " removed";
+    mJournal.debug << "updateAll complete " << processed << " process, " <<
+        removed << " removed and " << skipped << " skipped";
+}
+
+/** Update the requests of one pass, best first, on this job and a few
+    jtPATH_FIND jobs.
+    Each request is claimed only when a worker reaches it, so requests a
+    pass does not get to stay eligible for the next one.
+    @return the number of requests updated.
+*/
+int PathRequests::runTasks (std::vector<Task> const& tasks,
+    Ledger::ref ledger, RippleLineCache::ref cache, bool newRequests,
+    CancelCallback const& shouldCancel, std::vector<PathRequest::pointer>& toRemove,
+    bool& mustBreak, bool& movedOn, int& skipped)
+{
+    LedgerIndex const index = ledger->getLedgerSeq ();
+
+    std::atomic <std::size_t> next (0);
+    std::atomic <bool> stop (false);
+    std::atomic <bool> breakFlag (false);
+    std::atomic <bool> movedFlag (false);
+    std::atomic <int> processed (0);
+    std::atomic <int> skips (0);
+
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    auto work = [&] (CancelCallback const& cancel)
+    {
+        try
+        {
+            std::size_t i;
+            while (!stop && ((i = next++) < tasks.size ()))
+            {
+                if (cancel ())
+                {
+                    stop = true;
+                    break;
+                }
+
+                if (movedFlag || (getApp().getLedgerMaster().getValidLedgerIndex () > index))
+                { // Anything sent from this ledger would be stale on arrival
+                    movedFlag = true;
+                    ++skips;
+                    mSkipped.increment (1);
+                    continue;
+                }
+
+                PathRequest::ref pRequest = tasks[i].request;
+                bool remove = true;
+
+                if (!pRequest->needsUpdate (newRequests, index))
+                    remove = false;
+                else
+                {
+                    InfoSub::pointer ipSub = pRequest->getSubscriber ();
+                    if (ipSub)
+                    {
+                        ipSub->getConsumer ().charge (Resource::feePathFindUpdate);
+                        if (!ipSub->getConsumer ().warn ())
+                        {
+                            auto const start = std::chrono::steady_clock::now ();
+                            Json::Value update = pRequest->doUpdate (cache, false);
+                            pRequest->updateComplete ();
+                            update["type"] = "find_path";
+                            ipSub->send (update, false);
+                            remove = false;
+                            ++processed;
+
+                            mUpdate.notify (std::chrono::duration_cast <
+                                std::chrono::milliseconds> (
+                                    std::chrono::steady_clock::now () - start));
+                        }
+                    }
+                }
+
+                if (remove)
+                {
+                    std::lock_guard <std::mutex> sl (mutex);
+                    toRemove.push_back (pRequest);
+                }
+
+                if (!newRequests && getApp().getLedgerMaster().isNewPathRequest())
+                { // We weren't handling new requests and then there was a new request
+                    breakFlag = true;
+                    stop = true;
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard <std::mutex> sl (mutex);
+            if (!error)
+                error = std::current_exception ();
+            stop = true;
+        }
+    };
+
+    // Helpers claim tasks from the same counter as this job. Once this job
+    // runs out of tasks it closes the pass, and a helper that has not
+    // started by then does nothing. So the pass only waits for helpers
+    // that are running, never for a job still in the queue.
+    struct Pass
+    {
+        Pass ()
+            : running (0)
+            , closed (false)
+        {
+        }
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        int running;
+        bool closed;
+    };
+
+    std::shared_ptr <Pass> const pass (std::make_shared <Pass> ());
+
+    std::size_t const workers = std::min <std::size_t> (
+        std::max (1, getConfig ().PATH_FIND_THREADS), tasks.size ());
+
+    for (std::size_t i = 1; i < workers; ++i)
+    {
+        getApp().getJobQueue ().addJob (jtPATH_FIND, "PathRequests::runTasks",
+            [pass, &work] (Job& job)
+            {
+                {
+                    std::lock_guard <std::mutex> sl (pass->mutex);
+                    if (pass->closed)
+                        return;
+                    ++pass->running;
+                }
+
+                work (job.getCancelCallback ());
+
+                std::lock_guard <std::mutex> sl (pass->mutex);
+                --pass->running;
+                pass->cond.notify_all ();
+            });
+    }
+
+    work (shouldCancel);
+
+    {
+        std::unique_lock <std::mutex> sl (pass->mutex);
+        pass->closed = true;
+        pass->cond.wait (sl, [&pass] { return pass->running == 0; });
+    }
+
+    if (error)
+        std::rethrow_exception (error);
+
+    mustBreak = breakFlag;
+    movedOn = movedFlag;
+    skipped += skips;
+    return processed;
+}
+
+/** Remove requests, and any whose owner is gone, from the list.
+    @return the number of entries removed.
+*/
+int PathRequests::removeRequests (std::vector<PathRequest::pointer> const& toRemove)
+{
+    ScopedLockType sl (mLock);
+
+    int removed = 0;
+
+    // Remove any dangling weak pointers or weak pointers that refer to these path requests.
+    std::vector<PathRequest::wptr>::iterator it = mRequests.begin();
+    while (it != mRequests.end())
+    {
+        PathRequest::pointer itRequest = it->lock ();
+        if (!itRequest ||
+            (std::find (toRemove.begin (), toRemove.end (), itRequest) != toRemove.end ()))
+        {
+            ++removed;
+            it = mRequests.erase (it);
+        }
+        else
+            ++it;
+    }
+
+    return removed;
 }
 
 Json::Value PathRequests::makePathRequest(
@@ -31,6 +31,8 @@ public:
     {
         mFast = collector->make_event ("pathfind_fast");
         mFull = collector->make_event ("pathfind_full");
+        mUpdate = collector->make_event ("pathfind_update");
+        mSkipped = collector->make_counter ("pathfind_skipped");
     }
 
     void updateAll (const boost::shared_ptr<Ledger>& ledger, CancelCallback shouldCancel);
@@ -53,11 +55,29 @@ public:
     }
 
 private:
+    struct Task;
+
+    bool getChangedAccounts (Ledger::ref base, Ledger::ref ledger,
+                             boost::unordered_set<uint160>& changed);
+
+    int runTasks (std::vector<Task> const& tasks, Ledger::ref ledger,
+        RippleLineCache::ref cache, bool newRequests,
+        CancelCallback const& shouldCancel,
+        std::vector<PathRequest::pointer>& toRemove,
+        bool& mustBreak, bool& movedOn, int& skipped);
+
+    int removeRequests (std::vector<PathRequest::pointer> const& toRemove);
+
     beast::Journal                   mJournal;
 
     beast::insight::Event            mFast;
     beast::insight::Event            mFull;
 
+    // Time to update one request, and updates dropped because a newer
+    // ledger was validated while they waited
+    beast::insight::Event            mUpdate;
+    beast::insight::Counter          mSkipped;
+
     // Track all requests
     std::vector<PathRequest::wptr>   mRequests;
 
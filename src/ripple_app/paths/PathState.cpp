@@ -411,7 +411,10 @@ void PathState::setExpanded (
 
     WriteLog (lsTRACE, RippleCalc) << "setExpanded> " << spSourcePath.getJson (0);
 
-    lesEntries  = lesSource.duplicate ();
+    lesEntries.setToDuplicate (lesSource);
+
+    // Each element adds a node and may imply one more, plus the ends
+    vpnNodes.reserve (2 * spSourcePath.size () + 3);
 
     terStatus   = tesSUCCESS;
 
@@ -192,12 +192,26 @@ bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet&
 
     }
 
-    BOOST_FOREACH(CostedPath_t const& costedPath, mPathTable[paymentType])
+    // Requests on the same ledger with the same ends and level share the
+    // candidates; only the amount, and so the filtering, differs.
+    RippleLineCache::PathKey const key (mSrcAccountID, mSrcCurrencyID,
+        mSrcIssuerID, mDstAccountID, mDstAmount.getCurrency (), iLevel);
+
+    if (mRLCache->getCompletePaths (key, mCompletePaths))
     {
-       if (costedPath.first <= iLevel)
-       {
-           getPaths(costedPath.second);
-       }
+        WriteLog (lsDEBUG, Pathfinder) << "Reusing candidate paths";
+    }
+    else
+    {
+        BOOST_FOREACH(CostedPath_t const& costedPath, mPathTable[paymentType])
+        {
+           if (costedPath.first <= iLevel)
+           {
+               getPaths(costedPath.second);
+           }
+        }
+
+        mRLCache->setCompletePaths (key, mCompletePaths);
     }
 
     WriteLog (lsDEBUG, Pathfinder) << mCompletePaths.size() << " complete paths found";
@@ -468,25 +482,24 @@ bool Pathfinder::matchesOrigin (const uint160& currency, const uint160& issuer)
 int Pathfinder::getPathsOut (RippleCurrency const& currencyID, const uint160& accountID,
                              bool isDstCurrency, const uint160& dstAccount)
 {
-    // VFALCO TODO Use RippleAsset here
-    std::pair<const uint160&, const uint160&> accountCurrency (currencyID, accountID);
-    // VFALCO TODO Use RippleAsset here
-    ripple::unordered_map<std::pair<uint160, uint160>, int>::iterator it = mPOMap.find (accountCurrency);
+    // The count is shared by every search on this ledger. The
+    // destination only matters when it could be reached directly.
+    uint160 const dstKey (isDstCurrency ? dstAccount : uint160 ());
+    int count = 0;
 
-    if (it != mPOMap.end ())
-        return it->second;
+    if (mRLCache->getPathsOut (currencyID, accountID, dstKey, count))
+        return count;
 
     SLE::pointer sleAccount = mLedger->getSLEi(Ledger::getAccountRootIndex(accountID));
     if (!sleAccount)
     {
-        mPOMap[accountCurrency] = 0;
+        mRLCache->setPathsOut (currencyID, accountID, dstKey, 0);
         return 0;
     }
 
     int aFlags = sleAccount->getFieldU32(sfFlags);
     bool const bAuthRequired = (aFlags & lsfRequireAuth) != 0;
 
-    int count = 0;
     AccountItems& rippleLines (mRLCache->getRippleLines (accountID));
 
     BOOST_FOREACH (AccountItem::ref item, rippleLines.getItems ())
@@ -507,7 +520,7 @@ int Pathfinder::getPathsOut (RippleCurrency const& currencyID, const uint160& ac
         else
             ++count;
     }
-    mPOMap[accountCurrency] = count;
+    mRLCache->setPathsOut (currencyID, accountID, dstKey, count);
     return count;
 }
 
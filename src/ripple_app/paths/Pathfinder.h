@@ -128,9 +128,6 @@ private:
     STPathSet                         mCompletePaths;
     std::map< PathType_t, STPathSet > mPaths;
 
-    ripple::unordered_map<uint160, AccountItems::pointer>    mRLMap;
-    ripple::unordered_map<std::pair<uint160, uint160>, int>  mPOMap;
-
     static const std::uint32_t afADD_ACCOUNTS = 0x001;  // Add ripple paths
     static const std::uint32_t afADD_BOOKS    = 0x002;  // Add order books
     static const std::uint32_t afOB_STR       = 0x010;  // Add order book to STR only
@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include "../../beast/beast/unit_test/suite.h"
+
 namespace ripple {
 
 namespace {
@@ -95,6 +97,13 @@ TER RippleCalc::calcNodeAdvance (
             return tefEXCEPTION;
         }
 
+        if (!chargeCost (1))
+        {
+            WriteLog (lsDEBUG, RippleCalc) << "calcNodeAdvance: cost limit reached";
+            terResult = tecPATH_DRY;
+            break;
+        }
+
         bool    bDirectDirDirty = false;
 
         if (!uDirectTip)
@@ -2396,7 +2405,15 @@ void RippleCalc::pathNext (
 
     assert (psrCur->vpnNodes.size () >= 2);
 
-    lesCurrent  = lesCheckpoint.duplicate ();  // Restore from checkpoint.
+    lesCurrent.setToDuplicate (lesCheckpoint);  // Restore from checkpoint.
+
+    if (!chargeCost (psrCur->vpnNodes.size ()))
+    {
+        WriteLog (lsDEBUG, RippleCalc) << "pathNext: cost limit reached";
+        psrCur->terStatus = tecPATH_DRY;
+        psrCur->uQuality = 0;
+        return;
+    }
 
     for (unsigned int uIndex = psrCur->vpnNodes.size (); uIndex--;)
     {
@@ -2416,7 +2433,7 @@ void RippleCalc::pathNext (
     if (tesSUCCESS == psrCur->terStatus)
     {
         // Do forward.
-        lesCurrent = lesCheckpoint.duplicate ();   // Restore from checkpoint.
+        lesCurrent.setToDuplicate (lesCheckpoint);  // Restore from checkpoint.
 
         psrCur->terStatus = calcNodeFwd (0, *psrCur, bMultiQuality);
     }
@@ -2477,7 +2494,8 @@ TER RippleCalc::rippleCalc (
     const bool          bOpenLedger)
 {
     assert (activeLedger.isValid ());
-    RippleCalc  rc (activeLedger, bOpenLedger);
+    RippleCalc  rc (activeLedger, bOpenLedger,
+                    bStandAlone ? computeCostLimit : -1);
 
     WriteLog (lsTRACE, RippleCalc)
         << "rippleCalc>"
@@ -2607,9 +2625,6 @@ TER RippleCalc::rippleCalc (
     saDstAmountAct  = STAmount (
         saDstAmountReq.getCurrency (), saDstAmountReq.getIssuer ());
 
-    // Checkpoint with just fees paid.
-    const LedgerEntrySet lesBase = activeLedger;
-
     // When processing, we don't want to complicate directory walking with
     // deletion.
     const std::uint64_t uQualityLimit = bLimitQuality
@@ -2620,10 +2635,13 @@ TER RippleCalc::rippleCalc (
 
     int iPass   = 0;
 
+    // Kept across passes so that its storage is reused
+    LedgerEntrySet lesCheckpoint;
+
     while (temUNCERTAIN == terResult)
     {
         int iBest = -1;
-        const LedgerEntrySet lesCheckpoint = activeLedger;
+        lesCheckpoint.setTo (activeLedger);
         int iDry = 0;
 
         // True, if ever computed multi-quality.
@@ -2860,4 +2878,37 @@ TER RippleCalc::rippleCalc (
     return terResult;
 }
 
+//------------------------------------------------------------------------------
+
+class RippleCalc_test : public beast::unit_test::suite
+{
+public:
+    void testCostBudget ()
+    {
+        testcase ("cost budget");
+
+        RippleCalc::CostBudget budget (10);
+        expect (budget.charge (4), "Charge within the budget failed");
+        expect (budget.charge (6), "Charge up to the budget failed");
+        expect (! budget.charge (1), "Charge past the budget succeeded");
+        expect (! budget.charge (1), "Charge after running out succeeded");
+
+        RippleCalc::CostBudget overdrawn (3);
+        expect (! overdrawn.charge (5), "Overdraft succeeded");
+        expect (! overdrawn.charge (1), "Charge after an overdraft succeeded");
+
+        RippleCalc::CostBudget unlimited (-1);
+        for (int i = 0; i < 10; ++i)
+            expect (unlimited.charge (RippleCalc::computeCostLimit),
+                "Unlimited budget ran out");
+    }
+
+    void run ()
+    {
+        testCostBudget ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RippleCalc,ripple_app,ripple);
+
 } // ripple
@@ -89,12 +89,61 @@ class RippleCalc
         const STAmount& saPrvReq, const STAmount& saCurReq,
         STAmount& saPrvAct, STAmount& saCurAct, std::uint64_t& uRateMax);
 
-    RippleCalc (LedgerEntrySet& activeLedger, const bool bOpenLedger)
+    // Charges `cost` entries against the budget.
+    // Returns false once the budget is spent.
+    bool chargeCost (int cost)
+    {
+        return mCost.charge (cost);
+    }
+
+    RippleCalc (LedgerEntrySet& activeLedger, const bool bOpenLedger,
+                const int iCostLimit)
         : mActiveLedger (activeLedger), mOpenLedger (bOpenLedger)
+        , mCost (iCostLimit)
     {
     }
 
 public:
+    /** The path nodes and offers a computation may still visit. */
+    class CostBudget
+    {
+    public:
+        // A negative limit means no limit
+        explicit CostBudget (int limit)
+            : mLimited (limit >= 0)
+            , mLeft (std::max (limit, 0))
+        {
+        }
+
+        // Returns false if `cost` does not fit in what is left. A spent
+        // budget stays spent.
+        bool charge (int cost)
+        {
+            if (!mLimited)
+                return true;
+
+            if (cost > mLeft)
+            {
+                mLeft = 0;
+                return false;
+            }
+
+            mLeft -= cost;
+            return true;
+        }
+
+    private:
+        bool mLimited;
+        int mLeft;
+    };
+
+    // The most path nodes and order book entries a computation that does
+    // not apply its result (bStandAlone) visits. Once spent, the remaining
+    // paths are treated as dry and the result is what was found so far.
+    // Path finding calls rippleCalc for every candidate, so this bounds
+    // the work one path_find request can cause.
+    static int const computeCostLimit = 4000;
+
     static TER rippleCalc (
         LedgerEntrySet&                   lesActive,
         STAmount&                         saMaxAmountAct,
@@ -121,6 +170,8 @@ public:
 private:
     LedgerEntrySet& mActiveLedger;
     bool mOpenLedger;
+
+    CostBudget mCost;
 };
 
 } // ripple
@@ -37,4 +37,72 @@ AccountItems& RippleLineCache::getRippleLines (const uint160& accountID)
     return *it->second;
 }
 
+int RippleLineCache::inherit (RippleLineCache& parent,
+                              boost::unordered_set <uint160> const& changed)
+{
+    ripple::unordered_map <uint160, AccountItems::pointer> lines;
+    {
+        ScopedLockType sl (parent.mLock);
+        lines = parent.mRLMap;
+    }
+
+    int count = 0;
+
+    ScopedLockType sl (mLock);
+
+    for (auto const& entry : lines)
+    {
+        if ((changed.find (entry.first) == changed.end ()) &&
+            mRLMap.insert (entry).second)
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+bool RippleLineCache::getPathsOut (uint160 const& currencyID,
+    uint160 const& accountID, uint160 const& dstAccount, int& count)
+{
+    ScopedLockType sl (mLock);
+
+    auto it = mPOMap.find (std::make_tuple (currencyID, accountID, dstAccount));
+
+    if (it == mPOMap.end ())
+        return false;
+
+    count = it->second;
+    return true;
+}
+
+void RippleLineCache::setPathsOut (uint160 const& currencyID,
+    uint160 const& accountID, uint160 const& dstAccount, int count)
+{
+    ScopedLockType sl (mLock);
+
+    mPOMap[std::make_tuple (currencyID, accountID, dstAccount)] = count;
+}
+
+bool RippleLineCache::getCompletePaths (PathKey const& key, STPathSet& paths)
+{
+    ScopedLockType sl (mLock);
+
+    auto it = mPathMap.find (key);
+
+    if (it == mPathMap.end ())
+        return false;
+
+    paths = it->second;
+    return true;
+}
+
+void RippleLineCache::setCompletePaths (PathKey const& key,
+                                        STPathSet const& paths)
+{
+    ScopedLockType sl (mLock);
+
+    mPathMap[key] = paths;
+}
+
 } // ripple
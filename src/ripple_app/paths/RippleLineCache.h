@@ -23,12 +23,22 @@
 namespace ripple {
 
 // Used by Pathfinder
+//
+// Besides each account's trust lines, the cache holds what Pathfinder
+// learns about its ledger: the number of useful paths out of an
+// account in a currency, and the candidate paths found for a search.
+// All of it is shared by the path requests served from this ledger.
 class RippleLineCache
 {
 public:
     typedef boost::shared_ptr <RippleLineCache> pointer;
     typedef pointer const& ref;
 
+    // Source account, currency and issuer, destination account and
+    // currency, and search level
+    typedef std::tuple <uint160, uint160, uint160, uint160, uint160, int>
+        PathKey;
+
     explicit RippleLineCache (Ledger::ref l);
 
     Ledger::ref getLedger () // VFALCO TODO const?
@@ -38,6 +48,21 @@ public:
 
     AccountItems& getRippleLines (const uint160& accountID);
 
+    // Takes over the trust lines `parent` loaded for accounts that are
+    // not in `changed`. The caller guarantees that no other account's
+    // lines differ between the two ledgers.
+    // Returns the number of accounts taken over.
+    int inherit (RippleLineCache& parent,
+                 boost::unordered_set <uint160> const& changed);
+
+    bool getPathsOut (uint160 const& currencyID, uint160 const& accountID,
+                      uint160 const& dstAccount, int& count);
+    void setPathsOut (uint160 const& currencyID, uint160 const& accountID,
+                      uint160 const& dstAccount, int count);
+
+    bool getCompletePaths (PathKey const& key, STPathSet& paths);
+    void setCompletePaths (PathKey const& key, STPathSet const& paths);
+
 private:
     typedef RippleMutex LockType;
     typedef std::lock_guard <LockType> ScopedLockType;
@@ -46,6 +71,11 @@ private:
     Ledger::pointer mLedger;
     
     ripple::unordered_map <uint160, AccountItems::pointer> mRLMap;
+
+    // Keyed by currency, account and, if it matters, destination
+    std::map <std::tuple <uint160, uint160, uint160>, int> mPOMap;
+
+    std::map <PathKey, STPathSet> mPathMap;
 };
 
 } // ripple
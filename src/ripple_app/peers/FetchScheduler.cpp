@@ -0,0 +1,288 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+FetchScheduler::FetchScheduler (int maxOutstanding)
+    : mMaxOutstanding (std::max (1, maxOutstanding))
+{
+}
+
+void FetchScheduler::setMaxOutstanding (int maxOutstanding)
+{
+    mMaxOutstanding = std::max (1, maxOutstanding);
+}
+
+bool FetchScheduler::addPeer (PeerId peer)
+{
+    if (find (peer) != nullptr)
+        return false;
+
+    mPeers.emplace_back ();
+    mPeers.back ().id = peer;
+    return true;
+}
+
+void FetchScheduler::removePeer (PeerId peer)
+{
+    for (auto iter = mPeers.begin (); iter != mPeers.end (); ++iter)
+    {
+        if (iter->id == peer)
+        {
+            mPeers.erase (iter);
+            return;
+        }
+    }
+}
+
+bool FetchScheduler::hasPeer (PeerId peer) const
+{
+    return find (peer) != nullptr;
+}
+
+bool FetchScheduler::choose (PeerId& peer) const
+{
+    PeerState const* best = nullptr;
+    duration::rep bestCost = 0;
+
+    for (auto const& p : mPeers)
+    {
+        int const outstanding = static_cast <int> (p.sent.size ());
+
+        if (outstanding >= mMaxOutstanding)
+            continue;
+
+        // When this request would be answered if the peer works through
+        // its queue at its usual pace
+        duration::rep const cost = (outstanding + 1) * p.latency.count ();
+
+        if ((best == nullptr) || (cost < bestCost) ||
+            ((cost == bestCost) && (p.sent.size () < best->sent.size ())))
+        {
+            best = &p;
+            bestCost = cost;
+        }
+    }
+
+    if (best == nullptr)
+        return false;
+
+    peer = best->id;
+    return true;
+}
+
+int FetchScheduler::getFreeSlots () const
+{
+    int slots = 0;
+
+    for (auto const& p : mPeers)
+    {
+        int const outstanding = static_cast <int> (p.sent.size ());
+
+        if (outstanding < mMaxOutstanding)
+            slots += mMaxOutstanding - outstanding;
+    }
+
+    return slots;
+}
+
+void FetchScheduler::onRequest (PeerId peer, time_point now)
+{
+    PeerState* p = find (peer);
+
+    if (p != nullptr)
+        p->sent.push_back (now);
+}
+
+bool FetchScheduler::onReply (PeerId peer, time_point now)
+{
+    PeerState* p = find (peer);
+
+    if ((p == nullptr) || p->sent.empty ())
+        return false;
+
+    duration sample = std::chrono::duration_cast <duration> (
+        now - p->sent.front ());
+    p->sent.pop_front ();
+
+    if (sample < duration (1))
+        sample = duration (1);
+
+    // Smooth with a weight of 1/4 on the new sample, as TCP does
+    p->latency = (3 * p->latency + sample) / 4;
+    return true;
+}
+
+int FetchScheduler::onTimeout (time_point now, duration timeout)
+{
+    int expired = 0;
+
+    for (auto& p : mPeers)
+    {
+        while (!p.sent.empty () && ((now - p.sent.front ()) >= timeout))
+        {
+            p.sent.pop_front ();
+            p.latency = std::min (2 * p.latency, maxLatency ());
+            ++expired;
+        }
+    }
+
+    return expired;
+}
+
+int FetchScheduler::getOutstanding (PeerId peer) const
+{
+    PeerState const* p = find (peer);
+
+    return (p == nullptr) ? 0 : static_cast <int> (p->sent.size ());
+}
+
+int FetchScheduler::getOutstanding () const
+{
+    int outstanding = 0;
+
+    for (auto const& p : mPeers)
+        outstanding += static_cast <int> (p.sent.size ());
+
+    return outstanding;
+}
+
+FetchScheduler::duration FetchScheduler::getLatency (PeerId peer) const
+{
+    PeerState const* p = find (peer);
+
+    return (p == nullptr) ? initialLatency () : p->latency;
+}
+
+FetchScheduler::PeerState* FetchScheduler::find (PeerId peer)
+{
+    for (auto& p : mPeers)
+    {
+        if (p.id == peer)
+            return &p;
+    }
+
+    return nullptr;
+}
+
+FetchScheduler::PeerState const* FetchScheduler::find (PeerId peer) const
+{
+    for (auto const& p : mPeers)
+    {
+        if (p.id == peer)
+            return &p;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+class FetchScheduler_test : public beast::unit_test::suite
+{
+public:
+    typedef FetchScheduler::time_point time_point;
+    typedef FetchScheduler::duration duration;
+
+    void testWindow ()
+    {
+        testcase ("window");
+
+        FetchScheduler s (2);
+        time_point const now;
+        FetchScheduler::PeerId peer (0);
+
+        expect (!s.choose (peer), "No peers, no choice");
+
+        expect (s.addPeer (1));
+        expect (!s.addPeer (1), "Duplicate peer");
+        expect (s.getFreeSlots () == 2);
+
+        expect (s.choose (peer) && (peer == 1));
+        s.onRequest (peer, now);
+        expect (s.choose (peer) && (peer == 1));
+        s.onRequest (peer, now);
+
+        expect (!s.choose (peer), "Window should be full");
+        expect (s.getFreeSlots () == 0);
+        expect (s.getOutstanding (1) == 2);
+
+        expect (s.onReply (1, now + duration (100)));
+        expect (s.getFreeSlots () == 1);
+        expect (s.onReply (1, now + duration (100)));
+        expect (!s.onReply (1, now + duration (100)), "Unsolicited reply");
+
+        s.removePeer (1);
+        expect (s.size () == 0);
+    }
+
+    void testLatency ()
+    {
+        testcase ("latency");
+
+        FetchScheduler s (8);
+        time_point now;
+        FetchScheduler::PeerId peer (0);
+
+        s.addPeer (1);
+        s.addPeer (2);
+
+        // Peer 1 answers in 20ms, peer 2 in 400ms
+        for (int i = 0; i < 20; ++i)
+        {
+            s.onRequest (1, now);
+            s.onRequest (2, now);
+            s.onReply (1, now + duration (20));
+            s.onReply (2, now + duration (400));
+            now += duration (1000);
+        }
+
+        expect (s.getLatency (1) < duration (40));
+        expect (s.getLatency (2) > duration (300));
+
+        // The fast peer should take most of a full window's worth
+        int fast = 0;
+        while (s.choose (peer))
+        {
+            s.onRequest (peer, now);
+            if (peer == 1)
+                ++fast;
+            if (s.getOutstanding () == 9)
+                break;
+        }
+        expect (fast == 8, "Fast peer should fill its window first");
+
+        // Timeouts penalize the slow peer and free its slots
+        expect (s.onTimeout (now + duration (5000), duration (2500)) == 9);
+        expect (s.getOutstanding () == 0);
+        expect (s.getLatency (2) > duration (600));
+    }
+
+    void run ()
+    {
+        testWindow ();
+        testLatency ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FetchScheduler,ripple_app,ripple);
+
+} // ripple
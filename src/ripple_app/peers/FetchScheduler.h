@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_FETCHSCHEDULER_H
+#define RIPPLE_FETCHSCHEDULER_H
+
+#include "../../ripple_overlay/api/Peer.h"
+
+#include <chrono>
+#include <deque>
+
+namespace ripple {
+
+/** Decides which peer gets the next request while acquiring data.
+
+    Each peer has a window of outstanding requests. Replies are matched to
+    requests in the order they were sent, which gives a round trip sample
+    per reply; the samples are smoothed into a latency estimate. A new
+    request goes to the peer expected to answer it soonest, that is the
+    one with the smallest (outstanding + 1) * latency among peers whose
+    window is not full.
+
+    This class is not thread safe; the owner serializes access.
+*/
+class FetchScheduler
+{
+public:
+    typedef Peer::ShortId PeerId;
+    typedef std::chrono::steady_clock clock_type;
+    typedef clock_type::time_point time_point;
+    typedef std::chrono::milliseconds duration;
+
+    /** Latency assumed for a peer we have not heard from yet. */
+    static duration initialLatency ()
+    {
+        return duration (250);
+    }
+
+    /** The latency estimate never grows beyond this. */
+    static duration maxLatency ()
+    {
+        return duration (30000);
+    }
+
+    explicit FetchScheduler (int maxOutstanding);
+
+    int getMaxOutstanding () const
+    {
+        return mMaxOutstanding;
+    }
+
+    void setMaxOutstanding (int maxOutstanding);
+
+    /** Add a peer. Returns false if it was already known. */
+    bool addPeer (PeerId peer);
+
+    void removePeer (PeerId peer);
+
+    bool hasPeer (PeerId peer) const;
+
+    std::size_t size () const
+    {
+        return mPeers.size ();
+    }
+
+    /** Pick the peer for the next request.
+        @return false if every peer's window is full.
+    */
+    bool choose (PeerId& peer) const;
+
+    /** Returns the number of requests that could be sent right now. */
+    int getFreeSlots () const;
+
+    /** Record that a request was sent to a peer. */
+    void onRequest (PeerId peer, time_point now);
+
+    /** Record a reply from a peer.
+        @return true if the reply matched an outstanding request.
+    */
+    bool onReply (PeerId peer, time_point now);
+
+    /** Give up on requests sent before now - timeout.
+        Each expired request doubles the peer's latency estimate so that
+        stalled peers are passed over until they answer again.
+        @return the number of requests that expired.
+    */
+    int onTimeout (time_point now, duration timeout);
+
+    int getOutstanding (PeerId peer) const;
+
+    int getOutstanding () const;
+
+    duration getLatency (PeerId peer) const;
+
+private:
+    struct PeerState
+    {
+        PeerState ()
+            : id (0)
+            , latency (initialLatency ())
+        {
+        }
+
+        PeerId id;
+        duration latency;
+        std::deque <time_point> sent;
+    };
+
+    typedef std::vector <PeerState> PeerList;
+
+    PeerState* find (PeerId peer);
+    PeerState const* find (PeerId peer) const;
+
+    int mMaxOutstanding;
+
+    // Usually a handful of peers, so a flat list beats a map
+    PeerList mPeers;
+};
+
+} // ripple
+
+#endif
@@ -62,6 +62,8 @@
 # include "main/FatalErrorReporter.h"
 #include "main/FatalErrorReporter.cpp"
 
+#include "main/MemoryBudget.cpp"
+
 # include "rpc/RPCHandler.h"
 # include "rpc/RPCServerHandler.h"
 # include "main/RPCHTTPServer.h"
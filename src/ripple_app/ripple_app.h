@@ -60,6 +60,7 @@
 
 #include "../../ripple/common/KeyCache.h"
 #include "../../ripple/common/TaggedCache.h"
+#include "../../ripple/common/ShardedTaggedCache.h"
 
 #include "data/Database.h"
 #include "data/DatabaseCon.h"
@@ -89,6 +90,7 @@
 #include "peers/ClusterNodeStatus.h"
 #include "peers/UniqueNodeList.h"
 #include "misc/Validations.h"
+#include "peers/FetchScheduler.h"
 #include "peers/PeerSet.h"
 #include "ledger/InboundLedger.h"
 #include "ledger/InboundLedgers.h"
@@ -110,6 +112,8 @@
 #include "tx/TransactionMaster.h"
 #include "main/LocalCredentials.h"
 #include "main/LedgerDump.h"
+#include "main/LedgerDumpFile.h"
+#include "main/MemoryBudget.h"
 #include "main/Application.h"
 #include "ledger/OrderBookDB.h"
 #include "tx/TransactionAcquire.h"
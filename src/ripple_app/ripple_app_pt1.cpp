@@ -32,6 +32,7 @@
 
 #include "misc/ProofOfWorkFactory.h"
 
+#include "peers/FetchScheduler.cpp"
 #include "peers/PeerSet.cpp"
 #include "misc/OrderBook.cpp"
 #include "misc/ProofOfWorkFactory.cpp"
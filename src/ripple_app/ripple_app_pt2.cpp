@@ -38,6 +38,9 @@
 #include "data/DatabaseCon.cpp"
 #include "data/SqliteDatabase.cpp"
 #include "data/DBInit.cpp"
+#include "data/tests/AccountTxPaging.test.cpp"
+#include "data/tests/DatabaseCon.test.cpp"
+#include "data/tests/DatabaseReaders.test.cpp"
 
 # include "shamap/RadixMapTest.h"
 #include "shamap/RadixMapTest.cpp"
@@ -36,6 +36,7 @@
 #include "ledger/LedgerTiming.cpp"
 #include "ledger/AcceptedLedgerTx.cpp"
 #include "main/LocalCredentials.cpp"
+#include "main/LedgerDumpFile.cpp"
 #include "main/LedgerDump.cpp"
 #include "misc/Validations.cpp"
 #include "misc/FeeVoteImpl.cpp"
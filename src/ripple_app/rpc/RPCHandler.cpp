@@ -131,6 +131,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "get_counts",           &RPCHandler::doGetCounts,           true,   optNone     },
 		{	"inflate",				&RPCHandler::doInflate,				false,	optNone		},
         {   "internal",             &RPCHandler::doInternal,            true,   optNone     },
+        {   "job_latency",          &RPCHandler::doJobLatency,          true,   optNone     },
         {   "feature",              &RPCHandler::doFeature,             true,   optNone     },
         {   "fetch_info",           &RPCHandler::doFetchInfo,           true,   optNone     },
         {   "ledger",               &RPCHandler::doLedger,              false,  optNetwork  },
@@ -140,6 +141,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "ledger_current",       &RPCHandler::doLedgerCurrent,       false,  optCurrent  },
         {   "ledger_data",          &RPCHandler::doLedgerData,          false,  optCurrent  },
         {   "ledger_entry",         &RPCHandler::doLedgerEntry,         false,  optCurrent  },
+        {   "ledger_export",        &RPCHandler::doLedgerExport,        true,   optCurrent  },
         {   "ledger_header",        &RPCHandler::doLedgerHeader,        false,  optCurrent  },
         {   "log_level",            &RPCHandler::doLogLevel,            true,   optNone     },
         {   "logrotate",            &RPCHandler::doLogRotate,           true,   optNone     },
@@ -159,6 +161,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "submit",               &RPCHandler::doSubmit,              false,  optCurrent  },
         {   "server_info",          &RPCHandler::doServerInfo,          false,  optNone     },
         {   "server_state",         &RPCHandler::doServerState,         false,  optNone     },
+        {   "slow_subscribers",     &RPCHandler::doSlowSubscribers,     true,   optNone     },
         {   "sms",                  &RPCHandler::doSMS,                 true,   optNone     },
         {   "stop",                 &RPCHandler::doStop,                true,   optNone     },
         {   "transaction_entry",    &RPCHandler::doTransactionEntry,    false,  optCurrent  },
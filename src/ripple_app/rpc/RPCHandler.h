@@ -81,6 +81,7 @@ private:
 	Json::Value doGetCounts				(Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
 	Json::Value doInflate				(Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doInternal              (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doJobLatency            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedger                (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerAccept          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerCleaner         (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
@@ -88,6 +89,7 @@ private:
     Json::Value doLedgerCurrent         (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerData            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerEntry           (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doLedgerExport          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerHeader          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLogLevel              (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLogRotate             (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
@@ -109,6 +111,7 @@ private:
     Json::Value doSessionClose          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doSessionOpen           (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doSign                  (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doSlowSubscribers       (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doStop                  (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doSubmit                (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doSubscribe             (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
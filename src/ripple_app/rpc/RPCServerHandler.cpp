@@ -40,6 +40,66 @@ bool RPCServerHandler::isAuthorized (
 
 std::string RPCServerHandler::processRequest (std::string const& request,
                                               beast::IP::Endpoint const& remoteIPAddress)
+{
+    Json::Value result;
+
+    std::string const response (doRequest (request, remoteIPAddress, result));
+
+    if (! response.empty ())
+        return response;
+
+    return createResponse (200,
+        JSONRPCReply (result, Json::Value (), Json::Value ()));
+}
+
+void RPCServerHandler::processSession (std::string const& request,
+                                       beast::IP::Endpoint const& remoteIPAddress,
+                                       HTTP::Session& session)
+{
+    Json::Value reply (Json::objectValue);
+
+    {
+        Json::Value result;
+
+        std::string const response (doRequest (request, remoteIPAddress, result));
+
+        if (! response.empty ())
+        {
+            session.write (response);
+            return;
+        }
+
+        reply[jss::result].swap (result);
+    }
+
+    // Size the body first so the headers can go out ahead of it, then
+    // serialize straight into the session in chunks. This avoids building
+    // the document, the reply and the HTTP message as separate strings.
+    static char const trailer[] = "\r\n";
+
+    session.write (HTTPReplyHeader (200,
+        Json::StreamWriter::measure (reply) + (sizeof (trailer) - 1)));
+
+    // Hold at most a few chunks in the session's write queue. If the client
+    // stops reading the rest of the reply is discarded as it is produced.
+    static std::size_t const sendWindow = 256 * 1024;
+    bool sending = true;
+
+    Json::StreamWriter writer ([&session, &sending](char const* data, std::size_t bytes)
+    {
+        sending = sending && session.waitForRoom (sendWindow);
+
+        if (sending)
+            session.write (data, bytes);
+    });
+
+    writer.write (reply);
+    writer.write (trailer, sizeof (trailer) - 1);
+}
+
+std::string RPCServerHandler::doRequest (std::string const& request,
+                                         beast::IP::Endpoint const& remoteIPAddress,
+                                         Json::Value& result)
 {
     Json::Value jsonRequest;
     {
@@ -66,12 +126,6 @@ std::string RPCServerHandler::processRequest (std::string const& request,
     if (usage.disconnect ())
         return createResponse (503, "Server is overloaded");
 
-    // Parse id now so errors from here on will have the id
-    //
-    // VFALCO NOTE Except that "id" isn't included in the following errors...
-    //
-    Json::Value const& id = jsonRequest ["id"];
-
     Json::Value const& method = jsonRequest ["method"];
 
     if (method.isNull ())
@@ -112,8 +166,6 @@ std::string RPCServerHandler::processRequest (std::string const& request,
         return HTTPReply (503, "Unable to service at this time");
     }
 
-    std::string response;
-   
     WriteLog (lsDEBUG, RPCServer) << "Query: " << strMethod << params;
 
     {
@@ -131,24 +183,21 @@ std::string RPCServerHandler::processRequest (std::string const& request,
         {
             usage.charge (req.fee);
             WriteLog (lsDEBUG, RPCServer) << "Reply: " << req.result;
-            return createResponse (200,
-                JSONRPCReply (req.result, Json::Value (), id));
+            result.swap (req.result);
+            return std::string ();
         }
     }
 
     // legacy dispatcher
     Resource::Charge fee (Resource::feeReferenceRPC);
     RPCHandler rpcHandler (&m_networkOPs);
-    Json::Value const result = rpcHandler.doRpcCommand (
-        strMethod, params, role, fee);
+    result = rpcHandler.doRpcCommand (strMethod, params, role, fee);
 
     usage.charge (fee);
 
     WriteLog (lsDEBUG, RPCServer) << "Reply: " << result;
 
-    response = JSONRPCReply (result, Json::Value (), id);
-
-    return createResponse (200, response);
+    return std::string ();
 }
 
 }
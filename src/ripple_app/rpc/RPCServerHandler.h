@@ -38,7 +38,23 @@ public:
     std::string processRequest (std::string const& request,
                                 beast::IP::Endpoint const& remoteIPAddress);
 
+    /** Process a request and write the reply to the session.
+        The result is serialized directly into the session's output in
+        chunks, waiting while the client catches up, so large results are
+        never held as one string. Must be called from a job, not from the
+        server's io_service threads.
+    */
+    void processSession (std::string const& request,
+                         beast::IP::Endpoint const& remoteIPAddress,
+                         HTTP::Session& session);
+
 private:
+    // Returns the complete response if the request failed before it could
+    // be dispatched, otherwise stores the result and returns an empty string.
+    std::string doRequest (std::string const& request,
+                           beast::IP::Endpoint const& remoteIPAddress,
+                           Json::Value& result);
+
     NetworkOPs& m_networkOPs;
     Resource::Manager& m_resourceManager;
 };
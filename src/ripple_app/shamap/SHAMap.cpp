@@ -61,7 +61,7 @@ SHAMap::SHAMap (SHAMapType t, uint256 const& hash, FullBelowCache& fullBelowCach
 }
 
 #ifdef ENABLE_SHAMAP_CACHE
-TaggedCache <uint256, SHAMapTreeNode>
+TreeNodeCache
     SHAMap::treeNodeCache ("TreeNodeCache", 65536, 60,
         get_seconds_clock (),
             LogPartition::getJournal <TaggedCacheLog> ());
@@ -1076,6 +1076,42 @@ int SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
     return flushed;
 }
 
+std::size_t SHAMap::getMemoryUsage (std::size_t limit)
+{
+    std::size_t bytes = 0;
+
+    if (!root)
+        return bytes;
+
+    std::vector <SHAMapTreeNode::pointer> stack;
+    stack.push_back (root);
+
+    while (!stack.empty () && (bytes <= limit))
+    {
+        SHAMapTreeNode::pointer node = std::move (stack.back ());
+        stack.pop_back ();
+
+        bytes += node->getMemoryUsage ();
+
+        if (node->isInner ())
+        {
+            for (int branch = 0; branch < 16; ++branch)
+            {
+                if (node->isEmptyBranch (branch))
+                    continue;
+
+                // Only what is already linked, no I/O
+                SHAMapTreeNode::pointer child = node->getChild (branch);
+
+                if (child)
+                    stack.push_back (std::move (child));
+            }
+        }
+    }
+
+    return bytes;
+}
+
 bool SHAMap::getPath (uint256 const& index, std::vector< Blob >& nodes, SHANodeFormat format)
 {
     // Return the path of nodes to the specified index in the specified format
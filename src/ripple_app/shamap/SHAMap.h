@@ -32,7 +32,7 @@
 #include "../ripple_app/shamap/SHAMapSyncFilter.h"
 #include "../ripple_app/shamap/SHAMapAddNode.h"
 #include "../ripple_core/nodestore/api/NodeObject.h"
-#include "../ripple/common/TaggedCache.h"
+#include "../ripple/common/ShardedTaggedCache.h"
 #include "../ripple_basics/containers/SyncUnorderedMap.h"
 #include "ripple_app/misc/SerializedLedger.h"
 
@@ -205,6 +205,51 @@ public:
     void visitNodes (std::function<void (SHAMapTreeNode&)> const&);
     void visitLeaves(std::function<void (SHAMapItem::ref)> const&);
 
+    /** Visit the leaves below one branch of the root.
+        Visits of different branches may run on different threads.
+    */
+    void visitLeaves (int branch, std::function<void (SHAMapItem::ref)> const&);
+
+    /** A walk of the leaves below one branch of the root that can stop
+        part way. It keeps the path to where it stopped, so the walk
+        carries on from there without searching from the root.
+    */
+    class LeafWalk
+    {
+    public:
+        explicit LeafWalk (int branch)
+            : mBranch (branch)
+            , mStarted (false)
+            , mPos (0)
+        {
+        }
+
+        int getBranch () const
+        {
+            return mBranch;
+        }
+
+    private:
+        friend class SHAMap;
+
+        int mBranch;
+        bool mStarted;
+        SHAMapTreeNode::pointer mNode;  // Inner node being walked, if any
+        int mPos;                       // Next branch of mNode
+        std::vector <std::pair <int, SHAMapTreeNode::pointer>> mStack;
+    };
+
+    /** Visit leaves of the walk's branch in key order, from where the walk
+        stopped, until the function returns false.
+        Returns true once every leaf has been visited.
+    */
+    bool visitLeaves (LeafWalk& walk, std::function<bool (SHAMapItem::ref)> const&);
+
+    /** Estimate the memory used by the nodes of this map that are loaded.
+        Nothing is fetched. Counting stops once it goes past `limit`.
+    */
+    std::size_t getMemoryUsage (std::size_t limit);
+
     // comparison/sync functions
     void getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>& hashes, int max,
                           SHAMapSyncFilter * filter);
@@ -279,6 +324,11 @@ public:
     {
         treeNodeCache.sweep ();
     }
+
+    static TreeNodeCache& getTreeNodeCache ()
+    {
+        return treeNodeCache;
+    }
 #endif
 
     void markAsFull();
@@ -361,6 +411,10 @@ private:
 
     void visitLeavesInternal (std::function<void (SHAMapItem::ref item)>& function);
 
+    // Visit the nodes below an inner node, not the node itself
+    void visitChildren (SHAMapTreeNode::pointer node,
+        std::function<void (SHAMapTreeNode&)> const&);
+
     int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
 
 private:
@@ -40,6 +40,94 @@ void SHAMap::visitLeaves (std::function<void (SHAMapItem::ref item)> const& leaf
             std::cref (leafFunction), std::placeholders::_1));
 }
 
+void SHAMap::visitLeaves (int branch,
+    std::function<void (SHAMapItem::ref item)> const& leafFunction)
+{
+    assert ((branch >= 0) && (branch < 16));
+
+    if (!root || !root->isInner () || root->isEmptyBranch (branch))
+        return;
+
+    SHAMapTreeNode::pointer child = descendNoStore (root, branch);
+
+    std::function <void (SHAMapTreeNode&)> const function (std::bind (
+        visitLeavesHelper, std::cref (leafFunction), std::placeholders::_1));
+
+    function (*child);
+
+    if (child->isInner ())
+        visitChildren (child, function);
+}
+
+bool SHAMap::visitLeaves (LeafWalk& walk,
+    std::function<bool (SHAMapItem::ref item)> const& leafFunction)
+{
+    if (!walk.mStarted)
+    {
+        walk.mStarted = true;
+
+        int const branch = walk.mBranch;
+        assert ((branch >= 0) && (branch < 16));
+
+        if (!root || !root->isInner () || root->isEmptyBranch (branch))
+            return true;
+
+        SHAMapTreeNode::pointer child = descendNoStore (root, branch);
+
+        if (!child->isInner ())
+        {
+            leafFunction (child->peekItem ());
+            return true;
+        }
+
+        walk.mNode = child;
+        walk.mPos = 0;
+    }
+
+    // Same order as visitChildren, with the stack kept in the walk
+    while (walk.mNode)
+    {
+        while (walk.mPos < 16)
+        {
+            int const pos = walk.mPos;
+
+            if (walk.mNode->isEmptyBranch (pos))
+            {
+                ++walk.mPos;
+                continue;
+            }
+
+            SHAMapTreeNode::pointer child = descendNoStore (walk.mNode, pos);
+
+            if (child->isLeaf ())
+            {
+                ++walk.mPos;
+
+                if (!leafFunction (child->peekItem ()))
+                    return false;
+            }
+            else
+            {
+                walk.mStack.push_back (std::make_pair (pos + 1, std::move (walk.mNode)));
+                walk.mNode = std::move (child);
+                walk.mPos = 0;
+            }
+        }
+
+        if (walk.mStack.empty ())
+        {
+            walk.mNode.reset ();
+        }
+        else
+        {
+            std::tie (walk.mPos, walk.mNode) = walk.mStack.back ();
+            walk.mStack.pop_back ();
+        }
+    }
+
+    return true;
+}
+
 void SHAMap::visitNodes(std::function<void (SHAMapTreeNode&)> const& function)
 {
     // Visit every node in a SHAMap
@@ -53,10 +141,15 @@ void SHAMap::visitNodes(std::function<void (SHAMapTreeNode&)> const& function)
     if (!root->isInner ())
         return;
 
+    visitChildren (root, function);
+}
+
+void SHAMap::visitChildren (SHAMapTreeNode::pointer node,
+    std::function<void (SHAMapTreeNode&)> const& function)
+{
     using StackEntry = std::pair <int, SHAMapTreeNode::pointer>;
     std::stack <StackEntry, std::vector <StackEntry>> stack;
 
-    SHAMapTreeNode::pointer node = root;
     int pos = 0;
 
     while (1)
@@ -105,6 +198,13 @@ void SHAMap::visitNodes(std::function<void (SHAMapTreeNode&)> const& function)
 /** Get a list of node IDs and hashes for nodes that are part of this SHAMap
     but not available locally.  The filter can hold alternate sources of
     nodes that are not permanently stored locally
+
+    For a backed map, children that are not in memory are not read one at a
+    time. Each pass over the map posts the reads for every such child to the
+    node store's read threads and moves on; after the pass we wait for the
+    batch, hook up what was found and go around again. A map that is mostly
+    present locally is thus loaded a level at a time with one batch of reads
+    per level, and only what is truly missing is reported.
 */
 void SHAMap::getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>& hashes, int max,
                               SHAMapSyncFilter* filter)
@@ -127,10 +227,17 @@ void SHAMap::getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<ui
     // Track the missing hashes we have found so far
     std::set <uint256> missingHashes;
 
+    // Children whose reads were posted during the current pass
+    using DeferredEntry = std::tuple<SHAMapTreeNode *, SHAMapNodeID, int>;
+    std::vector <DeferredEntry> deferredReads;
+
+    while (1)
     {
         using StackEntry = std::tuple<SHAMapTreeNode *, SHAMapNodeID, int, int, bool>;
         std::stack <StackEntry, std::vector<StackEntry>> stack;
 
+        deferredReads.clear ();
+
         // Traverse the map without blocking
 
         SHAMapTreeNode *node = root.get();
@@ -157,10 +264,16 @@ void SHAMap::getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<ui
                     if (! mBacked || ! m_fullBelowCache.touch_if_exists (childHash))
                     {
                         SHAMapNodeID childID = nodeID.getChildNodeID (branch);
-                        auto c = descend(node, nodeID, branch, filter);
-                        SHAMapTreeNode *d = c.first;
-
-                        if (!d)
+                        bool pending = false;
+                        SHAMapTreeNode *d = descendAsync (node, branch, childID,
+                            filter, pending);
+
+                        if (pending)
+                        { // read posted, look at it after this pass
+                            deferredReads.emplace_back (node, nodeID, branch);
+                            fullBelow = false;
+                        }
+                        else if (!d)
                         {
                             { // node is not in the database
                                 if (missingHashes.insert (childHash).second)
@@ -210,6 +323,39 @@ void SHAMap::getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<ui
             }
         }
         while (node != nullptr);
+
+        if (deferredReads.empty ())
+            break;
+
+        getApp().getNodeStore().waitReads ();
+
+        // The reads have landed in the node store's cache, so these
+        // descents should not block. Anything still absent is missing.
+        int found = 0;
+
+        for (auto const& deferred : deferredReads)
+        {
+            SHAMapTreeNode* parent = std::get<0> (deferred);
+            SHAMapNodeID const& parentID = std::get<1> (deferred);
+            int branch = std::get<2> (deferred);
+
+            auto c = descend (parent, parentID, branch, filter);
+
+            if (c.first)
+                ++found;
+            else if (missingHashes.insert (parent->getChildHash (branch)).second)
+            {
+                nodeIDs.push_back (c.second);
+                hashes.push_back (parent->getChildHash (branch));
+
+                if (--max <= 0)
+                    return;
+            }
+        }
+
+        // Nothing new was hooked in, so another pass would learn nothing
+        if (found == 0)
+            break;
     }
 
     if (nodeIDs.empty ())
@@ -755,6 +901,47 @@ public:
         return true;
     }
 
+    // A walk stopped every few leaves visits what visitLeaves does
+    void testLeafWalk (SHAMap& map)
+    {
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            std::vector <uint256> expected;
+            map.visitLeaves (branch, [&](SHAMapItem::ref item)
+            {
+                expected.push_back (item->getTag ());
+            });
+
+            for (int step : { 1, 7, 1000000 })
+            {
+                std::vector <uint256> walked;
+                SHAMap::LeafWalk walk (branch);
+                int calls = 0;
+
+                for (;;)
+                {
+                    ++calls;
+                    int left = step;
+
+                    if (map.visitLeaves (walk, [&](SHAMapItem::ref item)
+                        {
+                            walked.push_back (item->getTag ());
+                            return --left > 0;
+                        }))
+                        break;
+                }
+
+                unexpected (walked != expected, "LeafWalk order");
+                unexpected (calls > int (expected.size () / step) + 1, "LeafWalk calls");
+
+                unexpected (!map.visitLeaves (walk, [](SHAMapItem::ref)
+                    {
+                        return true;
+                    }), "LeafWalk finished");
+            }
+        }
+    }
+
     void run ()
     {
         unsigned int seed;
@@ -777,6 +964,8 @@ public:
 
         source.setImmutable ();
 
+        testLeafWalk (source);
+
         std::vector<SHAMapNodeID> nodeIDs, gotNodeIDs;
         std::list< Blob > gotNodes;
         std::vector<uint256> hashes;
@@ -889,4 +1078,213 @@ public:
 
 BEAST_DEFINE_TESTSUITE(SHAMapSync,ripple_app,ripple);
 
+//------------------------------------------------------------------------------
+
+/** Measures time-to-sync of a large map over a simulated network.
+
+    Each peer has a round trip time and a cost per node it serves, and
+    works through its requests in order. Time is virtual, so the results
+    depend only on how requests are scheduled. The serial strategy keeps
+    one request in flight, as ledger acquisition did before it had a
+    FetchScheduler; the windowed ones keep up to that many in flight to
+    each peer and pick peers by measured latency.
+*/
+class SHAMapSyncTiming_test : public beast::unit_test::suite
+{
+public:
+    typedef FetchScheduler::time_point time_point;
+    typedef std::chrono::microseconds duration;
+
+    enum
+    {
+        items = 100000,
+        requestSize = 128
+    };
+
+    struct SimPeer
+    {
+        SimPeer (int roundTripMillis, int perNodeMicros)
+            : roundTrip (std::chrono::milliseconds (roundTripMillis))
+            , perNode (perNodeMicros)
+        {
+        }
+
+        duration roundTrip;
+        duration perNode;
+        time_point busyUntil;
+    };
+
+    struct Reply
+    {
+        FetchScheduler::PeerId peer;
+        std::vector<SHAMapNodeID> nodeIDs;
+        std::list<Blob> nodes;
+        std::vector<uint256> requested;
+    };
+
+    struct Result
+    {
+        Result ()
+            : requests (0)
+            , nodes (0)
+        {
+        }
+
+        duration elapsed;
+        int requests;
+        int nodes;
+    };
+
+    Result sync (SHAMap& source, std::vector<SimPeer> peers,
+        FullBelowCache& fullBelowCache, int window)
+    {
+        bool const serial = (window == 0);
+        Result result;
+
+        SHAMap destination (smtFREE, fullBelowCache);
+        destination.setSynching ();
+
+        {
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::list<Blob> nodes;
+            source.getNodeFat (SHAMapNodeID (), nodeIDs, nodes, false, false);
+            destination.addRootNode (nodes.front (), snfWIRE, nullptr);
+        }
+
+        FetchScheduler scheduler (serial ? 1 : window);
+        for (std::size_t i = 0; i < peers.size (); ++i)
+            scheduler.addPeer (i);
+
+        std::multimap <time_point, Reply> inFlight;
+        std::set <uint256> requested;
+        time_point now;
+        std::size_t nextPeer = 0;
+
+        while (1)
+        {
+            int slots = serial ?
+                (inFlight.empty () ? 1 : 0) : scheduler.getFreeSlots ();
+
+            if (slots > 0)
+            {
+                std::vector<SHAMapNodeID> nodeIDs;
+                std::vector<uint256> hashes;
+                destination.getMissingNodes (nodeIDs, hashes,
+                    slots * requestSize + requested.size (), nullptr);
+
+                auto id = nodeIDs.begin ();
+                auto hash = hashes.begin ();
+
+                while ((slots > 0) && (id != nodeIDs.end ()))
+                {
+                    FetchScheduler::PeerId peer;
+
+                    if (serial)
+                        peer = nextPeer++ % peers.size ();
+                    else if (!scheduler.choose (peer))
+                        break;
+
+                    Reply reply;
+                    reply.peer = peer;
+
+                    for (int n = 0; (n < requestSize) && (id != nodeIDs.end ());
+                        ++id, ++hash)
+                    {
+                        if (requested.insert (*hash).second)
+                        {
+                            source.getNodeFat (*id, reply.nodeIDs, reply.nodes,
+                                false, true);
+                            reply.requested.push_back (*hash);
+                            ++n;
+                        }
+                    }
+
+                    if (reply.requested.empty ())
+                        break;
+
+                    SimPeer& p = peers [peer];
+                    time_point const start = std::max (
+                        now + p.roundTrip / 2, p.busyUntil);
+                    p.busyUntil = start + p.perNode * reply.nodes.size ();
+
+                    scheduler.onRequest (peer, now);
+                    inFlight.emplace (p.busyUntil + p.roundTrip / 2,
+                        std::move (reply));
+                    ++result.requests;
+                    --slots;
+                }
+            }
+
+            if (inFlight.empty ())
+                break;
+
+            auto const next = inFlight.begin ();
+            Reply const& reply = next->second;
+            now = next->first;
+
+            scheduler.onReply (reply.peer, now);
+
+            auto node = reply.nodes.begin ();
+            for (auto const& nodeID : reply.nodeIDs)
+            {
+                destination.addKnownNode (nodeID, *node++, nullptr);
+                ++result.nodes;
+            }
+
+            for (auto const& hash : reply.requested)
+                requested.erase (hash);
+
+            inFlight.erase (next);
+        }
+
+        expect (!destination.isSynching (), "Sync incomplete");
+        expect (source.deepCompare (destination), "Deep Compare");
+
+        result.elapsed = std::chrono::duration_cast <duration> (
+            now - time_point ());
+        return result;
+    }
+
+    void report (std::string const& name, Result const& result)
+    {
+        log << name << ": " <<
+            std::chrono::duration_cast <std::chrono::milliseconds> (
+                result.elapsed).count () << "ms simulated, " <<
+            result.requests << " requests, " <<
+            result.nodes << " nodes";
+    }
+
+    void run ()
+    {
+        FullBelowCache fullBelowCache ("test.full_below",
+            get_seconds_clock ());
+
+        SHAMap source (smtFREE, fullBelowCache);
+
+        for (int i = 0; i < items; ++i)
+            source.addItem (*SHAMapSync_test::makeRandomAS (), false, false);
+
+        source.setImmutable ();
+
+        // A close peer, two ordinary ones and a distant one
+        std::vector<SimPeer> peers;
+        peers.emplace_back (10, 20);
+        peers.emplace_back (50, 20);
+        peers.emplace_back (80, 40);
+        peers.emplace_back (250, 20);
+
+        log << items << " items, " << peers.size () << " peers";
+
+        report ("serial", sync (source, peers, fullBelowCache, 0));
+
+        for (int window : { 1, 2, 4, 8, 16 })
+        {
+            report ("window " + std::to_string (window),
+                sync (source, peers, fullBelowCache, window));
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapSyncTiming,ripple_app,ripple);
+
 } // ripple
@@ -30,7 +30,7 @@ namespace ripple {
 class ConsensusTransSetSF : public SHAMapSyncFilter
 {
 public:
-    typedef TaggedCache <uint256, Blob> NodeCache;
+    typedef TaggedCache <uint256, Blob, uint256::uniform_hasher> NodeCache;
 
     // VFALCO TODO Use a dependency injection to get the temp node cache
     ConsensusTransSetSF (NodeCache& nodeCache);
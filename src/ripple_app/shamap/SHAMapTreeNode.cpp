@@ -421,6 +421,19 @@ int SHAMapTreeNode::getBranchCount () const
     return count;
 }
 
+std::size_t SHAMapTreeNode::getMemoryUsage () const
+{
+    std::size_t bytes = sizeof (SHAMapTreeNode);
+
+    if (mInner)
+        bytes += sizeof (InnerData);
+
+    if (mItem)
+        bytes += sizeof (SHAMapItem) + mItem->peekData ().size ();
+
+    return bytes;
+}
+
 void SHAMapTreeNode::makeInner ()
 {
     mItem.reset ();
@@ -22,7 +22,7 @@
 
 #include "../ripple_app/shamap/SHAMapNodeID.h"
 #include "../ripple_basics/utility/CountedObject.h"
-#include "../ripple/common/TaggedCache.h"
+#include "../ripple/common/ShardedTaggedCache.h"
 
 namespace ripple {
 
@@ -177,6 +177,11 @@ public:
         mInner->mFullBelow = true;
     }
 
+    /** Returns the estimated bytes used by this node and its item.
+        Children are not counted.
+    */
+    std::size_t getMemoryUsage () const;
+
     virtual void dump (SHAMapNodeID const&);
     virtual std::string getString (SHAMapNodeID const&) const;
 
@@ -209,7 +214,16 @@ private:
 };
 
 #ifdef ENABLE_SHAMAP_CACHE
-typedef TaggedCache <uint256, SHAMapTreeNode> TreeNodeCache;
+template <>
+struct MemoryEstimate <SHAMapTreeNode>
+{
+    std::size_t operator() (SHAMapTreeNode const& node) const
+    {
+        return node.getMemoryUsage ();
+    }
+};
+
+typedef ShardedTaggedCache <uint256, SHAMapTreeNode, uint256::uniform_hasher> TreeNodeCache;
 #endif
 
 } // ripple
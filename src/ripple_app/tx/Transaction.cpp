@@ -213,8 +213,8 @@ Transaction::pointer Transaction::transactionFromSQL (const std::string& sql)
     rawTxn.resize (txSize);
 
     {
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
-        Database* db = getApp().getTxnDB ()->getDB ();
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         if (!db->executeSQL (sql, true) || !db->startIterRows ())
             return Transaction::pointer ();
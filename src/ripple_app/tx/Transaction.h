@@ -84,6 +84,13 @@ public:
 		return mSerializedTransaction;
     }
 
+    /** Returns the estimated bytes used by the transaction. */
+    std::size_t getMemoryUsage () const
+    {
+        return sizeof (Transaction) + (mSerializedTransaction ?
+            mSerializedTransaction->getMemoryUsage () : 0);
+    }
+
     uint256 const& getID () const
     {
         return mTransactionID;
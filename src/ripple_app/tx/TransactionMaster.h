@@ -22,11 +22,22 @@
 
 namespace ripple {
 
+template <>
+struct MemoryEstimate <Transaction>
+{
+    std::size_t operator() (Transaction const& transaction) const
+    {
+        return transaction.getMemoryUsage ();
+    }
+};
+
 // Tracks all transactions in memory
 
 class TransactionMaster : beast::LeakChecked <TransactionMaster>
 {
 public:
+    typedef ShardedTaggedCache <uint256, Transaction, uint256::uniform_hasher> Cache;
+
     TransactionMaster ();
 
     Transaction::pointer            fetch (uint256 const& , bool checkDisk);
@@ -38,8 +49,13 @@ public:
     bool canonicalize (Transaction::pointer* pTransaction);
     void sweep (void);
 
+    Cache& getCache ()
+    {
+        return mCache;
+    }
+
 private:
-    TaggedCache <uint256, Transaction> mCache;
+    Cache mCache;
 };
 
 } // ripple
@@ -29,6 +29,9 @@ TransactionMetaSet::TransactionMetaSet (uint256 const& txid, std::uint32_t ledge
     Serializer s (vec);
     SerializerIterator sit (s);
 
+    // The nodes are taken, not copied, so they stay in the arena
+    SerializedArena::Scope arena (vec.size ());
+
     std::unique_ptr<SerializedType> pobj = STObject::deserialize (sit, sfAffectedNodes);
     STObject* obj = static_cast<STObject*> (pobj.get ());
 
@@ -37,7 +40,8 @@ TransactionMetaSet::TransactionMetaSet (uint256 const& txid, std::uint32_t ledge
 
     mResult = obj->getFieldU8 (sfTransactionResult);
     mIndex = obj->getFieldU32 (sfTransactionIndex);
-    mNodes = * dynamic_cast<STArray*> (&obj->getField (sfAffectedNodes));
+    mNodes.getValue ().swap (
+        dynamic_cast<STArray&> (obj->getField (sfAffectedNodes)).getValue ());
 
     if (obj->isFieldPresent (sfDeliveredAmount))
         setDeliveredAmount (obj->getFieldAmount (sfDeliveredAmount));
@@ -36,6 +36,15 @@ WSConnection::WSConnection (Resource::Manager& resourceManager,
     , m_receiveQueueRunning (false)
     , m_isDead (false)
     , m_io_service (io_service)
+    , m_sendQueueLimit (std::max (getConfig ().WEBSOCKET_SEND_QUEUE_LIMIT, 0))
+    , m_disconnectSlow (getConfig ().WEBSOCKET_DISCONNECT_SLOW)
+    , m_sendQueueBytes (0)
+    , m_sendWriting (0)
+    , m_sendPeak (0)
+    , m_sentCount (0)
+    , m_droppedCount (0)
+    , m_sending (false)
+    , m_notifyBytes (0)
 {
     WriteLog (lsDEBUG, WSConnection) <<
         "Websocket connection from " << remoteAddress;
@@ -122,6 +131,120 @@ void WSConnection::returnMessage (message_ptr ptr)
     }
 }
 
+//------------------------------------------------------------------------------
+
+// The most we hand to websocketpp before waiting for it to be written. Beyond
+// this messages stay in our queue, where they can be counted and limited.
+static std::size_t const sendWindow = 64 * 1024;
+
+WSConnection::EnqueueResult WSConnection::enqueue (
+    Payload const& payload, bool broadcast)
+{
+    ScopedLockType sl (m_sendQueueMutex);
+
+    std::size_t const backlog (m_sendQueueBytes + m_sendWriting);
+
+    if (broadcast && (m_sendQueueLimit != 0) &&
+        (backlog + payload->size () > m_sendQueueLimit))
+    {
+        ++m_droppedCount;
+
+        WriteLog (lsDEBUG, WSConnection) <<
+            "Send queue full (" << backlog << " bytes) for " << m_remoteAddress;
+
+        return overflow;
+    }
+
+    m_sendQueue.push_back (std::make_pair (payload, broadcast));
+    m_sendQueueBytes += payload->size ();
+    m_sendPeak = std::max (m_sendPeak, m_sendQueueBytes + m_sendWriting);
+
+    if (m_sending)
+        return queued;
+
+    m_sending = true;
+    return startSending;
+}
+
+bool WSConnection::nextToSend (QueuedMessage& message)
+{
+    ScopedLockType sl (m_sendQueueMutex);
+
+    if (m_sendQueue.empty () || ((m_sendWriting != 0) &&
+        (m_sendWriting + m_sendQueue.front ().first->size () > sendWindow)))
+    {
+        m_sending = false;
+        return false;
+    }
+
+    message = m_sendQueue.front ();
+    m_sendQueue.pop_front ();
+
+    std::size_t const size (message.first->size ());
+    m_sendQueueBytes -= size;
+    m_sendWriting += size;
+    ++m_sentCount;
+    return true;
+}
+
+bool WSConnection::onWritten ()
+{
+    ScopedLockType sl (m_sendQueueMutex);
+
+    m_sendWriting = 0;
+
+    if (m_sending || m_sendQueue.empty ())
+        return false;
+
+    m_sending = true;
+    return true;
+}
+
+InfoSub::Backlog WSConnection::getBacklog ()
+{
+    ScopedLockType sl (m_sendQueueMutex);
+
+    Backlog backlog;
+    backlog.messages = m_sendQueue.size ();
+    backlog.bytes = m_sendQueueBytes + m_sendWriting;
+    backlog.peakBytes = m_sendPeak;
+    backlog.sent = m_sentCount;
+    backlog.dropped = m_droppedCount;
+    return backlog;
+}
+
+bool WSConnection::notifyBacklogBelow (std::size_t bytes,
+    std::function <void ()> const& handler)
+{
+    ScopedLockType sl (m_sendQueueMutex);
+
+    if (m_sendQueueBytes + m_sendWriting < bytes)
+        return false;
+
+    // Something is being written, so checkBacklogNotify will be called
+    m_notifyBytes = bytes;
+    m_notifyHandler = handler;
+    return true;
+}
+
+void WSConnection::checkBacklogNotify ()
+{
+    std::function <void ()> handler;
+
+    {
+        ScopedLockType sl (m_sendQueueMutex);
+
+        if (!m_notifyHandler || (m_sendQueueBytes + m_sendWriting >= m_notifyBytes))
+            return;
+
+        handler.swap (m_notifyHandler);
+    }
+
+    handler ();
+}
+
+//------------------------------------------------------------------------------
+
 Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
 {
     if (getConsumer().disconnect ())
@@ -54,6 +54,38 @@ public:
     void returnMessage (message_ptr ptr);
     Json::Value invokeCommand (Json::Value& jvRequest);
 
+    Backlog getBacklog ();
+
+    bool notifyBacklogBelow (std::size_t bytes,
+        std::function <void ()> const& handler);
+
+protected:
+    typedef std::pair <Payload, bool> QueuedMessage;
+
+    enum EnqueueResult
+    {
+        queued,         // added, the queue is already being sent
+        startSending,   // added, the caller must start sending the queue
+        overflow        // refused, the client is too far behind
+    };
+
+    // Adds a message to the send queue. Replies are always accepted,
+    // stream messages are refused once the backlog reaches the limit.
+    EnqueueResult enqueue (Payload const& payload, bool broadcast);
+
+    // Takes the next message to hand to the websocket. Returns false when
+    // the queue is empty or enough has been handed over to fill the window,
+    // sending resumes from onWritten once that has been written.
+    bool nextToSend (QueuedMessage& message);
+
+    // Called when everything handed to the websocket has been written.
+    // Returns true if the caller must start sending the queue.
+    bool onWritten ();
+
+    // Called after a write completes. Runs the backlog handler if the
+    // backlog has dropped under its limit.
+    void checkBacklogNotify ();
+
 protected:
     Resource::Manager& m_resourceManager;
     Resource::Consumer m_usage;
@@ -68,6 +100,19 @@ protected:
     bool m_isDead;
     boost::asio::io_service& m_io_service;
 
+    std::size_t const m_sendQueueLimit;
+    bool const m_disconnectSlow;
+    LockType m_sendQueueMutex;
+    std::deque <QueuedMessage> m_sendQueue;
+    std::size_t m_sendQueueBytes;
+    std::size_t m_sendWriting;          // handed to the websocket, not yet written
+    std::size_t m_sendPeak;
+    std::uint64_t m_sentCount;
+    std::uint64_t m_droppedCount;
+    bool m_sending;
+    std::size_t m_notifyBytes;
+    std::function <void ()> m_notifyHandler;
+
 private:
     WSConnection (WSConnection const&);
     WSConnection& operator= (WSConnection const&);
@@ -126,19 +171,58 @@ public:
 
     // Implement overridden functions from base class:
     void send (const Json::Value& jvObj, bool broadcast)
+    {
+        send (jvObj, encode (jvObj), broadcast);
+    }
+
+    void send (const Json::Value& jvObj, Payload const& payload, bool broadcast)
     {
         connection_ptr ptr = m_connection.lock ();
 
-        if (ptr)
-            m_serverHandler.send (ptr, jvObj, broadcast);
+        if (!ptr)
+            return;
+
+        switch (enqueue (payload, broadcast))
+        {
+        case startSending:
+            ptr->get_strand ().post (boost::bind (
+                &WSConnectionType <endpoint_type>::sendQueued,
+                    boost::static_pointer_cast <WSConnectionType <endpoint_type> > (
+                        shared_from_this ())));
+            break;
+
+        case overflow:
+            if (m_disconnectSlow)
+                m_io_service.dispatch (ptr->get_strand ().wrap (boost::bind (
+                    &WSConnectionType <endpoint_type>::handle_too_slow,
+                        m_connection)));
+            break;
+
+        case queued:
+            break;
+        }
+    }
+
+    // Called on the strand when websocketpp's write queue empties
+    void onSendEmpty ()
+    {
+        if (onWritten ())
+            sendQueued ();
+
+        checkBacklogNotify ();
     }
 
-    void send (const Json::Value& jvObj, const std::string& sObj, bool broadcast)
+    // Hands queued messages to websocketpp, on the connection's strand
+    void sendQueued ()
     {
         connection_ptr ptr = m_connection.lock ();
+        QueuedMessage message;
 
-        if (ptr)
-            m_serverHandler.send (ptr, sObj, broadcast);
+        while (nextToSend (message))
+        {
+            if (ptr)
+                server_type::ssendb (ptr, *message.first, message.second);
+        }
     }
 
     void disconnect ()
@@ -159,6 +243,15 @@ public:
             ptr->close (websocketpp::close::status::PROTOCOL_ERROR, "overload");
     }
 
+    static void handle_too_slow (weak_connection_ptr c)
+    {
+        connection_ptr ptr = c.lock ();
+
+        if (ptr)
+            ptr->close (websocketpp::close::status::value (server_type::crTooSlow),
+                std::string ("Client is too slow."));
+    }
+
     bool onPingTimer (std::string&)
     {
         if (m_sentPing)
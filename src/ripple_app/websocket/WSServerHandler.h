@@ -376,7 +376,7 @@ public:
             jvResult[jss::type]    = jss::error;
             jvResult[jss::error]   = "wsTextRequired"; // We only accept text messages.
 
-            send (cpClient, jvResult, false);
+            conn->send (jvResult, false);
         }
         else if (!jrReader.parse (mpMessage->get_payload (), jvRequest) || jvRequest.isNull () || !jvRequest.isObject ())
         {
@@ -386,7 +386,7 @@ public:
             jvResult[jss::error]   = "jsonInvalid";    // Received invalid json.
             jvResult[jss::value]   = mpMessage->get_payload ();
 
-            send (cpClient, jvResult, false);
+            conn->send (jvResult, false);
         }
         else
         {
@@ -397,7 +397,7 @@ public:
                     job.rename (std::string ("WSClient::") + jCmd.asString());
             }
 
-            send (cpClient, conn->invokeCommand (jvRequest), false);
+            conn->send (conn->invokeCommand (jvRequest), false);
         }
 
         return true;
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include "../../beast/beast/unit_test/suite.h"
+
+#include <thread>
+
+namespace ripple {
+
+class BoundedQueue_test : public beast::unit_test::suite
+{
+public:
+    void testOrder ()
+    {
+        testcase ("order");
+
+        BoundedQueue <std::string> q (3);
+        expect (q.capacity () == 4);
+
+        std::string s;
+        expect (! q.pop (s), "Empty queue");
+
+        for (int round = 0; round < 3; ++round)
+        {
+            for (int i = 0; i < 4; ++i)
+                expect (q.push (std::to_string (i)));
+
+            std::string extra ("extra");
+            expect (! q.push (std::move (extra)), "Full queue");
+            expect (extra == "extra", "Rejected item is left alone");
+
+            for (int i = 0; i < 4; ++i)
+                expect (q.pop (s) && (s == std::to_string (i)));
+
+            expect (! q.pop (s));
+        }
+    }
+
+    void testProducers ()
+    {
+        testcase ("producers");
+
+        int const producers = 4;
+        int const perProducer = 10000;
+
+        BoundedQueue <int> q (256);
+        std::vector <std::thread> threads;
+
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back ([&q, p, perProducer] ()
+            {
+                for (int i = 0; i < perProducer; ++i)
+                {
+                    int item = p * perProducer + i;
+                    while (! q.push (std::move (item)))
+                        std::this_thread::yield ();
+                }
+            });
+        }
+
+        // Each producer's items must come out in the order it pushed them
+        std::vector <int> next (producers, 0);
+        int received = 0;
+        bool ordered = true;
+
+        while (received < producers * perProducer)
+        {
+            int item;
+            if (! q.pop (item))
+            {
+                std::this_thread::yield ();
+                continue;
+            }
+
+            int const p = item / perProducer;
+            if ((item % perProducer) != next [p])
+                ordered = false;
+            next [p] = (item % perProducer) + 1;
+            ++received;
+        }
+
+        for (auto& t : threads)
+            t.join ();
+
+        expect (ordered, "Per-producer order");
+
+        int item;
+        expect (! q.pop (item));
+    }
+
+    void run ()
+    {
+        testOrder ();
+        testProducers ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BoundedQueue,ripple_basics,ripple);
+
+} // ripple
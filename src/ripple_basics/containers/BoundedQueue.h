@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_BASICS_BOUNDEDQUEUE_H_INCLUDED
+#define RIPPLE_BASICS_BOUNDEDQUEUE_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ripple {
+
+/** A fixed size, lock-free, multi-producer multi-consumer queue.
+
+    Each slot carries a sequence number that tells producers and consumers
+    whether it is free or filled for their turn (D. Vyukov's bounded queue).
+    A push or a pop costs one compare-and-swap on the shared position plus
+    a store on the slot; neither ever blocks. A push into a full queue fails
+    instead of waiting, so callers decide what to do with the overflow.
+
+    The capacity is rounded up to a power of two.
+*/
+template <class T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue (std::size_t capacity)
+        : m_mask (roundUp (capacity) - 1)
+        , m_cells (new Cell [m_mask + 1])
+        , m_pushPos (0)
+        , m_popPos (0)
+    {
+        for (std::size_t i = 0; i <= m_mask; ++i)
+            m_cells [i].seq.store (i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue (BoundedQueue const&) = delete;
+    BoundedQueue& operator= (BoundedQueue const&) = delete;
+
+    std::size_t capacity () const
+    {
+        return m_mask + 1;
+    }
+
+    /** Add an item. Returns false, leaving `item` alone, if the queue is full. */
+    bool push (T&& item)
+    {
+        Cell* cell;
+        std::size_t pos = m_pushPos.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &m_cells [pos & m_mask];
+            std::size_t const seq = cell->seq.load (std::memory_order_acquire);
+            std::intptr_t const diff =
+                static_cast <std::intptr_t> (seq) -
+                static_cast <std::intptr_t> (pos);
+
+            if (diff == 0)
+            {
+                if (m_pushPos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_pushPos.load (std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = std::move (item);
+        cell->seq.store (pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Remove the oldest item. Returns false if the queue is empty. */
+    bool pop (T& item)
+    {
+        Cell* cell;
+        std::size_t pos = m_popPos.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            cell = &m_cells [pos & m_mask];
+            std::size_t const seq = cell->seq.load (std::memory_order_acquire);
+            std::intptr_t const diff =
+                static_cast <std::intptr_t> (seq) -
+                static_cast <std::intptr_t> (pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_popPos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_popPos.load (std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move (cell->item);
+        cell->item = T ();
+        cell->seq.store (pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic <std::size_t> seq;
+        T item;
+    };
+
+    static std::size_t roundUp (std::size_t n)
+    {
+        std::size_t result = 2;
+        while (result < n)
+            result <<= 1;
+        return result;
+    }
+
+    std::size_t const m_mask;
+    std::unique_ptr <Cell []> m_cells;
+
+    // Producers and the consumer each get their own cache line
+    char m_pad0 [64];
+    std::atomic <std::size_t> m_pushPos;
+    char m_pad1 [64];
+    std::atomic <std::size_t> m_popPos;
+    char m_pad2 [64];
+};
+
+} // ripple
+
+#endif
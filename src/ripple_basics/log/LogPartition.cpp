@@ -23,12 +23,18 @@ namespace ripple {
 
 void LogPartition::write (beast::Journal::Severity level, std::string const& text)
 {
-    std::string output;
     LogSeverity const logSeverity (convertSeverity (level));
-    LogSink::get()->format (output, text, logSeverity, mName);
-    LogSink::get()->write (output, logSeverity);
+    LogSink::Ptr const sink (LogSink::get());
+
     if (console ())
-        LogSink::get()->write_console (output);
+    {
+        std::string output;
+        sink->format (output, text, logSeverity, mName);
+        sink->write_console (output);
+    }
+
+    // Formatted later, on the sink's writer thread
+    sink->write (text, logSeverity, mName);
 }
 
 //------------------------------------------------------------------------------
@@ -22,26 +22,35 @@
 namespace ripple {
 
 LogSink::LogSink ()
-    : m_minSeverity (lsINFO)
+    : m_queue (queueCapacity)
+    , m_dropped (0)
+    , m_droppedTotal (0)
+    , m_minSeverity (lsINFO)
+    , m_stop (false)
 {
+    m_thread = std::thread (&LogSink::run, this);
 }
 
 LogSink::~LogSink ()
 {
+    {
+        std::lock_guard <std::mutex> lock (m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one ();
+    m_thread.join ();
+
+    flush ();
 }
 
 LogSeverity LogSink::getMinSeverity ()
 {
-    ScopedLockType lock (m_mutex);
-
-    return m_minSeverity;
+    return m_minSeverity.load ();
 }
 
 void LogSink::setMinSeverity (LogSeverity s, bool all)
 {
-    ScopedLockType lock (m_mutex);
-
-    m_minSeverity = s;
+    m_minSeverity.store (s);
 
     if (all)
         LogPartition::setSeverity (s);
@@ -49,7 +58,17 @@ void LogSink::setMinSeverity (LogSeverity s, bool all)
 
 void LogSink::setLogFile (boost::filesystem::path const& path)
 {
-    bool const wasOpened = m_logFile.open (path.c_str ());
+    bool wasOpened;
+
+    {
+        ScopedLockType lock (m_mutex);
+
+        // Lines queued so far belong in the old file, if any
+        while (drain (lock))
+            ;
+
+        wasOpened = m_logFile.open (path.c_str ());
+    }
 
     if (! wasOpened)
     {
@@ -61,6 +80,9 @@ std::string LogSink::rotateLog ()
 {
     ScopedLockType lock (m_mutex);
 
+    while (drain (lock))
+        ;
+
     bool const wasOpened = m_logFile.closeAndReopen ();
 
     if (wasOpened)
@@ -78,11 +100,21 @@ void LogSink::format (
     std::string const& message,
     LogSeverity severity,
     std::string const& partitionName)
+{
+    format (output, message, severity, partitionName, std::time (nullptr));
+}
+
+void LogSink::format (
+    std::string& output,
+    std::string const& message,
+    LogSeverity severity,
+    std::string const& partitionName,
+    std::time_t when)
 {
     output.reserve (message.size() + partitionName.size() + 100);
 
     output = boost::posix_time::to_simple_string (
-        boost::posix_time::second_clock::universal_time ());
+        boost::posix_time::from_time_t (when));
 
     output += " ";
     if (! partitionName.empty ())
@@ -111,36 +143,138 @@ void LogSink::format (
 }
 
 void LogSink::write (
-    std::string const& message,
+    std::string message,
     LogSeverity severity,
     std::string const& partitionName)
 {
-    std::string output;
+    enqueue (std::move (message), severity, partitionName,
+        false, severity >= getMinSeverity ());
+}
+
+void LogSink::write (std::string output, LogSeverity severity)
+{
+    enqueue (std::move (output), severity, std::string (),
+        true, severity >= getMinSeverity ());
+}
+
+void LogSink::write (std::string text)
+{
+    enqueue (std::move (text), lsINFO, std::string (), true, true);
+}
 
-    format (output, message, severity, partitionName);
+void LogSink::enqueue (
+    std::string&& message,
+    LogSeverity severity,
+    std::string const& partitionName,
+    bool formatted,
+    bool toStdErr)
+{
+    Entry entry;
+    entry.message = std::move (message);
+    entry.partitionName = partitionName;
+    entry.when = std::time (nullptr);
+    entry.severity = severity;
+    entry.formatted = formatted;
+    entry.toStdErr = toStdErr;
+
+    if (! m_queue.push (std::move (entry)))
+    {
+        m_dropped.fetch_add (1, std::memory_order_relaxed);
+        m_droppedTotal.fetch_add (1, std::memory_order_relaxed);
+    }
 
-    write (output, severity);
+    // The process may be about to go down, don't leave this in the queue
+    if (severity >= lsFATAL)
+        flush ();
 }
 
-void LogSink::write (std::string const& output, LogSeverity severity)
+void LogSink::flush ()
 {
     ScopedLockType lock (m_mutex);
-    write (output, severity >= getMinSeverity(), lock);
+
+    while (drain (lock))
+        ;
 }
 
-void LogSink::write (std::string const& text)
+void LogSink::run ()
 {
-    ScopedLockType lock (m_mutex);
-    write (text, true, lock);
+    for (;;)
+    {
+        {
+            ScopedLockType lock (m_mutex);
+
+            while (drain (lock))
+                ;
+        }
+
+        std::unique_lock <std::mutex> lock (m_wakeMutex);
+
+        if (m_stop)
+            break;
+
+        // Producers never signal, a short nap bounds the delay instead
+        m_wake.wait_for (lock, std::chrono::milliseconds (50));
+
+        if (m_stop)
+            break;
+    }
 }
 
-void LogSink::write (std::string const& line, bool toStdErr, ScopedLockType&)
+bool LogSink::drain (ScopedLockType&)
 {
-    // Does nothing if not open.
-    m_logFile.writeln (line);
+    // Bounded so a flood of messages still gets written in pieces
+    int const maxBatch = 256;
+
+    std::string fileBatch;
+    std::string errBatch;
+    std::string line;
+    Entry entry;
+    int count = 0;
+
+    std::uint64_t const dropped = m_dropped.exchange (0);
+
+    if (dropped != 0)
+    {
+        format (line, std::to_string (dropped) +
+            " log messages were dropped, the writer fell behind",
+                lsWARNING, "LogSink", std::time (nullptr));
+        fileBatch += line;
+        fileBatch += '\n';
+        errBatch += line;
+        errBatch += '\n';
+    }
+
+    while ((count < maxBatch) && m_queue.pop (entry))
+    {
+        ++count;
+
+        if (entry.formatted)
+            line.swap (entry.message);
+        else
+            format (line, entry.message, entry.severity,
+                entry.partitionName, entry.when);
+
+        fileBatch += line;
+        fileBatch += '\n';
+
+        if (entry.toStdErr)
+        {
+            errBatch += line;
+            errBatch += '\n';
+        }
+    }
+
+    if (fileBatch.empty ())
+        return false;
+
+    // Does nothing if not open. Written in one piece, with one flush.
+    fileBatch.resize (fileBatch.size () - 1);
+    m_logFile.writeln (fileBatch);
+
+    if (! errBatch.empty ())
+        std::cerr << errBatch << std::flush;
 
-    if (toStdErr)
-        std::cerr << line << std::endl;
+    return count == maxBatch;
 }
 
 void LogSink::write_console (std::string const& text)
@@ -24,12 +24,28 @@
 #include <boost/filesystem.hpp>
 #include "../../beast/beast/smart_ptr/SharedPtr.h"
 #include "../../beast/modules/beast_core/memory/SharedSingleton.h"
+#include "ripple_basics/containers/BoundedQueue.h"
 #include "ripple_basics/log/LogFile.h"
 #include "ripple_basics/log/LogSeverity.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <thread>
+
 namespace ripple {
 
-/** An endpoint for all logging messages. */
+/** An endpoint for all logging messages.
+
+    Writers only put the raw message on a lock-free queue. A background
+    thread formats the queued messages and writes them to the log file and
+    stderr in batches, so a busy partition at a verbose level costs the
+    calling thread an enqueue rather than a formatted, flushed write under
+    a global lock. When the queue is full the message is dropped and
+    counted; the count is reported in the log once there is room again.
+
+    Fatal messages are written before write() returns.
+*/
 class LogSink
 {
 public:
@@ -60,20 +76,29 @@ public:
         std::string const& message, LogSeverity severity,
             std::string const& partitionName);
 
+    /** Write everything queued so far before returning. */
+    void flush ();
+
+    /** Returns the number of messages dropped because the queue was full. */
+    std::uint64_t getDropped () const
+    {
+        return m_droppedTotal.load (std::memory_order_relaxed);
+    }
+
     /** Write to log output.
         All logging eventually goes through these functios.
         The text should not contain a final newline, it will be automatically
         added as needed.
 
-        @note  This acquires a global mutex.
+        @note  This does not wait for the output, except for lsFATAL.
 
         @param text     The text to write.
         @param toStdErr `true` to also write to std::cerr
     */
     /** @{ */
-    void write (std::string const& message, LogSeverity severity, std::string const& partitionName);
-    void write (std::string const& text, LogSeverity severity);
-    void write (std::string const& text);
+    void write (std::string message, LogSeverity severity, std::string const& partitionName);
+    void write (std::string text, LogSeverity severity);
+    void write (std::string text);
     void write_console (std::string const& text);
     /** @} */
 
@@ -93,15 +118,49 @@ private:
         /** Maximum line length for log messages.
             If the message exceeds this length it will be truncated with elipses.
         */
-        maximumMessageCharacters = 12 * 1024
+        maximumMessageCharacters = 12 * 1024,
+
+        /** Messages that may wait for the writer thread. */
+        queueCapacity = 16 * 1024
     };
 
-    void write (std::string const& line, bool toStdErr, ScopedLockType&);
+    struct Entry
+    {
+        std::string message;
+        std::string partitionName;
+        std::time_t when;
+        LogSeverity severity;
+        bool formatted;
+        bool toStdErr;
+    };
+
+    void format (std::string& output, std::string const& message,
+        LogSeverity severity, std::string const& partitionName,
+            std::time_t when);
+
+    void enqueue (std::string&& message, LogSeverity severity,
+        std::string const& partitionName, bool formatted, bool toStdErr);
 
+    void run ();
+
+    // Writes out what is queued. Returns false if there was nothing.
+    bool drain (ScopedLockType&);
+
+    BoundedQueue <Entry> m_queue;
+    std::atomic <std::uint64_t> m_dropped;
+    std::atomic <std::uint64_t> m_droppedTotal;
+
+    // Held by whoever writes to the file: the writer thread, a fatal
+    // message, and setLogFile/rotateLog.
     LockType m_mutex;
 
     LogFile m_logFile;
-    LogSeverity m_minSeverity;
+    std::atomic <LogSeverity> m_minSeverity;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+    std::thread m_thread;
 };
 
 } // ripple
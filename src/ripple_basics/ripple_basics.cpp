@@ -43,6 +43,7 @@
 
 //------------------------------------------------------------------------------
 
+#include "containers/BoundedQueue.cpp"
 #include "containers/RangeSet.cpp"
 #include "system/CheckLibraryVersions.cpp"
 
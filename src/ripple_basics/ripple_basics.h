@@ -42,6 +42,8 @@ using beast::Zero;
 
 #include "types/BasicTypes.h"
 
+#include "containers/BoundedQueue.h"
+
 #  include "log/LogSeverity.h"
 #  include "log/LogFile.h"
 # include "log/LogSink.h"
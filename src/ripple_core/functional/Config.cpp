@@ -105,6 +105,8 @@ Config::Config ()
     WEBSOCKET_PROXY_SECURE  = 1;
     WEBSOCKET_SECURE        = 0;
     WEBSOCKET_PING_FREQ     = (5 * 60);
+    WEBSOCKET_SEND_QUEUE_LIMIT = 16 * 1024 * 1024;
+    WEBSOCKET_DISCONNECT_SLOW  = true;
     NUMBER_CONNECTIONS      = 30;
 
     // a new ledger every minute
@@ -128,6 +130,7 @@ Config::Config ()
 
     NETWORK_QUORUM          = 1;
     VALIDATION_QUORUM       = 1;    // Only need one node to vouch
+    SAVE_VALIDATIONS        = true;
 
     CONSENSUS_THRESHOLD     = 80;   // 80% of the unl should be in consensus
 
@@ -140,11 +143,13 @@ Config::Config ()
 
     LEDGER_HISTORY          = 256;
     FETCH_DEPTH             = 1000000000;
+    FETCH_REQUESTS_PER_PEER = 4;
 
     PATH_SEARCH_OLD         = DEFAULT_PATH_SEARCH_OLD;
     PATH_SEARCH             = DEFAULT_PATH_SEARCH;
     PATH_SEARCH_FAST        = DEFAULT_PATH_SEARCH_FAST;
     PATH_SEARCH_MAX         = DEFAULT_PATH_SEARCH_MAX;
+    PATH_FIND_THREADS       = 2;
 
     ACCOUNT_PROBE_MAX       = 10;
 
@@ -158,6 +163,7 @@ Config::Config ()
     START_UP                = NORMAL;
 
     DATABASE_TIMEOUTMS      = 10000;
+    DATABASE_READERS        = 4;
 }
 
 void Config::setup (const std::string& strConf, bool bQuiet)
@@ -173,6 +179,7 @@ void Config::setup (const std::string& strConf, bool bQuiet)
 
     QUIET       = bQuiet;
     NODE_SIZE   = 0;
+    MEMORY_BUDGET = 0;
 
     strDbPath           = Helpers::getDatabaseDirName ();
     strConfFile         = strConf.empty () ? Helpers::getConfigFileName () : strConf;
@@ -356,6 +363,9 @@ void Config::load ()
                 }
             }
 
+            if (SectionSingleB (secConfig, SECTION_DATABASE_READERS, strTemp))
+                DATABASE_READERS    = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
             (void) SectionSingleB (secConfig, SECTION_VALIDATORS_SITE, VALIDATORS_SITE);
 
             (void) SectionSingleB (secConfig, SECTION_PEER_IP, PEER_IP);
@@ -454,6 +464,9 @@ void Config::load ()
                 }
             }
 
+            if (SectionSingleB (secConfig, SECTION_MEMORY_BUDGET, strTemp))
+                MEMORY_BUDGET       = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
             if (SectionSingleB (secConfig, SECTION_ELB_SUPPORT, strTemp))
                 ELB_SUPPORT         = beast::lexicalCastThrow <bool> (strTemp);
 
@@ -484,6 +497,19 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_WEBSOCKET_PING_FREQ, strTemp))
                 WEBSOCKET_PING_FREQ = beast::lexicalCastThrow <int> (strTemp);
 
+            if (SectionSingleB (secConfig, SECTION_WEBSOCKET_SEND_QUEUE_LIMIT, strTemp))
+                WEBSOCKET_SEND_QUEUE_LIMIT = beast::lexicalCastThrow <int> (strTemp);
+
+            if (SectionSingleB (secConfig, SECTION_WEBSOCKET_SLOW_CLIENT, strTemp))
+            {
+                if (strTemp == "disconnect")
+                    WEBSOCKET_DISCONNECT_SLOW = true;
+                else if (strTemp == "drop")
+                    WEBSOCKET_DISCONNECT_SLOW = false;
+                else
+                    throw std::runtime_error ("[" SECTION_WEBSOCKET_SLOW_CLIENT "] must be 'drop' or 'disconnect'.");
+            }
+
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_CERT, WEBSOCKET_SSL_CERT);
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_CHAIN, WEBSOCKET_SSL_CHAIN);
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_KEY, WEBSOCKET_SSL_KEY);
@@ -546,6 +572,9 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_VALIDATION_QUORUM, strTemp))
                 VALIDATION_QUORUM   = std::max (0, beast::lexicalCastThrow <int> (strTemp));
 
+            if (SectionSingleB (secConfig, SECTION_VALIDATION_SAVE, strTemp))
+                SAVE_VALIDATIONS    = beast::lexicalCastThrow <bool> (strTemp);
+
             if (SectionSingleB(secConfig, SECTION_CONSENSUS_THRESHOLD, strTemp))
                 CONSENSUS_THRESHOLD = beast::lexicalCastThrow <int>(strTemp);
 
@@ -595,6 +624,13 @@ void Config::load ()
                 if (FETCH_DEPTH < 10)
                     FETCH_DEPTH = 10;
             }
+            if (SectionSingleB (secConfig, SECTION_FETCH_REQUESTS_PER_PEER, strTemp))
+            {
+                FETCH_REQUESTS_PER_PEER = beast::lexicalCastThrow <int> (strTemp);
+
+                if (FETCH_REQUESTS_PER_PEER < 1)
+                    FETCH_REQUESTS_PER_PEER = 1;
+            }
 
             if (SectionSingleB (secConfig, SECTION_PATH_SEARCH_OLD, strTemp))
                 PATH_SEARCH_OLD     = beast::lexicalCastThrow <int> (strTemp);
@@ -604,6 +640,13 @@ void Config::load ()
                 PATH_SEARCH_FAST    = beast::lexicalCastThrow <int> (strTemp);
             if (SectionSingleB (secConfig, SECTION_PATH_SEARCH_MAX, strTemp))
                 PATH_SEARCH_MAX     = beast::lexicalCastThrow <int> (strTemp);
+            if (SectionSingleB (secConfig, SECTION_PATH_FIND_THREADS, strTemp))
+            {
+                PATH_FIND_THREADS   = beast::lexicalCastThrow <int> (strTemp);
+
+                if (PATH_FIND_THREADS < 1)
+                    PATH_FIND_THREADS = 1;
+            }
 
             if (SectionSingleB (secConfig, SECTION_ACCOUNT_PROBE_MAX, strTemp))
                 ACCOUNT_PROBE_MAX   = beast::lexicalCastThrow <int> (strTemp);
@@ -651,6 +694,7 @@ int Config::getSize (SizedItemName item)
 
         { siLedgerSize,         {   32,     64,    128,    256,        0       } },
         { siLedgerAge,          {   30,     90,     180,    240,        900     } },
+        { siLedgerHistoryMB,    {   16,     32,     64,     128,        256     } },
 
         { siHashNodeDBCache,    {   4,      12,     24,     64,         128      } },
         { siTxnDBCache,         {   4,      12,     24,     64,         128      } },
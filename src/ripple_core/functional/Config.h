@@ -77,6 +77,7 @@ enum SizedItemName
     siSLECacheAge,
     siLedgerSize,
     siLedgerAge,
+    siLedgerHistoryMB,
     siLedgerFetch,
     siHashNodeDBCache,
     siTxnDBCache,
@@ -381,6 +382,7 @@ public:
     // Database
     std::string                 DATABASE_PATH;
     int                         DATABASE_TIMEOUTMS;
+    int                         DATABASE_READERS;   // Read-only connections per database, 0 to share the writer
 
     // Network parameters
     int                         NETWORK_START_TIME;     // The Unix time we start ledger 0.
@@ -404,6 +406,7 @@ public:
     // Note: The following parameters do not relate to the UNL or trust at all
     unsigned int                NETWORK_QUORUM;         // Minimum number of nodes to consider the network present
     int                         VALIDATION_QUORUM;      // Minimum validations to consider ledger authoritative
+    bool                        SAVE_VALIDATIONS;       // Write superseded validations to the Validations table
     int                         CONSENSUS_THRESHOLD;    // minimum number of peers required to enter consensus
 
     // Peer networking parameters
@@ -432,6 +435,14 @@ public:
 
     int                         WEBSOCKET_PING_FREQ;
 
+    // Bytes a websocket client may have waiting to be sent before stream
+    // messages are refused, zero for no limit.
+    int                         WEBSOCKET_SEND_QUEUE_LIMIT;
+
+    // Whether a client over the limit is disconnected, or just misses
+    // stream messages until it catches up.
+    bool                        WEBSOCKET_DISCONNECT_SLOW;
+
     std::string                 WEBSOCKET_SSL_CERT;
     std::string                 WEBSOCKET_SSL_CHAIN;
     std::string                 WEBSOCKET_SSL_KEY;
@@ -455,6 +466,7 @@ public:
     int                         PATH_SEARCH;
     int                         PATH_SEARCH_FAST;
     int                         PATH_SEARCH_MAX;
+    int                         PATH_FIND_THREADS;      // Workers updating path_find requests
 
     // Validation
     RippleAddress               VALIDATION_SEED, VALIDATION_PUB, VALIDATION_PRIV;
@@ -475,6 +487,10 @@ public:
     std::uint32_t                      LEDGER_HISTORY;
     std::uint32_t                      FETCH_DEPTH;
     int                         NODE_SIZE;
+    int                         MEMORY_BUDGET;      // Megabytes shared by the caches, 0 to size them by NODE_SIZE
+
+    // Ledger acquisition: node requests kept in flight to each peer
+    int                         FETCH_REQUESTS_PER_PEER;
 
     // Client behavior
     int                         ACCOUNT_PROBE_MAX;      // How far to scan for accounts.
@@ -40,6 +40,7 @@ struct ConfigSection
 #define SECTION_CLUSTER_NODES           "cluster_nodes"
 #define SECTION_CONSENSUS_THRESHOLD     "consensus_threshold"
 #define SECTION_DATABASE_PATH           "database_path"
+#define SECTION_DATABASE_READERS        "database_readers"
 #define SECTION_DATABASE_TIMEOUT        "database_timeout_ms"
 #define SECTION_DEBUG_LOGFILE           "debug_logfile"
 #define SECTION_DONT_WALK_LOADED_LEDGER "dont_walk"
@@ -52,10 +53,12 @@ struct ConfigSection
 #define SECTION_FEE_ACCOUNT_RESERVE     "fee_account_reserve"
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
+#define SECTION_FETCH_REQUESTS_PER_PEER "fetch_requests_per_peer"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
 #define SECTION_IPS_FIXED               "ips_fixed"
+#define SECTION_MEMORY_BUDGET           "memory_budget"
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
 #define SECTION_NODE_SIZE               "node_size"
@@ -63,6 +66,7 @@ struct ConfigSection
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
 #define SECTION_PATH_SEARCH_MAX         "path_search_max"
+#define SECTION_PATH_FIND_THREADS       "path_find_threads"
 #define SECTION_PEER_CONNECT_LOW_WATER  "peer_connect_low_water"
 #define SECTION_PEER_IP                 "peer_ip"
 #define SECTION_PEER_PORT               "peer_port"
@@ -97,6 +101,7 @@ struct ConfigSection
 #define SECTION_SSL_VERIFY_DIR          "ssl_verify_dir"
 #define SECTION_VALIDATORS_FILE         "validators_file"
 #define SECTION_VALIDATION_QUORUM       "validation_quorum"
+#define SECTION_VALIDATION_SAVE         "validation_save"
 #define SECTION_VALIDATION_SEED         "validation_seed"
 #define SECTION_WEBSOCKET_PUBLIC_IP     "websocket_public_ip"
 #define SECTION_WEBSOCKET_PUBLIC_PORT   "websocket_public_port"
@@ -105,6 +110,8 @@ struct ConfigSection
 #define SECTION_WEBSOCKET_PROXY_PORT   "websocket_proxy_port"
 #define SECTION_WEBSOCKET_PROXY_SECURE "websocket_proxy_secure"
 #define SECTION_WEBSOCKET_PING_FREQ     "websocket_ping_frequency"
+#define SECTION_WEBSOCKET_SEND_QUEUE_LIMIT "websocket_send_queue_limit"
+#define SECTION_WEBSOCKET_SLOW_CLIENT   "websocket_slow_client"
 #define SECTION_WEBSOCKET_IP            "websocket_ip"
 #define SECTION_WEBSOCKET_PORT          "websocket_port"
 #define SECTION_WEBSOCKET_SECURE        "websocket_secure"
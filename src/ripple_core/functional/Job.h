@@ -47,6 +47,7 @@ enum JobType
     jtCLIENT,        // A websocket command from the client
     jtRPC,           // A websocket command from the client
     jtUPDATE_PF,     // Update pathfinding requests
+    jtPATH_FIND,     // Update some of a pass's pathfinding requests
     jtTRANSACTION,   // A transaction received from the network
     jtUNL,           // A Score or Fetch of the UNL (DEPRECATED)
     jtADVANCE,       // Advance validated/acquired ledgers
@@ -67,7 +68,6 @@ enum JobType
     jtDISK          ,
     jtTXN_PROC      ,
     jtOB_SETUP      ,
-    jtPATH_FIND     ,
     jtHO_READ       ,
     jtHO_WRITE      ,
     jtGENERIC       ,   // Used just to measure time
@@ -108,6 +108,9 @@ public:
     {
         ScopedLock lock (m_mutex);
         job_count = m_jobSet.size ();
+
+        for (auto& x : m_jobData)
+            x.second.collect ();
     }
 
     void addJob (JobType type, std::string const& name,
@@ -344,7 +347,72 @@ public:
         return ret;
     }
 
+    Json::Value getLatencyJson (std::string const& jobType, bool byName)
+    {
+        Json::Value ret (Json::objectValue);
+
+        ret["unit"] = "us";
+
+        Json::Value types (Json::arrayValue);
+
+        for (auto& x : m_jobData)
+        {
+            JobTypeData& data (x.second);
+
+            if (! jobType.empty () && jobType != data.name ())
+                continue;
+
+            LatencyHistogram::Snapshot const waiting (
+                data.load ().waiting ().snapshot ());
+            LatencyHistogram::Snapshot const running (
+                data.load ().running ().snapshot ());
+
+            if (waiting.count == 0 && running.count == 0)
+                continue;
+
+            Json::Value& entry (types.append (Json::objectValue));
+
+            entry["job_type"] = data.name ();
+            entry["queue"] = getLatencyJson (waiting);
+            entry["execute"] = getLatencyJson (running);
+
+            if (byName)
+            {
+                Json::Value names (Json::arrayValue);
+
+                for (auto const& named : data.load ().getNamedSnapshots ())
+                {
+                    Json::Value& item (names.append (Json::objectValue));
+                    item["name"] = named.name;
+                    item["queue"] = getLatencyJson (named.waiting);
+                    item["execute"] = getLatencyJson (named.running);
+                }
+
+                entry["names"] = names;
+            }
+        }
+
+        ret["job_types"] = types;
+
+        return ret;
+    }
+
 private:
+    static Json::Value getLatencyJson (LatencyHistogram::Snapshot const& s)
+    {
+        Json::Value ret (Json::objectValue);
+
+        ret["count"] = static_cast <Json::UInt> (s.count);
+        ret["mean"] = static_cast <Json::UInt> (s.mean ());
+        ret["p50"] = static_cast <Json::UInt> (s.percentile (50));
+        ret["p90"] = static_cast <Json::UInt> (s.percentile (90));
+        ret["p99"] = static_cast <Json::UInt> (s.percentile (99));
+        ret["p999"] = static_cast <Json::UInt> (s.percentile (99.9));
+        ret["max"] = static_cast <Json::UInt> (s.max);
+
+        return ret;
+    }
+
     //--------------------------------------------------------------------------
     JobTypeData& getJobTypeData (JobType type)
     {
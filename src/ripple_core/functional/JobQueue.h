@@ -70,6 +70,13 @@ public:
     virtual bool isOverloaded () = 0;
 
     virtual Json::Value getJson (int c = 0) = 0;
+
+    /** Returns queue-wait and execution time distributions.
+        @param jobType If not empty, only this job type is reported.
+        @param byName `true` to break each job type down by job name.
+    */
+    virtual Json::Value getLatencyJson (
+        std::string const& jobType, bool byName) = 0;
 };
 
 std::unique_ptr <JobQueue> make_JobQueue (beast::insight::Collector::ptr const& collector,
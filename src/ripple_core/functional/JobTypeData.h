@@ -50,6 +50,16 @@ public:
     beast::insight::Event dequeue;
     beast::insight::Event execute;
 
+    /* Latency percentiles over the last collection interval, in microseconds */
+    beast::insight::Gauge dequeue_p50;
+    beast::insight::Gauge dequeue_p99;
+    beast::insight::Gauge execute_p50;
+    beast::insight::Gauge execute_p99;
+
+    /* The histograms as of the last collection, to compute intervals */
+    LatencyHistogram::Snapshot lastWaiting;
+    LatencyHistogram::Snapshot lastRunning;
+
     explicit JobTypeData (JobTypeInfo const& info_, 
             beast::insight::Collector::ptr const& collector) noexcept
         : m_collector (collector)
@@ -67,6 +77,14 @@ public:
             dequeue = m_collector->make_event (info.name () + "_q");
             execute = m_collector->make_event (info.name ());
         }
+
+        if (info.type () != jtINVALID)
+        {
+            dequeue_p50 = m_collector->make_gauge (info.name () + "_q_p50_us");
+            dequeue_p99 = m_collector->make_gauge (info.name () + "_q_p99_us");
+            execute_p50 = m_collector->make_gauge (info.name () + "_p50_us");
+            execute_p99 = m_collector->make_gauge (info.name () + "_p99_us");
+        }
     }
 
     /* Not copy-constructible or assignable */
@@ -92,6 +110,35 @@ public:
     {
         return m_load.getStats ();
     }
+
+    /* Publish the percentiles of the samples added since the last call */
+    void collect ()
+    {
+        LatencyHistogram::Snapshot const waiting (
+            m_load.waiting ().snapshot ());
+        LatencyHistogram::Snapshot const running (
+            m_load.running ().snapshot ());
+
+        LatencyHistogram::Snapshot const waitingInterval (
+            waiting.since (lastWaiting));
+        LatencyHistogram::Snapshot const runningInterval (
+            running.since (lastRunning));
+
+        if (waitingInterval.count != 0)
+        {
+            dequeue_p50 = waitingInterval.percentile (50);
+            dequeue_p99 = waitingInterval.percentile (99);
+        }
+
+        if (runningInterval.count != 0)
+        {
+            execute_p50 = runningInterval.percentile (50);
+            execute_p99 = runningInterval.percentile (99);
+        }
+
+        lastWaiting = waiting;
+        lastRunning = running;
+    }
 };
 
 }
@@ -67,6 +67,10 @@ public:
         add (jtUPDATE_PF,     "updatePaths",
             maxLimit, true,   false, 0,     0);
 
+        // Update some of a pass's pathfinding requests
+        add (jtPATH_FIND,     "pathFind",
+            maxLimit, true,   false, 0,     0);
+
         // A websocket command from the client
         add (jtCLIENT,        "clientCommand",
             maxLimit, true,   false, 2000,  5000);
@@ -147,9 +151,6 @@ public:
         add (jtOB_SETUP,      "orderBookSetup",
             0,        false,  true,  0,     0);
 
-        add (jtPATH_FIND,     "pathFind",
-            0,        false,  true,  0,     0);
-
         add (jtHO_READ,       "nodeRead",
             0,        false,  true,  0,     0);
 
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+class LatencyHistogram_test : public beast::unit_test::suite
+{
+public:
+    void testBuckets ()
+    {
+        testcase ("buckets");
+
+        bool contiguous (true);
+        bool contains (true);
+
+        for (int i = 1; i < LatencyHistogram::bucketCount; ++i)
+        {
+            if (LatencyHistogram::lowerBound (i) !=
+                    LatencyHistogram::upperBound (i - 1) + 1)
+                contiguous = false;
+
+            if (LatencyHistogram::bucketIndex (
+                    LatencyHistogram::lowerBound (i)) != i ||
+                LatencyHistogram::bucketIndex (
+                    LatencyHistogram::upperBound (i)) != i)
+                contains = false;
+        }
+
+        expect (contiguous, "buckets should be contiguous");
+        expect (contains, "bucket bounds should map back to the bucket");
+
+        expect (LatencyHistogram::bucketIndex (0) == 0);
+        expect (LatencyHistogram::bucketIndex (15) == 15);
+        expect (LatencyHistogram::bucketIndex (16) == 16);
+        expect (LatencyHistogram::bucketIndex (std::uint64_t (-1)) ==
+            LatencyHistogram::bucketCount - 1);
+
+        // Relative error of a bucket is bounded by the sub-bucket count
+        for (int i = LatencyHistogram::linearBuckets;
+            i < LatencyHistogram::bucketCount; ++i)
+        {
+            std::uint64_t const lo (LatencyHistogram::lowerBound (i));
+            std::uint64_t const hi (LatencyHistogram::upperBound (i));
+            if ((hi - lo) * LatencyHistogram::subBuckets > lo)
+            {
+                fail ("bucket too wide");
+                return;
+            }
+        }
+        pass ();
+    }
+
+    void testPercentiles ()
+    {
+        testcase ("percentiles");
+
+        LatencyHistogram h;
+
+        expect (h.snapshot ().percentile (99) == 0);
+
+        for (std::uint64_t i = 1; i <= 1000; ++i)
+            h.record (i);
+
+        LatencyHistogram::Snapshot const s (h.snapshot ());
+
+        expect (s.count == 1000);
+        expect (s.max == 1000);
+        expect (s.mean () == 500);
+
+        std::uint64_t const p50 (s.percentile (50));
+        std::uint64_t const p99 (s.percentile (99));
+
+        expect (p50 >= 500 && p50 <= 500 + 500 / 8, "p50 out of range");
+        expect (p99 >= 990 && p99 <= 1000, "p99 out of range");
+        expect (s.percentile (100) == 1000);
+
+        h.record (std::chrono::milliseconds (20));
+
+        LatencyHistogram::Snapshot const delta (h.snapshot ().since (s));
+
+        expect (delta.count == 1);
+        expect (delta.sum == 20000);
+        expect (delta.percentile (50) >= 20000);
+        expect (delta.percentile (50) <= 20000 + 20000 / 8);
+
+        h.reset ();
+        expect (h.snapshot ().count == 0);
+    }
+
+    void run ()
+    {
+        testBuckets ();
+        testPercentiles ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LatencyHistogram,ripple_core,ripple);
+
+} // ripple
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_LATENCYHISTOGRAM_H_INCLUDED
+#define RIPPLE_CORE_LATENCYHISTOGRAM_H_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ripple {
+
+/** A fixed-size, log-linear histogram of latencies.
+
+    Values are recorded in microseconds. Small values get one bucket each,
+    larger values are grouped by power of two with eight linear sub-buckets
+    per group, so every bucket is within 12.5% of the values it holds (the
+    same layout HdrHistogram uses with three significant bits).
+
+    Recording is wait-free: it is a handful of relaxed atomic increments,
+    cheap enough to leave on for every job. Readers take a Snapshot, which
+    may be very slightly torn with respect to concurrent writers.
+*/
+class LatencyHistogram
+{
+public:
+    typedef std::chrono::microseconds duration;
+
+    /** Values below this get a bucket of their own. */
+    static int const linearBuckets = 16;
+
+    /** Sub-buckets per power of two above the linear range. */
+    static int const subBucketBits = 3;
+    static int const subBuckets = 1 << subBucketBits;
+
+    /** Powers of two covered; anything larger lands in the last bucket. */
+    static int const maxExponent = 40;
+
+    static int const bucketCount =
+        linearBuckets + (maxExponent - 4) * subBuckets;
+
+    //--------------------------------------------------------------------------
+
+    /** A consistent copy of the histogram that can be queried. */
+    struct Snapshot
+    {
+        Snapshot ()
+            : count (0)
+            , sum (0)
+            , max (0)
+        {
+            buckets.fill (0);
+        }
+
+        std::array <std::uint64_t, bucketCount> buckets;
+        std::uint64_t count;
+        std::uint64_t sum;
+        std::uint64_t max;
+
+        /** Returns the samples added since an earlier snapshot.
+            The maximum of the interval is estimated from its buckets.
+        */
+        Snapshot since (Snapshot const& earlier) const
+        {
+            Snapshot result;
+
+            for (int i = 0; i < bucketCount; ++i)
+            {
+                result.buckets [i] = buckets [i] - earlier.buckets [i];
+                if (result.buckets [i] != 0)
+                    result.max = upperBound (i);
+            }
+
+            result.count = count - earlier.count;
+            result.sum = sum - earlier.sum;
+            return result;
+        }
+
+        /** Returns the mean in microseconds, or zero if empty. */
+        std::uint64_t mean () const
+        {
+            return (count == 0) ? 0 : (sum / count);
+        }
+
+        /** Returns the value at the given percentile, in microseconds.
+            The result is the upper bound of the bucket holding the sample,
+            clamped to the largest value seen.
+        */
+        std::uint64_t percentile (double p) const
+        {
+            std::uint64_t total (0);
+            for (auto const n : buckets)
+                total += n;
+
+            if (total == 0)
+                return 0;
+
+            std::uint64_t rank (static_cast <std::uint64_t> (
+                (p / 100.0) * total + 0.5));
+            if (rank == 0)
+                rank = 1;
+            if (rank > total)
+                rank = total;
+
+            std::uint64_t seen (0);
+            for (int i = 0; i < bucketCount; ++i)
+            {
+                seen += buckets [i];
+                if (seen >= rank)
+                {
+                    std::uint64_t const value (upperBound (i));
+                    return (max != 0 && value > max) ? max : value;
+                }
+            }
+
+            return max;
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    LatencyHistogram ()
+    {
+        reset ();
+    }
+
+    LatencyHistogram (LatencyHistogram const&) = delete;
+    LatencyHistogram& operator= (LatencyHistogram const&) = delete;
+
+    template <class Rep, class Period>
+    void record (std::chrono::duration <Rep, Period> const& value)
+    {
+        auto const us (std::chrono::duration_cast <duration> (value).count ());
+        record (static_cast <std::uint64_t> ((us < 0) ? 0 : us));
+    }
+
+    /** Records a single sample, in microseconds. */
+    void record (std::uint64_t us)
+    {
+        m_buckets [bucketIndex (us)].fetch_add (1, std::memory_order_relaxed);
+        m_count.fetch_add (1, std::memory_order_relaxed);
+        m_sum.fetch_add (us, std::memory_order_relaxed);
+
+        std::uint64_t prev (m_max.load (std::memory_order_relaxed));
+        while (prev < us && ! m_max.compare_exchange_weak (
+            prev, us, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    Snapshot snapshot () const
+    {
+        Snapshot s;
+        for (int i = 0; i < bucketCount; ++i)
+            s.buckets [i] = m_buckets [i].load (std::memory_order_relaxed);
+        s.count = m_count.load (std::memory_order_relaxed);
+        s.sum = m_sum.load (std::memory_order_relaxed);
+        s.max = m_max.load (std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset ()
+    {
+        for (auto& bucket : m_buckets)
+            bucket.store (0, std::memory_order_relaxed);
+        m_count.store (0, std::memory_order_relaxed);
+        m_sum.store (0, std::memory_order_relaxed);
+        m_max.store (0, std::memory_order_relaxed);
+    }
+
+    //--------------------------------------------------------------------------
+
+    /** Returns the bucket a value in microseconds is counted in. */
+    static int bucketIndex (std::uint64_t us)
+    {
+        if (us < linearBuckets)
+            return static_cast <int> (us);
+
+        int exponent (log2 (us));
+        if (exponent >= maxExponent)
+            return bucketCount - 1;
+
+        int const sub (static_cast <int> (
+            (us >> (exponent - subBucketBits)) & (subBuckets - 1)));
+
+        return linearBuckets + (exponent - 4) * subBuckets + sub;
+    }
+
+    /** Returns the smallest value counted in a bucket. */
+    static std::uint64_t lowerBound (int index)
+    {
+        if (index < linearBuckets)
+            return index;
+
+        int const exponent ((index - linearBuckets) / subBuckets + 4);
+        int const sub ((index - linearBuckets) % subBuckets);
+
+        return std::uint64_t (subBuckets + sub) <<
+            (exponent - subBucketBits);
+    }
+
+    /** Returns the largest value counted in a bucket. */
+    static std::uint64_t upperBound (int index)
+    {
+        if (index < linearBuckets)
+            return index;
+
+        int const exponent ((index - linearBuckets) / subBuckets + 4);
+
+        return lowerBound (index) +
+            (std::uint64_t (1) << (exponent - subBucketBits)) - 1;
+    }
+
+private:
+    static int log2 (std::uint64_t v)
+    {
+        int result (0);
+        while (v >>= 1)
+            ++result;
+        return result;
+    }
+
+    std::array <std::atomic <std::uint64_t>, bucketCount> m_buckets;
+    std::atomic <std::uint64_t> m_count;
+    std::atomic <std::uint64_t> m_sum;
+    std::atomic <std::uint64_t> m_max;
+};
+
+}
+
+#endif
@@ -148,6 +148,14 @@ void LoadMonitor::addLoadSample (LoadEvent const& sample)
             " WaitingTime: " << printElapsed (sample.getSecondsWaiting());
     }
 
+    std::uint64_t const waitingMicroseconds (static_cast <std::uint64_t> (
+        sample.getSecondsWaiting() * 1000000 + 0.5));
+    std::uint64_t const runningMicroseconds (static_cast <std::uint64_t> (
+        sample.getSecondsRunning() * 1000000 + 0.5));
+
+    m_waiting.record (waitingMicroseconds);
+    m_running.record (runningMicroseconds);
+
     // VFALCO NOTE Why does 1 become 0?
     std::size_t latencyMilliseconds (latency.inMilliseconds());
     if (latencyMilliseconds == 1)
@@ -155,6 +163,21 @@ void LoadMonitor::addLoadSample (LoadEvent const& sample)
 
     ScopedLockType sl (mLock);
 
+    {
+        auto iter (m_named.find (name));
+
+        if (iter == m_named.end () && m_named.size () < maxTrackedNames)
+            iter = m_named.emplace (name,
+                std::unique_ptr <NamedHistograms> (
+                    new NamedHistograms)).first;
+
+        if (iter != m_named.end ())
+        {
+            iter->second->waiting.record (waitingMicroseconds);
+            iter->second->running.record (runningMicroseconds);
+        }
+    }
+
     update ();
     ++mCounts;
     ++mLatencyEvents;
@@ -212,6 +235,26 @@ bool LoadMonitor::isOver ()
     return isOverTarget (mLatencyMSAvg / (mLatencyEvents * 4), mLatencyMSPeak / (mLatencyEvents * 4));
 }
 
+std::vector <LoadMonitor::NamedSnapshot> LoadMonitor::getNamedSnapshots ()
+{
+    std::vector <NamedSnapshot> result;
+
+    ScopedLockType sl (mLock);
+
+    result.reserve (m_named.size ());
+
+    for (auto const& entry : m_named)
+    {
+        NamedSnapshot named;
+        named.name = entry.first;
+        named.waiting = entry.second->waiting.snapshot ();
+        named.running = entry.second->running.snapshot ();
+        result.push_back (named);
+    }
+
+    return result;
+}
+
 LoadMonitor::Stats LoadMonitor::getStats ()
 {
     Stats stats;
@@ -20,7 +20,7 @@
 #ifndef RIPPLE_LOADMONITOR_H_INCLUDED
 #define RIPPLE_LOADMONITOR_H_INCLUDED
 #include "ripple_core/functional/LoadEvent.h"
-
+#include "ripple_core/functional/LatencyHistogram.h"
 
 namespace ripple {
 
@@ -60,6 +60,33 @@ public:
 
     bool isOver ();
 
+    /** Distribution of time spent waiting before the load started. */
+    LatencyHistogram const& waiting () const
+    {
+        return m_waiting;
+    }
+
+    /** Distribution of time spent running. */
+    LatencyHistogram const& running () const
+    {
+        return m_running;
+    }
+
+    /** Latency distributions for a single named load. */
+    struct NamedSnapshot
+    {
+        std::string name;
+        LatencyHistogram::Snapshot waiting;
+        LatencyHistogram::Snapshot running;
+    };
+
+    /** Returns the distributions of each distinct load name seen.
+        Only the first maxTrackedNames distinct names are tracked.
+    */
+    std::vector <NamedSnapshot> getNamedSnapshots ();
+
+    static std::size_t const maxTrackedNames = 32;
+
 private:
     static std::string printElapsed (double seconds);
 
@@ -76,6 +103,18 @@ private:
     std::uint64_t mTargetLatencyAvg;
     std::uint64_t mTargetLatencyPk;
     int           mLastUpdate;
+
+    LatencyHistogram m_waiting;
+    LatencyHistogram m_running;
+
+    struct NamedHistograms
+    {
+        LatencyHistogram waiting;
+        LatencyHistogram running;
+    };
+
+    // Protected by mLock
+    std::map <std::string, std::unique_ptr <NamedHistograms>> m_named;
 };
 
 } // ripple
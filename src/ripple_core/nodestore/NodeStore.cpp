@@ -28,7 +28,7 @@
 #include "beast/beast/cxx14/memory.h"
 
 #include "ripple/common/seconds_clock.h"
-#include "ripple/common/TaggedCache.h"
+#include "ripple/common/ShardedTaggedCache.h"
 #include "ripple/common/KeyCache.h"
 
 #include "impl/Tuning.h"
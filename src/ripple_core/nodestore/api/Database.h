@@ -121,6 +121,12 @@ public:
     // VFALCO TODO Document this.
     virtual float getCacheHitRate () = 0;
 
+    /** Returns the number of objects held in the cache. */
+    virtual int getCacheSize () = 0;
+
+    /** Returns the estimated bytes held in the cache. */
+    virtual std::size_t getCacheMemoryUsage () = 0;
+
     // VFALCO TODO Document this.
     //        TODO Document the parameter meanings.
     virtual void tune (int size, int age) = 0;
@@ -27,6 +27,18 @@
 #include <chrono>
 
 namespace ripple {
+
+#ifdef ENABLEBACKENDCACHE
+template <>
+struct MemoryEstimate <NodeObject>
+{
+    std::size_t operator() (NodeObject const& object) const
+    {
+        return sizeof (NodeObject) + object.getData ().size ();
+    }
+};
+#endif
+
 namespace NodeStore {
 
 class DatabaseImp
@@ -43,10 +55,10 @@ public:
 
 #ifdef ENABLEBACKENDCACHE
     // Positive cache
-    TaggedCache <uint256, NodeObject> m_cache;
+    ShardedTaggedCache <uint256, NodeObject, uint256::uniform_hasher> m_cache;
 
     // Negative cache
-    KeyCache <uint256> m_negCache;
+    KeyCache <uint256, uint256::uniform_hasher> m_negCache;
 #endif
 
     std::mutex                m_readLock;
@@ -311,6 +323,24 @@ public:
 #endif
     }
 
+    int getCacheSize ()
+    {
+#ifdef ENABLEBACKENDCACHE
+        return m_cache.getCacheSize ();
+#else
+        return 0;
+#endif
+    }
+
+    std::size_t getCacheMemoryUsage ()
+    {
+#ifdef ENABLEBACKENDCACHE
+        return m_cache.getMemoryUsage ();
+#else
+        return 0;
+#endif
+    }
+
     void tune (int size, int age)
     {
 #ifdef ENABLEBACKENDCACHE
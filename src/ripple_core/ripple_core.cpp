@@ -38,6 +38,7 @@
 #include "functional/LoadFeeTrackImp.cpp"
 #include "functional/LoadEvent.cpp"
 #include "functional/LoadMonitor.cpp"
+#include "functional/LatencyHistogram.cpp"
 
 #include "functional/Job.cpp"
 #include "functional/JobQueue.cpp"
@@ -34,6 +34,7 @@
 #include "functional/Config.h"
 #include "functional/LoadFeeTrack.h"
 #  include "functional/LoadEvent.h"
+#  include "functional/LatencyHistogram.h"
 #  include "functional/LoadMonitor.h"
 
 # include "functional/Job.h"
@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+AccountIDCache::AccountIDCache (std::size_t capacity)
+    : mGenerationSize (std::max <std::size_t> (1, capacity / shardCount / 2))
+{
+}
+
+std::string AccountIDCache::get (uint160 const& accountID)
+{
+    Shard& shard (mShards [*accountID.begin () % shardCount]);
+
+    {
+        std::lock_guard <std::mutex> lock (shard.mutex);
+
+        auto it = shard.current.find (accountID);
+
+        if (it != shard.current.end ())
+            return it->second;
+
+        it = shard.previous.find (accountID);
+
+        if (it != shard.previous.end ())
+        {
+            // Still in use, so carry it into the new generation
+            std::string human (it->second);
+            shard.previous.erase (it);
+            shard.current.emplace (accountID, human);
+            return human;
+        }
+    }
+
+    std::string human (encode (accountID));
+
+    std::lock_guard <std::mutex> lock (shard.mutex);
+
+    if (shard.current.size () >= mGenerationSize)
+    {
+        shard.previous.clear ();
+        shard.previous.swap (shard.current);
+    }
+
+    shard.current.emplace (accountID, human);
+    return human;
+}
+
+std::size_t AccountIDCache::size () const
+{
+    std::size_t total = 0;
+
+    for (auto& shard : mShards)
+    {
+        std::lock_guard <std::mutex> lock (shard.mutex);
+        total += shard.current.size () + shard.previous.size ();
+    }
+
+    return total;
+}
+
+std::string AccountIDCache::encode (uint160 const& accountID)
+{
+    unsigned char data [1 + 20];
+
+    data[0] = RippleAddress::VER_ACCOUNT_ID;
+    std::copy (accountID.begin (), accountID.end (), data + 1);
+
+    return Base58::encode (data, data + sizeof (data),
+        Base58::getRippleAlphabet (), true);
+}
+
+AccountIDCache& AccountIDCache::getInstance ()
+{
+    static AccountIDCache instance (250000);
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+
+class AccountIDCache_test : public beast::unit_test::suite
+{
+public:
+    void run ()
+    {
+        AccountIDCache cache (64);
+
+        uint160 hot;
+        hot.SetHex ("B5F762798A53D543A014CAF8B297CFF8F2F937E8");
+
+        std::string const human (RippleAddress::createAccountID (hot).ToString ());
+        expect (AccountIDCache::encode (hot) == human, "Encoding differs");
+        expect (cache.get (hot) == human, "Cold lookup");
+        expect (cache.get (hot) == human, "Cached lookup");
+
+        // Churn through many accounts while using the hot one
+        for (int i = 0; i < 10000; ++i)
+        {
+            uint160 cold;
+            cold.SetHex (std::to_string (i + 1));
+
+            if (cache.get (cold) != AccountIDCache::encode (cold))
+            {
+                fail ("Wrong string for a cold account");
+                return;
+            }
+
+            if (cache.get (hot) != human)
+            {
+                fail ("Wrong string for the hot account");
+                return;
+            }
+        }
+
+        expect (cache.size () <= 64, "Cache grew past its capacity");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountIDCache,ripple_data,ripple);
+
+} // ripple
@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_ACCOUNTIDCACHE_H_INCLUDED
+#define RIPPLE_ACCOUNTIDCACHE_H_INCLUDED
+
+#include <mutex>
+
+namespace ripple {
+
+/** Remembers the human readable form of recently used account IDs.
+
+    Account IDs are encoded for every SQL statement that mirrors a ledger
+    entry and for every account shown in JSON, and a few accounts make up
+    most of them. The cache is split into shards by the first byte of the
+    ID, each with its own lock. A shard keeps two generations of entries:
+    when the newer one fills up it becomes the older one and the oldest
+    entries are dropped, so hot accounts survive the turnover.
+*/
+class AccountIDCache
+{
+public:
+    /** @param capacity The most entries kept, over all shards. */
+    explicit AccountIDCache (std::size_t capacity);
+
+    AccountIDCache (AccountIDCache const&) = delete;
+    AccountIDCache& operator= (AccountIDCache const&) = delete;
+
+    /** Returns the account ID as a human readable string. */
+    std::string get (uint160 const& accountID);
+
+    /** The number of entries, counting both generations. */
+    std::size_t size () const;
+
+    /** The encoding of account IDs, without the cache. */
+    static std::string encode (uint160 const& accountID);
+
+    /** The cache used by RippleAddress. */
+    static AccountIDCache& getInstance ();
+
+private:
+    typedef ripple::unordered_map <uint160, std::string> Map;
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        Map current;
+        Map previous;
+    };
+
+    static std::size_t const shardCount = 16;
+
+    std::size_t mGenerationSize;
+    Shard mShards [shardCount];
+};
+
+} // ripple
+
+#endif
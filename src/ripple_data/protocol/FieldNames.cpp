@@ -21,6 +21,7 @@ namespace ripple {
 
 // These must stay at the top of this file
 std::map<int, SField::ptr> SField::codeToField;
+std::atomic <SField::ptr> SField::knownCodeToField[SField::maxBinaryType][256];
 int SField::num = 0;
 
 
@@ -67,20 +68,56 @@ SField::SField (SerializedTypeID tid, int fv) : fieldCode (FIELD_CODE (tid, fv))
     // call with the map mutex
     fieldName = beast::lexicalCast <std::string> (tid) + "/" +
                 beast::lexicalCast <std::string> (fv);
-    codeToField[fieldCode] = this;
     rawJsonName = getName ();
     jsonName = Json::StaticString (rawJsonName.c_str ());
     assert ((fv != 1) || ((tid != STI_ARRAY) && (tid != STI_OBJECT)));
+    addField (this);
+}
+
+void SField::addField (SField* field)
+{
+#define FIELD(name, type, index)
+#define TYPE(name, type, index) \
+    static_assert (index < maxBinaryType, "Grow knownCodeToField for " #name);
+#include "../protocol/SerializeDeclarations.h"
+#undef FIELD
+#undef TYPE
+
+    codeToField[field->fieldCode] = field;
+
+    if (std::atomic <ptr>* slot = getKnownSlot (field->fieldCode))
+        slot->store (field, std::memory_order_release);
+}
+
+std::atomic <SField::ptr>* SField::getKnownSlot (int code)
+{
+    int const type = code >> 16;
+    int const value = code & 0xffff;
+
+    if ((type <= 0) || (type >= maxBinaryType) || (value <= 0) || (value > 255))
+        return nullptr;
+
+    return &knownCodeToField[type][value];
 }
 
 SField::ref SField::getField (int code)
 {
     int type = code >> 16;
-    int field = code % 0xffff;
+    int field = code & 0xffff;
 
     if ((type <= 0) || (field <= 0))
         return sfInvalid;
 
+    std::atomic <ptr>* const slot = getKnownSlot (code);
+
+    if (slot != nullptr)
+    {
+        ptr const known = slot->load (std::memory_order_acquire);
+
+        if (known != nullptr)
+            return *known;
+    }
+
     StaticScopedLockType sl (getMutex ());
 
     std::map<int, SField::ptr>::iterator it = codeToField.find (code);
@@ -157,6 +194,12 @@ SField::~SField ()
 
     if ((it != codeToField.end ()) && (it->second == this))
         codeToField.erase (it);
+
+    if (std::atomic <ptr>* slot = getKnownSlot (fieldCode))
+    {
+        ptr expected = this;
+        slot->compare_exchange_strong (expected, nullptr);
+    }
 }
 
 } // ripple
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_FIELDNAMES_H
 #define RIPPLE_FIELDNAMES_H
 
+#include <atomic>
 #include <mutex>
 #include "../ripple/json/api/json_value.h"
 
@@ -94,9 +95,10 @@ public:
     {
         StaticScopedLockType sl (getMutex ());
 
-        codeToField[fieldCode] = this;
-
         fieldNum = ++num;
+
+        // Last, since lookups can see the field from here on
+        addField (this);
     }
 
     SField (SerializedTypeID tid, int fv, const char* fn)
@@ -111,9 +113,10 @@ public:
     {
         StaticScopedLockType sl (getMutex ());
 
-        codeToField[fieldCode] = this;
-
         fieldNum = ++num;
+
+        // Last, since lookups can see the field from here on
+        addField (this);
     }
 
     explicit SField (int fc)
@@ -131,6 +134,10 @@ public:
 
     ~SField ();
 
+    /** Returns the field with the given code.
+        Fields with a binary encoding are found without taking a lock.
+        Unknown fields of a known type are created on first use.
+    */
     static SField::ref getField (int fieldCode);
     static SField::ref getField (const std::string& fieldName);
     static SField::ref getField (int type, int value)
@@ -240,6 +247,18 @@ protected:
     static int                  num;
 
     SField (SerializedTypeID id, int val);
+
+private:
+    // Every field that can appear in binary data, by type and value. Slots
+    // are only written with the mutex held, so lookups need no lock.
+    static int const maxBinaryType = 32;
+    static std::atomic <ptr> knownCodeToField[maxBinaryType][256];
+
+    // The slot for a field code, or nullptr if it has no binary encoding
+    static std::atomic <ptr>* getKnownSlot (int fieldCode);
+
+    // Call with the mutex
+    static void addField (SField* field);
 };
 
 extern SField sfInvalid, sfGeneric, sfLedgerEntry, sfTransaction, sfValidation;
@@ -367,12 +367,6 @@ uint160 RippleAddress::getAccountID () const
     }
 }
 
-typedef RippleMutex StaticLockType;
-typedef std::lock_guard <StaticLockType> StaticScopedLockType;
-static StaticLockType s_lock;
-
-static ripple::unordered_map< Blob , std::string > rncMap;
-
 std::string RippleAddress::humanAccountID () const
 {
     switch (nVersion)
@@ -381,23 +375,10 @@ std::string RippleAddress::humanAccountID () const
         throw std::runtime_error ("unset source - humanAccountID");
 
     case VER_ACCOUNT_ID:
-    {
-        StaticScopedLockType sl (s_lock);
-
-        auto it = rncMap.find (vchData);
-
-        if (it != rncMap.end ())
-            return it->second;
+        if (vchData.size () != 20)
+            return ToString ();
 
-        // VFALCO NOTE Why do we throw everything out? We could keep two maps
-        //             here, switch back and forth keep one of them full and clear the
-        //             other on a swap - but always check both maps for cache hits.
-        //
-        if (rncMap.size () > 250000)
-            rncMap.clear ();
-
-        return rncMap[vchData] = ToString ();
-    }
+        return AccountIDCache::getInstance ().get (uint160 (vchData));
 
     case VER_ACCOUNT_PUBLIC:
     {
@@ -519,6 +500,11 @@ RippleAddress RippleAddress::createAccountID (const uint160& uiAccountID)
     return na;
 }
 
+std::string RippleAddress::createHumanAccountID (const uint160& uiAccountID)
+{
+    return AccountIDCache::getInstance ().get (uiAccountID);
+}
+
 //
 // AccountPrivate
 //
@@ -119,10 +119,7 @@ public:
 
     static RippleAddress createAccountID (const uint160& uiAccountID);
 
-    static std::string createHumanAccountID (const uint160& uiAccountID)
-    {
-        return createAccountID (uiAccountID).humanAccountID ();
-    }
+    static std::string createHumanAccountID (const uint160& uiAccountID);
 
     static std::string createHumanAccountID (Blob const& vPrivate)
     {
@@ -0,0 +1,402 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+// The arena that SerializedType allocations on this thread go to
+static thread_local SerializedArena* currentArena = nullptr;
+
+static std::atomic <std::uint64_t> arenaTotal (0);
+static std::atomic <std::uint64_t> blockTotal (0);
+static std::atomic <std::uint64_t> objectTotal (0);
+
+SerializedArena::Scope::Scope (std::size_t sizeHint)
+    : mArena (nullptr)
+{
+    if (currentArena != nullptr)
+        return;
+
+    // The objects take a few times the space of the data they came from
+    std::size_t const blockSize =
+        std::min <std::size_t> (std::max <std::size_t> (sizeHint * 4, 1024), 32768);
+
+    mArena = new SerializedArena (blockSize);
+    currentArena = mArena;
+}
+
+SerializedArena::Scope::~Scope ()
+{
+    if (mArena != nullptr)
+    {
+        currentArena = nullptr;
+        mArena->release ();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+SerializedArena::SerializedArena (std::size_t blockSize)
+    : mBlocks (nullptr)
+    , mNext (nullptr)
+    , mEnd (nullptr)
+    , mNextBlockSize (blockSize)
+    , mRefs (1)
+    , mObjects (0)
+    , mBlockCount (0)
+{
+}
+
+SerializedArena::~SerializedArena ()
+{
+    while (mBlocks != nullptr)
+    {
+        Block* const next = mBlocks->next;
+        ::operator delete (mBlocks);
+        mBlocks = next;
+    }
+
+    arenaTotal.fetch_add (1, std::memory_order_relaxed);
+    blockTotal.fetch_add (mBlockCount, std::memory_order_relaxed);
+    objectTotal.fetch_add (mObjects, std::memory_order_relaxed);
+}
+
+SerializedArena::Stats SerializedArena::getStats ()
+{
+    Stats stats;
+    stats.arenas = arenaTotal.load (std::memory_order_relaxed);
+    stats.blocks = blockTotal.load (std::memory_order_relaxed);
+    stats.objects = objectTotal.load (std::memory_order_relaxed);
+    return stats;
+}
+
+void* SerializedArena::bump (std::size_t size)
+{
+    // Keep every allocation aligned like the first
+    size = (size + sizeof (Header) - 1) & ~(sizeof (Header) - 1);
+
+    if (static_cast <std::size_t> (mEnd - mNext) < size)
+    {
+        std::size_t const blockSize = std::max (mNextBlockSize, size);
+
+        // Block is padded to a Header so the data after it stays aligned
+        std::size_t const offset = (sizeof (Block) + sizeof (Header) - 1) &
+            ~(sizeof (Header) - 1);
+
+        Block* const block = static_cast <Block*> (
+            ::operator new (offset + blockSize));
+        block->next = mBlocks;
+        block->size = blockSize;
+        mBlocks = block;
+        ++mBlockCount;
+
+        mNext = reinterpret_cast <char*> (block) + offset;
+        mEnd = mNext + blockSize;
+        mNextBlockSize = std::min <std::size_t> (mNextBlockSize * 2, 65536);
+    }
+
+    void* const p = mNext;
+    mNext += size;
+    return p;
+}
+
+void SerializedArena::release ()
+{
+    if (mRefs.fetch_sub (1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+void* SerializedArena::allocate (std::size_t size)
+{
+    SerializedArena* const arena = currentArena;
+    Header* header;
+
+    if (arena != nullptr)
+    {
+        header = static_cast <Header*> (arena->bump (sizeof (Header) + size));
+        header->arena = arena;
+        ++arena->mObjects;
+        arena->mRefs.fetch_add (1, std::memory_order_relaxed);
+    }
+    else
+    {
+        header = static_cast <Header*> (::operator new (sizeof (Header) + size));
+        header->arena = nullptr;
+    }
+
+    return header + 1;
+}
+
+void SerializedArena::deallocate (void* p)
+{
+    if (p == nullptr)
+        return;
+
+    Header* const header = static_cast <Header*> (p) - 1;
+
+    if (header->arena == nullptr)
+        ::operator delete (header);
+    else
+        header->arena->release ();
+}
+
+//------------------------------------------------------------------------------
+
+class SerializedArena_test : public beast::unit_test::suite
+{
+public:
+    void testScope ()
+    {
+        testcase ("scope");
+
+        std::unique_ptr <STAmount> survivor;
+        SerializedArena::Stats const before = SerializedArena::getStats ();
+
+        {
+            SerializedArena::Scope arena;
+
+            std::unique_ptr <STUInt32> a (new STUInt32 (sfFlags, 1));
+            {
+                // Nested scopes share the outer arena
+                SerializedArena::Scope inner;
+                survivor.reset (new STAmount (sfBalance, std::uint64_t (5)));
+            }
+            std::unique_ptr <STUInt32> b (new STUInt32 (sfSequence, 2));
+
+            expect (a->getValue () == 1 && b->getValue () == 2);
+        }
+
+        expect (SerializedArena::getStats ().arenas == before.arenas,
+            "The arena should live as long as its objects");
+
+        // Objects made outside any scope use the heap
+        std::unique_ptr <STUInt32> c (new STUInt32 (sfFlags, 3));
+
+        expect (survivor->getNValue () == 5);
+        survivor.reset ();
+
+        SerializedArena::Stats const after = SerializedArena::getStats ();
+        expect (after.arenas == before.arenas + 1);
+        expect (after.objects == before.objects + 3);
+        expect (after.blocks == before.blocks + 1);
+    }
+
+    void testParse ()
+    {
+        testcase ("parse");
+
+        STObject object (sfTransactionMetaData);
+        object.setFieldU32 (sfTransactionIndex, 7);
+
+        STArray nodes (sfAffectedNodes);
+        for (int i = 0; i < 100; ++i)
+        {
+            STObject node (sfModifiedNode);
+            node.setFieldU16 (sfLedgerEntryType, 0x61);
+            node.setFieldH256 (sfLedgerIndex, uint256 (i));
+            nodes.push_back (node);
+        }
+        object.addObject (nodes);
+
+        Serializer s;
+        object.add (s);
+
+        std::unique_ptr <SerializedType> parsed;
+        {
+            SerializedArena::Scope arena (s.getLength ());
+            SerializerIterator sit (s);
+            parsed = STObject::deserialize (sit, sfTransactionMetaData);
+        }
+
+        Serializer again;
+        static_cast <STObject&> (*parsed).add (again);
+        expect (again == s, "Parsing into an arena should round trip");
+    }
+
+    void run ()
+    {
+        testScope ();
+        testParse ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SerializedArena,ripple_data,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times parsing transaction metadata with and without an arena.
+
+    The corpus is read from the file named by TXMETA_BENCH_CORPUS, one hex
+    metadata blob per line such as account_tx returns with "binary", or
+    else made up of metadata touching 2 to 40 nodes. Reports parses per
+    second and the allocations made for field objects each way.
+*/
+class SerializedArenaParse_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    std::vector <Blob> makeCorpus ()
+    {
+        std::vector <Blob> corpus;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            STObject meta (sfTransactionMetaData);
+            meta.setFieldU32 (sfTransactionIndex, i);
+            meta.setFieldU8 (sfTransactionResult, 0);
+
+            STArray nodes (sfAffectedNodes);
+            for (int n = 0; n < 2 + (i % 39); ++n)
+            {
+                STObject fields (sfFinalFields);
+                fields.setFieldU32 (sfFlags, 0);
+                fields.setFieldU32 (sfSequence, n);
+                fields.setFieldAmount (sfBalance, STAmount (std::uint64_t (n) * 1000));
+                fields.setFieldU32 (sfOwnerCount, n % 5);
+
+                STObject previous (sfPreviousFields);
+                previous.setFieldAmount (sfBalance, STAmount (std::uint64_t (n) * 999));
+
+                STObject node (sfModifiedNode);
+                node.setFieldU16 (sfLedgerEntryType, 0x61);
+                node.setFieldH256 (sfLedgerIndex, uint256 (n));
+                node.setFieldH256 (sfPreviousTxnID, uint256 (i));
+                node.setFieldU32 (sfPreviousTxnLgrSeq, i);
+                node.addObject (fields);
+                node.addObject (previous);
+                nodes.push_back (node);
+            }
+
+            meta.addObject (nodes);
+            corpus.push_back (meta.getSerializer ().peekData ());
+        }
+
+        return corpus;
+    }
+
+    std::vector <Blob> loadCorpus (char const* filename)
+    {
+        std::vector <Blob> corpus;
+        std::ifstream in (filename);
+        std::string line;
+
+        while (std::getline (in, line))
+        {
+            std::pair <Blob, bool> const meta (strUnHex (line));
+
+            if (meta.second && !meta.first.empty ())
+                corpus.push_back (meta.first);
+        }
+
+        return corpus;
+    }
+
+    static int countObjects (SerializedType const& object)
+    {
+        int count = 1;
+
+        if (STObject const* o = dynamic_cast <STObject const*> (&object))
+        {
+            for (int i = 0; i < o->getCount (); ++i)
+                count += countObjects (o->peekAtIndex (i));
+        }
+        else if (STArray const* a = dynamic_cast <STArray const*> (&object))
+        {
+            for (auto const& o : *a)
+                count += countObjects (o);
+        }
+
+        return count;
+    }
+
+    std::chrono::milliseconds measure (std::vector <Blob> const& corpus,
+        int rounds, bool useArena)
+    {
+        auto const start = clock_type::now ();
+
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (auto const& blob : corpus)
+            {
+                Serializer s (blob);
+                SerializerIterator sit (s);
+
+                if (useArena)
+                {
+                    SerializedArena::Scope arena (blob.size ());
+                    STObject::deserialize (sit, sfTransactionMetaData);
+                }
+                else
+                {
+                    STObject::deserialize (sit, sfTransactionMetaData);
+                }
+            }
+        }
+
+        return std::chrono::duration_cast <std::chrono::milliseconds> (
+            clock_type::now () - start);
+    }
+
+    void run ()
+    {
+        char const* const filename = std::getenv ("TXMETA_BENCH_CORPUS");
+        std::vector <Blob> const corpus (filename ?
+            loadCorpus (filename) : makeCorpus ());
+
+        if (corpus.empty ())
+        {
+            fail ("Empty corpus");
+            return;
+        }
+
+        std::uint64_t objects = 0;
+        for (auto const& blob : corpus)
+        {
+            Serializer s (blob);
+            SerializerIterator sit (s);
+            objects += countObjects (*STObject::deserialize (sit, sfTransactionMetaData));
+        }
+
+        int const rounds = 200;
+        std::uint64_t const parses = corpus.size () * rounds;
+
+        auto const heap = measure (corpus, rounds, false);
+
+        SerializedArena::Stats const before = SerializedArena::getStats ();
+        auto const arena = measure (corpus, rounds, true);
+        SerializedArena::Stats const after = SerializedArena::getStats ();
+
+        log << corpus.size () << " blobs, " <<
+            double (objects) / corpus.size () << " field objects per parse";
+
+        log << "heap: " << parses * 1000 / std::max <std::int64_t> (1, heap.count ()) <<
+            " parses/s, " << double (objects) / corpus.size () << " allocations per parse";
+
+        log << "arena: " << parses * 1000 / std::max <std::int64_t> (1, arena.count ()) <<
+            " parses/s, " << double ((after.blocks - before.blocks) +
+                (after.arenas - before.arenas)) / parses << " allocations per parse";
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SerializedArenaParse,ripple_data,ripple);
+
+} // ripple
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_SERIALIZEDARENA_H_INCLUDED
+#define RIPPLE_SERIALIZEDARENA_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+
+namespace ripple {
+
+/** Bump allocator for the SerializedType objects made by one parse.
+
+    Parsing a transaction or its metadata makes an object for every field,
+    each of which used to be a heap allocation of its own. While a Scope is
+    active on a thread, SerializedType objects allocated there are carved
+    out of the Scope's arena instead, a few blocks in all. The arena counts
+    its live objects and goes back to the heap as a whole when the Scope
+    and the last of them are gone, so objects may outlive the Scope or be
+    freed on any thread.
+
+    Objects allocated with no Scope active come from the heap as before.
+*/
+class SerializedArena
+{
+public:
+    /** Sends SerializedType allocations on this thread to a new arena.
+        A Scope nested in another shares the outer one's arena.
+        @param sizeHint The size of the data being parsed, if known.
+    */
+    class Scope
+    {
+    public:
+        explicit Scope (std::size_t sizeHint = 0);
+        ~Scope ();
+
+        Scope (Scope const&) = delete;
+        Scope& operator= (Scope const&) = delete;
+
+    private:
+        SerializedArena* mArena;
+    };
+
+    struct Stats
+    {
+        std::uint64_t arenas;
+        std::uint64_t blocks;
+        std::uint64_t objects;
+    };
+
+    /** Totals over the arenas released so far. */
+    static Stats getStats ();
+
+    static void* allocate (std::size_t size);
+    static void deallocate (void* p);
+
+private:
+    struct Block
+    {
+        Block* next;
+        std::size_t size;
+    };
+
+    // Precedes every allocation, keeping the alignment of operator new
+    union Header
+    {
+        SerializedArena* arena;
+        long double align;
+    };
+
+    explicit SerializedArena (std::size_t blockSize);
+    ~SerializedArena ();
+
+    void* bump (std::size_t size);
+    void release ();
+
+    Block* mBlocks;
+    char* mNext;
+    char* mEnd;
+    std::size_t mNextBlockSize;
+
+    // Live objects, plus one for the Scope
+    std::atomic <int> mRefs;
+
+    std::uint64_t mObjects;
+    std::uint64_t mBlockCount;
+};
+
+} // ripple
+
+#endif
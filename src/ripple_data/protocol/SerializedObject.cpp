@@ -156,48 +156,60 @@ bool STObject::setType (const SOTemplate& type)
 
     mType = &type;
 
-    for (SOTemplate::value_type const& elem : type.peek ())
+    // Take the fields out in order and drop each into its template slot,
+    // which the template finds without a search
+    std::vector <std::unique_ptr <SerializedType>> fields (mData.size ());
+
+    for (std::size_t i = fields.size (); i-- != 0;)
+        fields[i].reset (mData.pop_back ().release ());
+
+    std::vector <std::unique_ptr <SerializedType>> slots (type.peek ().size ());
+
+    for (auto& field : fields)
     {
-        bool match = false;
+        int const index = type.getIndex (field->getFName ());
 
-        for (boost::ptr_vector<SerializedType>::iterator it = mData.begin (); it != mData.end (); ++it)
-            if (it->getFName () == elem->e_field)
-            {
-                // matching entry, move to new vector
-                match = true;
+        // The first of any duplicates wins, the rest are leftovers
+        if ((index != -1) && !slots[index])
+            slots[index] = std::move (field);
+    }
 
-                if ((elem->flags == SOE_DEFAULT) && it->isDefault ())
-                {
-                    WriteLog (lsWARNING, STObject) << "setType( " << getFName ().getName () << ") invalid default "
-                                                   << elem->e_field.fieldName;
-                    valid = false;
-                }
+    for (std::size_t i = 0; i < slots.size (); ++i)
+    {
+        SOElement const& elem = *type.peek ()[i];
 
-                newData.push_back (mData.release (it).release ()); // CAUTION: This renders 'it' invalid
-                break;
+        if (slots[i])
+        {
+            if ((elem.flags == SOE_DEFAULT) && slots[i]->isDefault ())
+            {
+                WriteLog (lsWARNING, STObject) << "setType( " << getFName ().getName () << ") invalid default "
+                                               << elem.e_field.fieldName;
+                valid = false;
             }
 
-        if (!match)
+            newData.push_back (slots[i].release ());
+        }
+        else
         {
             // no match found
-            if (elem->flags == SOE_REQUIRED)
+            if (elem.flags == SOE_REQUIRED)
             {
                 WriteLog (lsWARNING, STObject) << "setType( " << getFName ().getName () << ") invalid missing "
-                                               << elem->e_field.fieldName;
+                                               << elem.e_field.fieldName;
                 valid = false;
             }
 
-            newData.push_back (makeNonPresentObject (elem->e_field).release ());
+            newData.push_back (makeNonPresentObject (elem.e_field).release ());
         }
     }
 
-    BOOST_FOREACH (const SerializedType & t, mData)
+    for (auto const& field : fields)
     {
         // Anything left over must be discardable
-        if (!t.getFName ().isDiscardable ())
+        if (field && !field->getFName ().isDiscardable ())
         {
             WriteLog (lsWARNING, STObject) << "setType( " << getFName ().getName () << ") invalid leftover "
-                                           << t.getFName ().getName ();
+                                           << field->getFName ().getName ();
             valid = false;
         }
     }
@@ -449,6 +461,64 @@ uint256 STObject::getSigningHash (std::uint32_t prefix) const
     return s.getSHA512Half ();
 }
 
+static std::size_t getFieldMemoryUsage (SerializedType const& field)
+{
+    switch (field.getSType ())
+    {
+    case STI_OBJECT:
+        return static_cast <STObject const&> (field).getMemoryUsage ();
+
+    case STI_ARRAY:
+    {
+        STArray const& array (static_cast <STArray const&> (field));
+        std::size_t bytes = sizeof (STArray);
+
+        for (STObject const& object : array)
+            bytes += object.getMemoryUsage ();
+
+        return bytes;
+    }
+
+    case STI_VL:
+    case STI_ACCOUNT:
+        return sizeof (STVariableLength) +
+            static_cast <STVariableLength const&> (field).peekValue ().size ();
+
+    case STI_VECTOR256:
+        return sizeof (STVector256) + sizeof (uint256) *
+            static_cast <STVector256 const&> (field).peekValue ().size ();
+
+    case STI_PATHSET:
+    {
+        STPathSet const& paths (static_cast <STPathSet const&> (field));
+        std::size_t bytes = sizeof (STPathSet);
+
+        for (int i = 0; i < paths.size (); ++i)
+            bytes += sizeof (STPath) +
+                paths.getPath (i).size () * sizeof (STPathElement);
+
+        return bytes;
+    }
+
+    case STI_AMOUNT:
+        return sizeof (STAmount);
+
+    default:
+        // No other field is bigger than this
+        return sizeof (STHash256);
+    }
+}
+
+std::size_t STObject::getMemoryUsage () const
+{
+    std::size_t bytes = sizeof (STObject) + mData.capacity () * sizeof (void*);
+
+    BOOST_FOREACH (const SerializedType & elem, mData)
+        bytes += getFieldMemoryUsage (elem);
+
+    return bytes;
+}
+
 int STObject::getFieldIndex (SField::ref field) const
 {
     if (mType != nullptr)
@@ -1267,11 +1337,30 @@ class SerializedObject_test : public beast::unit_test::suite
 public:
     void run()
     {
+        testFieldLookup();
         testSerialization();
         testParseJSONArray();
         testParseJSONArrayWithInvalidChildrenObjects();
     }
 
+    void testFieldLookup ()
+    {
+        testcase ("field lookup");
+
+        expect (&SField::getField (STI_ACCOUNT, sfAccount.fieldValue) == &sfAccount);
+        expect (&SField::getField (sfBalance.getCode ()) == &sfBalance);
+        expect (&SField::getField (sfIndex.getCode ()) == &sfIndex,
+            "Fields without a binary encoding should still be found");
+        expect (SField::getField (STI_UINT32, 0).isInvalid ());
+        expect (SField::getField (STI_UINT32, 256).isInvalid ());
+
+        // An unknown field of a known type is made once and then reused
+        SField::ref unknown = SField::getField (STI_UINT64, 250);
+        expect (unknown.isKnown () && (unknown.fieldValue == 250) &&
+            (unknown.getCode () == FIELD_CODE (STI_UINT64, 250)));
+        expect (&SField::getField (STI_UINT64, 250) == &unknown);
+    }
+
     bool parseJSONString (const std::string& json, Json::Value& to)
     {
         Json::Reader reader;
@@ -1422,4 +1511,175 @@ public:
 
 BEAST_DEFINE_TESTSUITE(SerializedObject,ripple_data,ripple);
 
+//------------------------------------------------------------------------------
+
+/** Times parsing ledger entries, as SerializedLedgerEntry does.
+
+    The corpus is read from the file named by STOBJECT_BENCH_CORPUS, one
+    hex ledger entry per line such as ledger_data returns with "binary",
+    or else made up of typical account roots, trust lines, offers and
+    directories. Each thread count parses the whole corpus many times.
+*/
+class SerializedObjectParse_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    static uint160 makeID (std::uint32_t i)
+    {
+        uint160 id;
+        std::memcpy (id.begin (), &i, sizeof (i));
+        return id;
+    }
+
+    static uint256 makeHash (std::uint32_t i)
+    {
+        uint256 hash;
+        std::memcpy (hash.begin (), &i, sizeof (i));
+        return hash;
+    }
+
+    static STObject makeEntry (LedgerEntryType type)
+    {
+        return STObject (LedgerFormats::getInstance ()->findByType (
+            type)->elements, sfLedgerEntry);
+    }
+
+    std::vector <Blob> makeCorpus ()
+    {
+        std::vector <Blob> corpus;
+        uint160 const usd (makeID (0x555344));
+
+        for (std::uint32_t i = 0; i < 1000; ++i)
+        {
+            STObject account (makeEntry (ltACCOUNT_ROOT));
+            account.setFieldU16 (sfLedgerEntryType, ltACCOUNT_ROOT);
+            account.setFieldAccount (sfAccount, makeID (i));
+            account.setFieldU32 (sfSequence, i);
+            account.setFieldAmount (sfBalance, STAmount (std::uint64_t (i) * 1000000));
+            account.setFieldU32 (sfOwnerCount, i % 10);
+            account.setFieldH256 (sfPreviousTxnID, makeHash (i));
+            account.setFieldU32 (sfPreviousTxnLgrSeq, i);
+            corpus.push_back (account.getSerializer ().peekData ());
+
+            STObject line (makeEntry (ltRIPPLE_STATE));
+            line.setFieldU16 (sfLedgerEntryType, ltRIPPLE_STATE);
+            line.setFieldAmount (sfBalance, STAmount (usd, makeID (0), i, -2));
+            line.setFieldAmount (sfLowLimit, STAmount (usd, makeID (i), 1000));
+            line.setFieldAmount (sfHighLimit, STAmount (usd, makeID (i + 1), 0));
+            line.setFieldH256 (sfPreviousTxnID, makeHash (i));
+            line.setFieldU32 (sfPreviousTxnLgrSeq, i);
+            line.setFieldU64 (sfLowNode, 0);
+            line.setFieldU64 (sfHighNode, 0);
+            corpus.push_back (line.getSerializer ().peekData ());
+
+            STObject offer (makeEntry (ltOFFER));
+            offer.setFieldU16 (sfLedgerEntryType, ltOFFER);
+            offer.setFieldAccount (sfAccount, makeID (i));
+            offer.setFieldU32 (sfSequence, i);
+            offer.setFieldAmount (sfTakerPays, STAmount (usd, makeID (i + 1), i + 10));
+            offer.setFieldAmount (sfTakerGets, STAmount (std::uint64_t (i) * 2000000));
+            offer.setFieldH256 (sfBookDirectory, makeHash (i / 10));
+            offer.setFieldU64 (sfBookNode, 0);
+            offer.setFieldU64 (sfOwnerNode, 0);
+            offer.setFieldH256 (sfPreviousTxnID, makeHash (i));
+            offer.setFieldU32 (sfPreviousTxnLgrSeq, i);
+            corpus.push_back (offer.getSerializer ().peekData ());
+
+            STObject dir (makeEntry (ltDIR_NODE));
+            dir.setFieldU16 (sfLedgerEntryType, ltDIR_NODE);
+            dir.setFieldAccount (sfOwner, makeID (i));
+            STVector256 indexes;
+            for (std::uint32_t j = 0; j < i % 32; ++j)
+                indexes.addValue (makeHash (j));
+            dir.setFieldV256 (sfIndexes, indexes);
+            dir.setFieldH256 (sfRootIndex, makeHash (i));
+            corpus.push_back (dir.getSerializer ().peekData ());
+        }
+
+        return corpus;
+    }
+
+    std::vector <Blob> loadCorpus (char const* filename)
+    {
+        std::vector <Blob> corpus;
+        std::ifstream in (filename);
+        std::string line;
+
+        while (std::getline (in, line))
+        {
+            std::pair <Blob, bool> const entry (strUnHex (line));
+
+            if (entry.second && !entry.first.empty ())
+                corpus.push_back (entry.first);
+        }
+
+        return corpus;
+    }
+
+    // Parses an entry, finding its template from its type
+    static bool parse (Blob const& data)
+    {
+        Serializer s (data);
+        SerializerIterator sit (s);
+        STObject entry (sfLedgerEntry);
+
+        entry.set (sit);
+
+        LedgerFormats::Item const* const item =
+            LedgerFormats::getInstance ()->findByType (static_cast <LedgerEntryType> (
+                entry.getFieldU16 (sfLedgerEntryType)));
+
+        return (item != nullptr) && entry.setType (item->elements);
+    }
+
+    void run ()
+    {
+        char const* const filename = std::getenv ("STOBJECT_BENCH_CORPUS");
+        std::vector <Blob> const corpus (filename ?
+            loadCorpus (filename) : makeCorpus ());
+
+        if (corpus.empty ())
+        {
+            fail ("Empty corpus");
+            return;
+        }
+
+        for (auto const& entry : corpus)
+            expect (parse (entry), "Entry should parse");
+
+        int const rounds = 100;
+        unsigned const maxThreads = std::max (1u, std::thread::hardware_concurrency ());
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            auto const start = clock_type::now ();
+
+            std::vector <std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back ([&corpus]
+                {
+                    for (int r = 0; r < rounds; ++r)
+                        for (auto const& entry : corpus)
+                            parse (entry);
+                });
+            }
+
+            for (auto& w : workers)
+                w.join ();
+
+            auto const elapsed = std::chrono::duration_cast <
+                std::chrono::milliseconds> (clock_type::now () - start);
+
+            log << threads << " threads: " <<
+                (corpus.size () * rounds * threads * 1000) /
+                    std::max <std::int64_t> (1, elapsed.count ()) <<
+                " entries/s from " << corpus.size () << " entries";
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SerializedObjectParse,ripple_data,ripple);
+
 } // ripple
@@ -152,6 +152,9 @@ public:
         return mData.size ();
     }
 
+    /** Returns the estimated bytes used by the object and its fields. */
+    std::size_t getMemoryUsage () const;
+
     bool setFlag (std::uint32_t);
     bool clearFlag (std::uint32_t);
     bool isFlag(std::uint32_t) const;
@@ -54,9 +54,11 @@ void SOTemplate::push_back (SOElement const& r)
 
 int SOTemplate::getIndex (SField::ref f) const
 {
-    // The mapping table should be large enough for any possible field
+    // Fields created after the template, such as unknown fields found
+    // while parsing, are never in it
     //
-    assert (f.getNum () < mIndex.size ());
+    if (f.getNum () >= mIndex.size ())
+        return -1;
 
     return mIndex[f.getNum ()];
 }
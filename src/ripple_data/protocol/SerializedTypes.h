@@ -24,6 +24,7 @@
 #include "ripple/types/api/base_uint.h"
 #include "beast/beast/utility/Zero.h"
 #include "ripple_data/protocol/FieldNames.h"
+#include "ripple_data/protocol/SerializedArena.h"
 #include "ripple_data/protocol/RippleAddress.h"
 
 using beast::zero;
@@ -94,6 +95,17 @@ public:
 
     virtual ~SerializedType () { }
 
+    // Objects made under a SerializedArena::Scope come from its arena
+    static void* operator new (std::size_t size)
+    {
+        return SerializedArena::allocate (size);
+    }
+
+    static void operator delete (void* p)
+    {
+        SerializedArena::deallocate (p);
+    }
+
     static std::unique_ptr<SerializedType> deserialize (SField::ref name)
     {
         return std::unique_ptr<SerializedType> (new SerializedType (name));
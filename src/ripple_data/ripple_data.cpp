@@ -64,10 +64,12 @@
 #include "crypto/Base58Data.cpp"
 #include "crypto/RFC1751.cpp"
 
+#include "protocol/AccountIDCache.cpp"
 #include "protocol/FieldNames.cpp"
 #include "protocol/HashPrefix.cpp"
 #include "protocol/LedgerFormats.cpp"
 #include "protocol/RippleAddress.cpp"
+#include "protocol/SerializedArena.cpp"
 #include "protocol/SerializedTypes.cpp"
 #include "protocol/Serializer.cpp"
 #include "protocol/SerializedObjectTemplate.cpp"
@@ -34,9 +34,11 @@ typedef struct bignum_st BIGNUM;
 #include "protocol/HashPrefix.h"
 #include "protocol/Protocol.h"
 #include "protocol/RippleAddress.h"
+#include "protocol/AccountIDCache.h"
 #include "protocol/RippleSystem.h"
 #include "protocol/Serializer.h" // needs CKey
 #include "protocol/TER.h"
+#include "protocol/SerializedArena.h"
 #include "protocol/SerializedTypes.h" // needs Serializer, TER
 #include "protocol/SerializedObjectTemplate.h"
  #include "protocol/KnownFormats.h"
@@ -62,11 +62,17 @@ Resource::Consumer& InfoSub::getConsumer()
     return m_consumer;
 }
 
-void InfoSub::send (const Json::Value& jvObj, const std::string& sObj, bool broadcast)
+void InfoSub::send (const Json::Value& jvObj, Payload const&, bool broadcast)
 {
     send (jvObj, broadcast);
 }
 
+InfoSub::Payload InfoSub::encode (Json::Value const& jvObj)
+{
+    Json::FastWriter w;
+    return boost::make_shared <std::string const> (w.write (jvObj));
+}
+
 std::uint64_t InfoSub::getSeq ()
 {
     return mSeq;
@@ -76,6 +82,16 @@ void InfoSub::onSendEmpty ()
 {
 }
 
+InfoSub::Backlog InfoSub::getBacklog ()
+{
+    return Backlog ();
+}
+
+bool InfoSub::notifyBacklogBelow (std::size_t, std::function <void ()> const&)
+{
+    return false;
+}
+
 void InfoSub::insertSubAccountInfo (RippleAddress addr, std::uint32_t uLedgerIndex)
 {
     ScopedLockType sl (mLock);
@@ -46,6 +46,28 @@ public:
 
     typedef Resource::Consumer Consumer;
 
+    /** The encoded form of an event, shared by every subscriber it goes to. */
+    typedef boost::shared_ptr <std::string const> Payload;
+
+    /** Outbound messages a subscriber has not yet delivered. */
+    struct Backlog
+    {
+        Backlog ()
+            : messages (0)
+            , bytes (0)
+            , peakBytes (0)
+            , sent (0)
+            , dropped (0)
+        {
+        }
+
+        std::size_t messages;       // waiting to be written
+        std::size_t bytes;          // waiting to be written
+        std::size_t peakBytes;      // the largest backlog seen
+        std::uint64_t sent;         // messages written
+        std::uint64_t dropped;      // stream messages discarded for lack of room
+    };
+
 public:
     /** Abstracts the source of subscription data.
     */
@@ -109,12 +131,31 @@ public:
 
     virtual void send (const Json::Value & jvObj, bool broadcast) = 0;
 
-    // VFALCO NOTE Why is this virtual?
-    virtual void send (const Json::Value & jvObj, const std::string & sObj, bool broadcast);
+    /** Send an event that has already been encoded.
+        Subscribers which write the encoded form use the payload directly,
+        so publishing to many of them serializes the event only once.
+    */
+    virtual void send (const Json::Value & jvObj, Payload const& payload, bool broadcast);
+
+    /** Encode an event for sending to any number of subscribers. */
+    static Payload encode (Json::Value const& jvObj);
 
     std::uint64_t getSeq ();
 
-    void onSendEmpty ();
+    /** Called when everything sent so far has been written. */
+    virtual void onSendEmpty ();
+
+    /** Returns the subscriber's outbound backlog.
+        Subscribers that do not queue their output report an empty backlog.
+    */
+    virtual Backlog getBacklog ();
+
+    /** Arranges for a handler to be called once the backlog is under
+        `bytes`. Returns false, without keeping the handler, if it already
+        is. Subscribers that do not queue their output always return false.
+    */
+    virtual bool notifyBacklogBelow (std::size_t bytes,
+        std::function <void ()> const& handler);
 
     void insertSubAccountInfo (RippleAddress addr, std::uint32_t uLedgerIndex);
 
@@ -328,6 +328,28 @@ private:
         return jvRequest;
     }
 
+    // job_latency [<job_type>]
+    Json::Value parseJobLatency (const Json::Value& jvParams)
+    {
+        Json::Value     jvRequest (Json::objectValue);
+
+        if (jvParams.size ())
+            jvRequest["job_type"]   = jvParams[0u].asString ();
+
+        return jvRequest;
+    }
+
+    // slow_subscribers [<limit>]
+    Json::Value parseSlowSubscribers (const Json::Value& jvParams)
+    {
+        Json::Value     jvRequest (Json::objectValue);
+
+        if (jvParams.size ())
+            jvRequest[jss::limit]   = jvParams[0u].asInt ();
+
+        return jvRequest;
+    }
+
     // json <command> <json>
     Json::Value parseJson (const Json::Value& jvParams)
     {
@@ -772,6 +794,7 @@ public:
             {   "feature",              &RPCParser::parseFeature,               0,  2   },
             {   "fetch_info",           &RPCParser::parseFetchInfo,             0,  1   },
             {   "get_counts",           &RPCParser::parseGetCounts,             0,  1   },
+            {   "job_latency",          &RPCParser::parseJobLatency,            0,  1   },
             {   "json",                 &RPCParser::parseJson,                  2,  2   },
             {   "ledger",               &RPCParser::parseLedger,                0,  2   },
             {   "ledger_accept",        &RPCParser::parseAsIs,                  0,  0   },
@@ -790,6 +813,7 @@ public:
             {   "random",               &RPCParser::parseAsIs,                  0,  0   },
             {   "static_path_find",     &RPCParser::parseRipplePathFind,        1,  2   },
             {   "sign",                 &RPCParser::parseSignSubmit,            2,  3   },
+            {   "slow_subscribers",     &RPCParser::parseSlowSubscribers,       0,  1   },
             {   "sms",                  &RPCParser::parseSMS,                   1,  1   },
             {   "submit",               &RPCParser::parseSignSubmit,            1,  3   },
             {   "server_info",          &RPCParser::parseAsIs,                  0,  0   },
@@ -142,6 +142,18 @@ std::string HTTPReply (int nStatus, const std::string& strMsg)
     }
 
     ret.reserve(256 + strMsg.length());
+    ret.append (HTTPReplyHeader (nStatus, strMsg.size () + 2));
+    ret.append (strMsg);
+    ret.append ("\r\n");
+
+    return ret;
+}
+
+std::string HTTPReplyHeader (int nStatus, std::size_t contentLength)
+{
+    std::string ret;
+
+    ret.reserve (256);
 
     switch (nStatus)
     {
@@ -160,7 +172,7 @@ std::string HTTPReply (int nStatus, const std::string& strMsg)
         ret.append ("Access-Control-Allow-Origin: *\r\n");
     
     ret.append ("Content-Length: ");
-    ret.append (std::to_string(strMsg.size () + 2));
+    ret.append (std::to_string (contentLength));
     ret.append ("\r\n");
 
     ret.append ("Content-Type: application/json; charset=UTF-8\r\n");
@@ -169,8 +181,6 @@ std::string HTTPReply (int nStatus, const std::string& strMsg)
     ret.append (BuildInfo::getFullVersionString ());
     ret.append ("\r\n");
     
-    ret.append ("\r\n");
-    ret.append (strMsg);
     ret.append ("\r\n");
 
     return ret;
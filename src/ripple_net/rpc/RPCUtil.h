@@ -38,6 +38,9 @@ extern std::string createHTTPPost (const std::string& strHost, const std::string
 
 extern std::string HTTPReply (int nStatus, const std::string& strMsg);
 
+// Returns the status line and headers of a reply whose body is sent separately
+extern std::string HTTPReplyHeader (int nStatus, std::size_t contentLength);
+
 // VFALCO TODO Create a HTTPHeaders class with a nice interface instead of the std::map
 //
 extern bool HTTPAuthorized (std::map <std::string, std::string> const& mapHeaders);
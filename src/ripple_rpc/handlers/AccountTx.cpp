@@ -93,6 +93,13 @@ Json::Value RPCHandler::doAccountTx (Json::Value params, Resource::Charge& loadT
          resumeToken = params[jss::marker];
     }
 
+    // A marker we can't read would otherwise start over at the first page
+    std::uint32_t findLedger, findSeq;
+
+    if (!resumeToken.isNull () &&
+        !parseAccountTxMarker (resumeToken, findLedger, findSeq))
+        return rpcError (rpcINVALID_PARAMS);
+
 #ifndef BEAST_DEBUG
 
     try
@@ -28,7 +28,8 @@ namespace ripple {
 //   count: boolean,               // optional, defaults to false
 //   descending: boolean,          // optional, defaults to false
 //   offset: integer,              // optional, defaults to 0
-//   limit: integer                // optional
+//   limit: integer,               // optional
+//   marker: opaque                // optional, resume previous query
 // }
 Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& masterLockHolder)
 {
@@ -40,6 +41,7 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& lo
     bool            bBinary     = params.isMember ("binary") && params["binary"].asBool ();
     bool            bDescending = params.isMember ("descending") && params["descending"].asBool ();
     bool            bCount      = params.isMember ("count") && params["count"].asBool ();
+    Json::Value     resumeToken = params.isMember (jss::marker) ? params[jss::marker] : Json::Value ();
 	bool			showMeta = true;
 	if (params.isMember("meta")) showMeta = params["meta"].asBool();
 
@@ -58,6 +60,20 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& lo
     if (offset > 3000)
         return rpcError (rpcATX_DEPRECATED);
 
+    // Without an offset, pages are found by seeking to a marker instead.
+    // A marker and an offset together make no sense.
+    bool const bKeyset = (offset == 0);
+
+    if (!bKeyset && !resumeToken.isNull ())
+        return rpcError (rpcINVALID_PARAMS);
+
+    // Rather than start over at the first page
+    std::uint32_t findLedger, findSeq;
+
+    if (!resumeToken.isNull () &&
+        !parseAccountTxMarker (resumeToken, findLedger, findSeq))
+        return rpcError (rpcINVALID_PARAMS);
+
     loadType = Resource::feeHighBurdenRPC;
 
     // DEPRECATED
@@ -120,8 +136,9 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& lo
 
         if (bBinary)
         {
-            std::vector<NetworkOPs::txnMetaLedgerType> txns =
-                mNetOps->getAccountTxsB (raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit, mRole == Config::ADMIN);
+            std::vector<NetworkOPs::txnMetaLedgerType> txns = bKeyset
+                ? mNetOps->getTxsAccountB (raAccount, uLedgerMin, uLedgerMax, !bDescending, resumeToken, limit, mRole == Config::ADMIN)
+                : mNetOps->getAccountTxsB (raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit, mRole == Config::ADMIN);
 
             for (std::vector<NetworkOPs::txnMetaLedgerType>::const_iterator it = txns.begin (), end = txns.end ();
                     it != end; ++it)
@@ -139,7 +156,9 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& lo
         }
         else
         {
-            std::vector< std::pair<Transaction::pointer, TransactionMetaSet::pointer> > txns = mNetOps->getAccountTxs (raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit, mRole == Config::ADMIN);
+            std::vector< std::pair<Transaction::pointer, TransactionMetaSet::pointer> > txns = bKeyset
+                ? mNetOps->getTxsAccount (raAccount, uLedgerMin, uLedgerMax, !bDescending, resumeToken, limit, mRole == Config::ADMIN)
+                : mNetOps->getAccountTxs (raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit, mRole == Config::ADMIN);
 
             for (std::vector< std::pair<Transaction::pointer, TransactionMetaSet::pointer> >::iterator it = txns.begin (), end = txns.end (); it != end; ++it)
             {
@@ -174,6 +193,9 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, Resource::Charge& lo
         if (params.isMember ("limit"))
             ret["limit"]        = limit;
 
+        if (bKeyset && !resumeToken.isNull ())
+            ret[jss::marker]    = resumeToken;
+
 
         return ret;
 #ifndef BEAST_DEBUG
@@ -54,6 +54,9 @@ Json::Value RPCHandler::doGetCounts (Json::Value params, Resource::Charge& loadT
     if (dbKB > 0)
         ret["dbKBTransaction"] = dbKB;
 
+    ret["db_readers"]["ledger"] = getApp().getLedgerDB ()->getJson ();
+    ret["db_readers"]["transaction"] = getApp().getTxnDB ()->getJson ();
+
     {
         std::size_t c = getApp().getOPs().getLocalTxCount ();
         if (c > 0)
@@ -65,10 +68,13 @@ Json::Value RPCHandler::doGetCounts (Json::Value params, Resource::Charge& loadT
     ret["SLE_hit_rate"] = getApp().getSLECache ().getHitRate ();
     ret["node_hit_rate"] = getApp().getNodeStore ().getCacheHitRate ();
     ret["ledger_hit_rate"] = getApp().getLedgerMaster ().getCacheHitRate ();
+    ret["ledger_cache"] = getApp().getLedgerMaster ().getCacheJson ();
     ret["AL_hit_rate"] = AcceptedLedger::getCacheHitRate ();
 
     ret["fullbelow_size"] = int(getApp().getFullBelowCache().size());
 
+    ret["memory"] = getApp().getMemoryBudget ().getJson ();
+
     std::string uptime;
     int s = UptimeTimer::getInstance ().getElapsedSeconds ();
     textTime (uptime, s, "year", 365 * 24 * 60 * 60);
@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012-2014 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+namespace ripple {
+
+/** Streams the state of one ledger to a websocket client.
+
+    The state map is walked in key order, one branch of the root after
+    another, rather than finding each item from the root as ledger_data
+    does. Entries go out in chunks of about 256KB, as JSON lines or as
+    "<index> <data>" lines in hex. Each chunk is built by its own job, and
+    the walk keeps its place between jobs. While the client's backlog is
+    a megabyte or more, the next job is posted by the connection once
+    enough has been written, so a slow reader slows the walk without
+    holding a job thread. The export stops if the client goes away or the
+    server is stopping.
+*/
+class LedgerExporter
+    : public boost::enable_shared_from_this <LedgerExporter>
+{
+public:
+    static std::size_t const chunkBytes = 256 * 1024;
+    static std::size_t const windowBytes = 1024 * 1024;
+
+    LedgerExporter (InfoSub::ref subscriber, Ledger::ref ledger,
+            int branch, bool binary, Json::Value const& id)
+        : m_subscriber (subscriber)
+        , m_map (ledger->peekAccountStateMap ()->snapShot (false))
+        , m_ledgerHash (to_string (ledger->getHash ()))
+        , m_ledgerIndex (ledger->getLedgerSeq ())
+        , m_branch (branch)
+        , m_binary (binary)
+        , m_id (id)
+        , m_walk ((branch < 0) ? 0 : branch)
+        , m_chunks (0)
+        , m_chunkEntries (0)
+        , m_entries (0)
+    {
+        m_chunk.reserve (chunkBytes + 4096);
+    }
+
+    // Queues the job that builds the next chunk
+    void post ()
+    {
+        getApp().getJobQueue ().addJob (jtADMIN, "ledgerExport",
+            std::bind (&LedgerExporter::step, shared_from_this (),
+                std::placeholders::_1));
+    }
+
+private:
+    Json::Value message () const
+    {
+        Json::Value jvObj (Json::objectValue);
+
+        jvObj[jss::type] = "ledgerExport";
+
+        if (!m_id.isNull ())
+            jvObj[jss::id] = m_id;
+
+        jvObj["ledger_hash"] = m_ledgerHash;
+        jvObj["ledger_index"] = m_ledgerIndex;
+
+        if (m_branch >= 0)
+            jvObj["branch"] = m_branch;
+
+        return jvObj;
+    }
+
+    void step (Job& job)
+    {
+        std::string error;
+        bool done = false;
+
+        if (job.shouldCancel ())
+        {
+            error = "stopped";
+        }
+        else
+        {
+            try
+            {
+                done = fill ();
+            }
+            catch (SHAMapMissingNode const&)
+            {
+                error = "missingNode";
+            }
+        }
+
+        InfoSub::pointer subscriber = m_subscriber.lock ();
+
+        if (!subscriber)
+        {
+            WriteLog (lsINFO, RPCHandler) << "ledger_export of " << m_ledgerIndex <<
+                " sent " << m_entries << " entries in " << m_chunks <<
+                " chunks, client gone";
+            return;
+        }
+
+        if (error.empty ())
+        {
+            if (!m_chunk.empty ())
+                sendChunk (*subscriber);
+
+            if (!done)
+            {
+                if (!subscriber->notifyBacklogBelow (windowBytes, std::bind (
+                        &LedgerExporter::post, shared_from_this ())))
+                    post ();
+                return;
+            }
+        }
+
+        finish (*subscriber, error);
+    }
+
+    // Adds entries until the chunk is full.
+    // Returns true once every entry has been added.
+    bool fill ()
+    {
+        int const last = (m_branch < 0) ? 15 : m_branch;
+
+        for (;;)
+        {
+            if (!m_map->visitLeaves (m_walk, std::bind (&LedgerExporter::add,
+                    this, std::placeholders::_1)))
+                return false;
+
+            if (m_walk.getBranch () == last)
+                return true;
+
+            m_walk = SHAMap::LeafWalk (m_walk.getBranch () + 1);
+        }
+    }
+
+    // Returns false once the chunk is full
+    bool add (SHAMapItem::ref item)
+    {
+        if (m_binary)
+        {
+            m_chunk += to_string (item->getTag ());
+            m_chunk += ' ';
+            m_chunk += strHex (item->peekData ().begin (), item->peekData ().size ());
+            m_chunk += '\n';
+        }
+        else
+        {
+            SLE sle (item->peekSerializer (), item->getTag ());
+            Json::Value entry (sle.getJson (0));
+            entry["index"] = to_string (item->getTag ());
+            m_chunk += m_writer.write (entry);
+        }
+
+        ++m_chunkEntries;
+        ++m_entries;
+
+        return m_chunk.size () < chunkBytes;
+    }
+
+    void sendChunk (InfoSub& subscriber)
+    {
+        Json::Value jvObj (message ());
+        jvObj["chunk"] = m_chunks++;
+        jvObj["entries"] = m_chunkEntries;
+        jvObj["data"] = m_chunk;
+
+        subscriber.send (jvObj, false);
+
+        m_chunk.clear ();
+        m_chunkEntries = 0;
+    }
+
+    void finish (InfoSub& subscriber, std::string const& error)
+    {
+        Json::Value jvObj (message ());
+        jvObj["complete"] = error.empty ();
+        jvObj["entries"] = static_cast <double> (m_entries);
+
+        if (!error.empty ())
+            jvObj[jss::error] = error;
+
+        WriteLog (lsINFO, RPCHandler) << "ledger_export of " << m_ledgerIndex <<
+            " sent " << m_entries << " entries in " << m_chunks << " chunks" <<
+            (error.empty () ? "" : ", " + error);
+
+        subscriber.send (jvObj, false);
+    }
+
+    InfoSub::wptr m_subscriber;
+    SHAMap::pointer m_map;
+    std::string const m_ledgerHash;
+    std::uint32_t const m_ledgerIndex;
+    int const m_branch;                 // -1 for the whole map
+    bool const m_binary;
+    Json::Value const m_id;
+
+    SHAMap::LeafWalk m_walk;
+    Json::FastWriter m_writer;
+    std::string m_chunk;
+    int m_chunks;
+    int m_chunkEntries;
+    std::uint64_t m_entries;
+};
+
+// Export the state of a ledger over a websocket
+//   Inputs:
+//     ledger_hash or ledger_index: the ledger, as for ledger_data
+//     binary:       boolean, hex lines rather than JSON lines
+//     branch:       integer 0-15, optional, only the keys whose first nibble
+//                   it is, so that several streams can export in parallel
+//   Outputs:
+//     ledger_hash:  chosen ledger's hash
+//     ledger_index: chosen ledger's index
+//   Then "ledgerExport" messages, each with a chunk number and data, and a
+//   last one with complete and the number of entries sent.
+Json::Value RPCHandler::doLedgerExport (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& masterLockHolder)
+{
+    masterLockHolder.unlock ();
+
+    if (!mInfoSub)
+        return rpcError (rpcNO_EVENTS);
+
+    Ledger::pointer lpLedger;
+
+    Json::Value jvResult = RPC::lookupLedger (params, lpLedger, *mNetOps);
+    if (!lpLedger)
+        return jvResult;
+
+    bool isBinary = false;
+    if (params.isMember ("binary"))
+    {
+        Json::Value const& jBinary = params["binary"];
+        if (!jBinary.isBool ())
+            return RPC::expected_field_error ("binary", "bool");
+        isBinary = jBinary.asBool ();
+    }
+
+    int branch = -1;
+    if (params.isMember ("branch"))
+    {
+        Json::Value const& jBranch = params["branch"];
+        if (!jBranch.isIntegral () || (jBranch.asInt () < 0) || (jBranch.asInt () > 15))
+            return RPC::expected_field_error ("branch", "integer 0-15");
+        branch = jBranch.asInt ();
+    }
+
+    boost::make_shared <LedgerExporter> (
+        mInfoSub, lpLedger, branch, isBinary, params[jss::id])->post ();
+
+    jvResult["ledger_hash"] = to_string (lpLedger->getHash ());
+    jvResult["ledger_index"] = lpLedger->getLedgerSeq ();
+
+    return jvResult;
+}
+
+} // ripple
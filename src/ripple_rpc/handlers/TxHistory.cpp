@@ -46,8 +46,8 @@ Json::Value RPCHandler::doTxHistory (Json::Value params, Resource::Charge& loadT
                     % startIndex);
 
     {
-        Database* db = getApp().getTxnDB ()->getDB ();
-        DeprecatedScopedLock sl (getApp().getTxnDB ()->getDBLock ());
+        DatabaseCon::Reader reader (*getApp().getTxnDB ());
+        Database* db = reader.getDB ();
 
         SQL_FOREACH (db, sql)
         {
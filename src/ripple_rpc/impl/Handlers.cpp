@@ -32,6 +32,7 @@
 #include "../handlers/FetchInfo.cpp"
 #include "../handlers/GetCounts.cpp"
 #include "../handlers/Inflate.cpp"
+#include "../handlers/JobLatency.cpp"
 #include "../handlers/Ledger.cpp"
 #include "../handlers/LedgerAccept.cpp"
 #include "../handlers/LedgerCleaner.cpp"
@@ -39,6 +40,7 @@
 #include "../handlers/LedgerCurrent.cpp"
 #include "../handlers/LedgerData.cpp"
 #include "../handlers/LedgerEntry.cpp"
+#include "../handlers/LedgerExport.cpp"
 #include "../handlers/LedgerHeader.cpp"
 #include "../handlers/LogLevel.cpp"
 #include "../handlers/LogRotate.cpp"
@@ -58,6 +60,7 @@
 #include "../handlers/ServerInfo.cpp"
 #include "../handlers/ServerState.cpp"
 #include "../handlers/Sign.cpp"
+#include "../handlers/SlowSubscribers.cpp"
 #include "../handlers/Stop.cpp"
 #include "../handlers/Submit.cpp"
 #include "../handlers/Subscribe.cpp"
@@ -1,5 +1,6 @@
 var assert    = require('assert');
 var extend    = require("extend");
+var net       = require("net");
 var Server    = require("./server").Server;
 var Remote    = require("stellar-lib").Remote;
 var testutils = require('./testutils');
@@ -49,4 +50,305 @@ suite('WebSocket connection', function() {
   });
 });
 
+// Open a websocket by hand so the test controls when the client reads.
+function raw_connect(host, port, callback) {
+  var socket = net.connect(port, host, function () {
+    socket.write("GET / HTTP/1.1\r\n"
+      + "Host: " + host + ":" + port + "\r\n"
+      + "Upgrade: websocket\r\n"
+      + "Connection: Upgrade\r\n"
+      + "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+      + "Sec-WebSocket-Version: 13\r\n\r\n");
+  });
+
+  socket.once('data', function (data) {
+    assert(/^HTTP\/1\.1 101/.test(data.toString()));
+    callback(socket);
+  });
+};
+
+// Send a masked text frame. A zero mask leaves the payload as is.
+function raw_send(socket, message) {
+  var payload = new Buffer(JSON.stringify(message));
+  var header;
+
+  if (payload.length < 126) {
+    header = new Buffer([ 0x81, 0x80 | payload.length ]);
+  } else {
+    header = new Buffer([ 0x81, 0x80 | 126, payload.length >> 8, payload.length & 0xff ]);
+  }
+
+  socket.write(Buffer.concat([ header, new Buffer([ 0, 0, 0, 0 ]), payload ]));
+};
+
+suite('WebSocket slow client', function() {
+  var server;
+  var limit = 65536;
+  var cfg   = extend({}, config.default_server_config, config.servers.alpha, {
+    'websocket_send_queue_limit' : limit,
+    'websocket_slow_client' : 'drop'
+  });
+
+  setup(function(done) {
+    this.timeout(10000);
+
+    if (cfg.no_server) {
+      done();
+    } else {
+      server = Server.from_config("alpha", cfg);
+      server.once('started', done)
+      server.start();
+    }
+  });
+
+  teardown(function(done) {
+    this.timeout(10000);
+
+    if (cfg.no_server) {
+      done();
+    } else {
+      server.on('stopped', done);
+      server.stop();
+    }
+  });
+
+  test('stream messages are dropped for a client that stops reading', function(done) {
+    this.timeout(120000);
+
+    var alpha = Remote.from_config("alpha");
+
+    alpha.once('connected', function () {
+      raw_connect(cfg.websocket_ip, cfg.websocket_port, function (slow) {
+        raw_send(slow, { command: 'subscribe', streams: [ 'ledger', 'server' ] });
+
+        // Stop reading. Once the socket buffers fill, the server has to
+        // queue everything published to this client.
+        slow.pause();
+
+        var closes = 0;
+
+        function check() {
+          testutils.rpc(config, { method: 'slow_subscribers', params: [ { limit: 1 } ] })
+            .then(function (result) {
+              var slowest = result.subscribers[0];
+
+              if (slowest && slowest.dropped > 0) {
+                assert(slowest.queued_bytes <= limit);
+                assert(slowest.peak_bytes <= limit);
+
+                slow.destroy();
+                alpha.once('disconnected', function () { done(); });
+                alpha.connect(false);
+              } else if (closes >= 20000) {
+                done(new Error('no messages were dropped'));
+              } else {
+                pump();
+              }
+            })
+            .catch(done);
+        };
+
+        // Close ledgers in batches, each publishes to the ledger stream.
+        function pump() {
+          var pending = 50;
+
+          for (var i = 0; i < 50; ++i) {
+            testutils.rpc(config, { method: 'ledger_accept' })
+              .then(function () {
+                ++closes;
+                if (--pending === 0) check();
+              })
+              .catch(done);
+          }
+        };
+
+        pump();
+      });
+    });
+
+    alpha.connect();
+  });
+});
+
+// Call back with each text message the server sends on a raw socket.
+function raw_receive(socket, callback) {
+  var buffer = new Buffer(0);
+
+  socket.on('data', function (data) {
+    buffer = Buffer.concat([ buffer, data ]);
+
+    for (;;) {
+      if (buffer.length < 2) return;
+
+      var length = buffer[1] & 0x7f;
+      var offset = 2;
+
+      if (length === 126) {
+        if (buffer.length < 4) return;
+        length = buffer.readUInt16BE(2);
+        offset = 4;
+      } else if (length === 127) {
+        if (buffer.length < 10) return;
+        length = buffer.readUInt32BE(6);
+        offset = 10;
+      }
+
+      if (buffer.length < offset + length) return;
+
+      var opcode = buffer[0] & 0x0f;
+      var payload = buffer.slice(offset, offset + length);
+      buffer = buffer.slice(offset + length);
+
+      if (opcode === 1) callback(JSON.parse(payload.toString()));
+    }
+  });
+};
+
+suite('WebSocket ledger export', function() {
+  var server;
+  var cfg = extend({}, config.default_server_config, config.servers.alpha);
+
+  setup(function(done) {
+    this.timeout(10000);
+
+    if (cfg.no_server) {
+      done();
+    } else {
+      server = Server.from_config("alpha", cfg);
+      server.once('started', done)
+      server.start();
+    }
+  });
+
+  teardown(function(done) {
+    this.timeout(10000);
+
+    if (cfg.no_server) {
+      done();
+    } else {
+      server.on('stopped', done);
+      server.stop();
+    }
+  });
+
+  // Runs one export and calls back with its reply, chunks and last message.
+  function run_export(request, callback) {
+    raw_connect(cfg.websocket_ip, cfg.websocket_port, function (socket) {
+      var reply;
+      var chunks = [];
+
+      raw_receive(socket, function (message) {
+        if (message.type === 'response') {
+          reply = message;
+        } else if (message.type === 'ledgerExport') {
+          assert(reply, 'export message before the reply');
+          assert.strictEqual(message.id, request.id);
+          assert.strictEqual(message.ledger_index, reply.result.ledger_index);
+          assert.strictEqual(message.ledger_hash, reply.result.ledger_hash);
+
+          if ('complete' in message) {
+            socket.destroy();
+            callback(reply, chunks, message);
+          } else {
+            chunks.push(message);
+          }
+        }
+      });
+
+      raw_send(socket, request);
+    });
+  };
+
+  test('ledger_export sends the state in chunks, then complete', function(done) {
+    this.timeout(10000);
+
+    run_export({ id: 1, command: 'ledger_export' }, function (reply, chunks, last) {
+      assert.strictEqual(reply.status, 'success');
+      assert(chunks.length > 0);
+      assert.strictEqual(last.complete, true);
+      assert(!('error' in last));
+
+      var entries = 0;
+
+      chunks.forEach(function (chunk, i) {
+        assert.strictEqual(chunk.chunk, i);
+
+        var lines = chunk.data.split('\n').filter(function (line) { return line.length; });
+        assert.strictEqual(lines.length, chunk.entries);
+
+        lines.forEach(function (line) {
+          var entry = JSON.parse(line);
+          assert(entry.index);
+          assert(entry.LedgerEntryType);
+        });
+
+        entries += chunk.entries;
+      });
+
+      assert.strictEqual(last.entries, entries);
+
+      // The genesis ledger holds the root account
+      var root = config.accounts.root.account;
+      var found = chunks.some(function (chunk) {
+        return chunk.data.split('\n').some(function (line) {
+          return line.length && JSON.parse(line).Account === root;
+        });
+      });
+      assert(found, 'root account not exported');
+
+      done();
+    });
+  });
+
+  test('ledger_export branches add up to the whole ledger', function(done) {
+    this.timeout(20000);
+
+    run_export({ id: 'all', command: 'ledger_export', binary: true }, function (reply, chunks, last) {
+      assert.strictEqual(last.complete, true);
+
+      var total = last.entries;
+      var seen = 0;
+      var branch = 0;
+
+      function next() {
+        var request = {
+          id: 'branch' + branch,
+          command: 'ledger_export',
+          ledger_index: reply.result.ledger_index,
+          binary: true,
+          branch: branch
+        };
+
+        run_export(request, function (reply, chunks, last) {
+          assert.strictEqual(last.complete, true);
+          assert.strictEqual(last.branch, request.branch);
+
+          chunks.forEach(function (chunk) {
+            chunk.data.split('\n').forEach(function (line) {
+              if (!line.length) return;
+
+              // "<index> <data>", the index starting with the branch nibble
+              var fields = line.split(' ');
+              assert.strictEqual(fields.length, 2);
+              assert.strictEqual(parseInt(fields[0][0], 16), request.branch);
+              assert(/^[0-9A-Fa-f]+$/.test(fields[1]));
+            });
+          });
+
+          seen += last.entries;
+
+          if (++branch < 16) {
+            next();
+          } else {
+            assert.strictEqual(seen, total);
+            done();
+          }
+        });
+      };
+
+      next();
+    });
+  });
+});
+
 // vim:sw=2:sts=2:ts=8:et